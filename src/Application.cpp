@@ -520,6 +520,11 @@ public:
           m_simulatedRapidSpeed(configuration.trajectory.rapidSpeed),
           m_pathJerk(configuration.trajectory.pathJerk) {
         m_controlAuthority = m_simulation.state().authority;
+        // parsed programs are kept beside the machine parameters, so reopening a job after a restart skips the parser
+        if (!m_worker.setProgramCache(std::make_shared<const ngc::ProgramCache>(
+                configuration.parameterStores.machine.parent_path() / "program_cache"))) {
+            PANIC("new preview worker rejected its program cache");
+        }
         if (!m_simulation.setSplineFitSolver(splineFitSolver)) {
             PANIC("new simulation worker rejected its spline smoothing mode");
         }
@@ -3058,6 +3063,11 @@ public:
                     static_cast<unsigned long long>(planning.rollingSuffixProbeFailures),
                     static_cast<unsigned long long>(planning.rollingPrefixProbeFailures),
                     planning.rollingSearchSeconds);
+                ImGui::Text(
+                    "Speculative probes: %llu | Cancelled: %llu | Reused pieces: %llu",
+                    static_cast<unsigned long long>(planning.rollingSpeculativeProbes),
+                    static_cast<unsigned long long>(planning.rollingCancelledProbes),
+                    static_cast<unsigned long long>(planning.reusedMaterializationPieces));
             }
 
             if (ImGui::CollapsingHeader(
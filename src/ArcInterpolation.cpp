@@ -51,6 +51,17 @@ namespace ngc::simulation_detail {
     ArcReference::ArcReference(const MoveArc &arc, ArcInverseDiagnostics *inverseDiagnostics)
         : m_arc(arc), m_geometry(arcGeometry(arc)), m_inverseDiagnostics(inverseDiagnostics) {
         if(!m_geometry) return;
+
+        // Speed is monotonic in the interpolated radius, so equal end speeds bound its variation
+        // over the whole arc and the linear map stays within the inverse distance tolerance.
+        const auto startSpeed = speed(0.0);
+        const auto endSpeed = speed(1.0);
+        if(std::abs(endSpeed-startSpeed) <= 1e-12*std::max(1.0, startSpeed)) {
+            m_constantSpeed = true;
+            m_length = std::midpoint(startSpeed, endSpeed);
+            return;
+        }
+
         if(m_inverseDiagnostics) ++m_inverseDiagnostics->constructionIntegralEvaluations;
         const auto function = [this](const double parameter) { return speed(parameter); };
         const auto fromValue = function(0.0);
@@ -186,6 +197,10 @@ namespace ngc::simulation_detail {
             if(m_inverseDiagnostics) ++m_inverseDiagnostics->endpointQueries;
             return 1.0;
         }
+        if(m_constantSpeed) {
+            if(m_inverseDiagnostics) ++m_inverseDiagnostics->closedFormQueries;
+            return distance/m_length;
+        }
         auto &cache = m_inverseCache[inverseCacheIndex(distance)];
         if(cache.valid && cache.distance == distance) {
             if(m_inverseDiagnostics) ++m_inverseDiagnostics->exactCacheHits;
@@ -235,42 +250,92 @@ namespace ngc::simulation_detail {
     }
 
     position_t ArcReference::tangentAtDistance(const double distance) const {
-        const auto value = derivative(parameterAtDistance(distance));
-        const auto magnitude = value.length();
-        return magnitude > 0.0 ? scaled(value, 1.0/magnitude) : position_t{};
+        position_t tangent;
+        derivativesAtDistance(distance, nullptr, &tangent, nullptr, nullptr);
+        return tangent;
     }
 
     position_t ArcReference::curvatureAtDistance(const double distance) const {
-        const auto parameter=parameterAtDistance(distance);
-        const auto first=derivative(parameter);
-        const auto second=secondDerivative(parameter);
-        const auto speedSquared=first.x*first.x+first.y*first.y+first.z*first.z
-            +first.a*first.a+first.b*first.b+first.c*first.c;
-        if(speedSquared<=1e-30) return {};
-        const auto firstSecond=first.x*second.x+first.y*second.y+first.z*second.z
-            +first.a*second.a+first.b*second.b+first.c*second.c;
-        return scaled(second,1.0/speedSquared)
-            -scaled(first,firstSecond/(speedSquared*speedSquared));
+        position_t curvature;
+        derivativesAtDistance(distance, nullptr, nullptr, &curvature, nullptr);
+        return curvature;
     }
 
     position_t ArcReference::curvatureDerivativeAtDistance(const double distance) const {
+        position_t curvatureDerivative;
+        derivativesAtDistance(distance, nullptr, nullptr, nullptr, &curvatureDerivative);
+        return curvatureDerivative;
+    }
+
+    void ArcReference::derivativesAtDistance(const double distance, position_t *position,
+                                             position_t *tangent, position_t *curvature,
+                                             position_t *curvatureDerivative) const {
         const auto parameter=parameterAtDistance(distance);
-        const auto first=derivative(parameter);
-        const auto second=secondDerivative(parameter);
-        const auto third=thirdDerivative(parameter);
-        const auto speed=first.length();
-        if(speed<=1e-15) return {};
-        const auto firstSecond=positionDot(first,second);
-        const auto secondSquared=positionDot(second,second);
-        const auto firstThird=positionDot(first,third);
-        const auto inverseSpeed2=1.0/(speed*speed);
-        const auto inverseSpeed4=inverseSpeed2*inverseSpeed2;
-        const auto inverseSpeed6=inverseSpeed4*inverseSpeed2;
-        const auto parameterDerivative=scaled(third,inverseSpeed2)
-            +scaled(second,-3.0*firstSecond*inverseSpeed4)
-            +scaled(first,-(secondSquared+firstThird)*inverseSpeed4)
-            +scaled(first,4.0*firstSecond*firstSecond*inverseSpeed6);
-        return scaled(parameterDerivative,1.0/speed);
+        if(position) *position=this->position(parameter);
+        if(!tangent&&!curvature&&!curvatureDerivative) return;
+
+        // Same expressions as derivative(), secondDerivative() and thirdDerivative(),
+        // evaluated on one pair of rotated arms.
+        position_t first=m_arc.to()-m_arc.from();
+        position_t second{};
+        position_t third{};
+        if(m_geometry) {
+            const auto &geometry=*m_geometry;
+            const auto start=rotate(geometry.startArm,geometry.sweep*parameter,geometry.axisUnit);
+            const auto end=rotate(geometry.endArm,-geometry.sweep*(1.0-parameter),geometry.axisUnit);
+            const auto startDerivative=scale(cross(geometry.axisUnit,start),geometry.sweep);
+            const auto endDerivative=scale(cross(geometry.axisUnit,end),geometry.sweep);
+            const auto firstXyz=scale(start,-1.0)+scale(startDerivative,1.0-parameter)
+                +end+scale(endDerivative,parameter)+geometry.axial;
+            first.x=firstXyz.x; first.y=firstXyz.y; first.z=firstXyz.z;
+            if(curvature||curvatureDerivative) {
+                const auto startSecond=scale(cross(geometry.axisUnit,startDerivative),geometry.sweep);
+                const auto endSecond=scale(cross(geometry.axisUnit,endDerivative),geometry.sweep);
+                const auto secondXyz=scale(startDerivative,-2.0)+scale(startSecond,1.0-parameter)
+                    +scale(endDerivative,2.0)+scale(endSecond,parameter);
+                second={secondXyz.x,secondXyz.y,secondXyz.z,0.0,0.0,0.0};
+                if(curvatureDerivative) {
+                    const auto startThird=scale(cross(geometry.axisUnit,startSecond),geometry.sweep);
+                    const auto endThird=scale(cross(geometry.axisUnit,endSecond),geometry.sweep);
+                    const auto thirdXyz=scale(startSecond,-3.0)+scale(startThird,1.0-parameter)
+                        +scale(endSecond,3.0)+scale(endThird,parameter);
+                    third={thirdXyz.x,thirdXyz.y,thirdXyz.z,0.0,0.0,0.0};
+                }
+            }
+        }
+
+        if(tangent) {
+            const auto magnitude=first.length();
+            *tangent=magnitude>0.0?scaled(first,1.0/magnitude):position_t{};
+        }
+        if(curvature) {
+            const auto speedSquared=first.x*first.x+first.y*first.y+first.z*first.z
+                +first.a*first.a+first.b*first.b+first.c*first.c;
+            if(speedSquared<=1e-30) *curvature={};
+            else {
+                const auto firstSecond=first.x*second.x+first.y*second.y+first.z*second.z
+                    +first.a*second.a+first.b*second.b+first.c*second.c;
+                *curvature=scaled(second,1.0/speedSquared)
+                    -scaled(first,firstSecond/(speedSquared*speedSquared));
+            }
+        }
+        if(curvatureDerivative) {
+            const auto speed=first.length();
+            if(speed<=1e-15) *curvatureDerivative={};
+            else {
+                const auto firstSecond=positionDot(first,second);
+                const auto secondSquared=positionDot(second,second);
+                const auto firstThird=positionDot(first,third);
+                const auto inverseSpeed2=1.0/(speed*speed);
+                const auto inverseSpeed4=inverseSpeed2*inverseSpeed2;
+                const auto inverseSpeed6=inverseSpeed4*inverseSpeed2;
+                const auto parameterDerivative=scaled(third,inverseSpeed2)
+                    +scaled(second,-3.0*firstSecond*inverseSpeed4)
+                    +scaled(first,-(secondSquared+firstThird)*inverseSpeed4)
+                    +scaled(first,4.0*firstSecond*firstSecond*inverseSpeed6);
+                *curvatureDerivative=scaled(parameterDerivative,1.0/speed);
+            }
+        }
     }
 
     double ArcReference::chordErrorBound(const double fromDistance, const double toDistance) const {
@@ -6,97 +6,116 @@
 #include <print>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <format>
 #include <limits>
 #include <vector>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <ranges>
+#include <span>
 #include <utility>
 
+#include "evaluator/Bytecode.h"
 #include "parser/SubSignature.h"
 #include "memory/Memory.h"
 #include "gcode/GCode.h"
 
 namespace ngc {
-    class Evaluator::Impl final : public Visitor {
-        std::vector<std::unordered_map<std::string_view, uint32_t>> m_scope;
-        std::vector<std::unordered_map<SubSignature, const SubStatement *>> m_subScope;
-        Memory &m_mem;
-        const std::function<void(std::unique_ptr<const EvaluatorMessage>, Evaluator &)> &m_callback;
-        Evaluator &m_owner;
-        std::function<void()> m_interrupt;
+    class Evaluator::Impl final {
+        enum class Action : std::uint8_t {
+            NONE,
+            RETURN,
+            BREAK,
+            CONTINUE
+        };
 
-        class Scope {
-            Impl *m_evaluator = nullptr;
-            bool m_opened = false;
-            bool m_global = false;
+        // a statement list runs in a context: the global one, a sub body, or a single if or loop body
+        struct Context {
+            bool global = false;
+            bool opened = false;
+            Action action = Action::NONE;
+            double result = 0.0;
+        };
 
-        public:
-            explicit Scope(Impl &evaluator, const bool global) : m_evaluator(&evaluator), m_global(global) { }
-            Scope() = default;
+        // symbols bound in one open scope, so they can be unbound when it closes
+        struct Scope {
+            std::vector<std::uint32_t> variables;
+            std::vector<std::uint32_t> subs;
+        };
 
-            ~Scope() {
-                if(m_opened) {
-                    for(auto _ : m_evaluator->m_scope.back()) {
-                        m_evaluator->m_mem.pop();
-                    }
+        struct VariableBinding {
+            std::uint32_t depth;
+            std::uint32_t address;
+        };
 
-                    m_evaluator->m_scope.pop_back();
-                    m_evaluator->m_subScope.pop_back();
-                }
-            }
+        struct SubBinding {
+            std::uint32_t depth;
+            const SubStatement *statement;
+            const Chunk *chunk;
+        };
 
-            [[nodiscard]] bool global() const { return m_global; }
+        // restores the shared stacks to where a run or call found them, closing the scopes it opened
+        class Frame {
+            Impl &m_impl;
+            std::size_t m_values;
+            std::size_t m_contexts;
+            std::size_t m_callees;
+            std::size_t m_texts;
 
-            void allocate(const NamedVariableExpression *expr, const double value) {
-                if(!m_evaluator) {
-                    throw std::logic_error("Scope::allocate called on default constructed Scope");
+        public:
+            explicit Frame(Impl &impl) : m_impl(impl), m_values(impl.m_values.size()), m_contexts(impl.m_contexts.size()), m_callees(impl.m_callees.size()), m_texts(impl.m_texts.size()) { }
+            Frame(const Frame &) = delete;
+            Frame &operator=(const Frame &) = delete;
+
+            ~Frame() {
+                // claimed up front, since a claim can throw if the run is being stopped; the memory of a stopped
+                // run is then left for the next run to reset
+                auto releaseMemory = true;
+
+                if(m_impl.m_contexts.size() > m_contexts) {
+                    try {
+                        m_impl.claimMemory();
+                    } catch(...) {
+                        releaseMemory = false;
+                    }
                 }
 
-                if(!m_global && !m_opened) {
-                    openScope();
+                while(m_impl.m_contexts.size() > m_contexts) {
+                    m_impl.leaveContext(releaseMemory);
                 }
 
-                if(m_evaluator->m_scope.size() == 1) {
-                    if(m_evaluator->m_scope.front().contains(expr->name())) {
-                        throw std::logic_error(std::format("redeclared global variable '{}'", expr->name()));
-                    }
-
-                    uint32_t addr = m_evaluator->m_mem.addData(MemoryCell(MemoryCell::Flags::READ | MemoryCell::Flags::WRITE, value));
-                    m_evaluator->m_scope.front().emplace(expr->name(), addr);
-                } else {
-                    if(m_evaluator->m_scope.back().contains(expr->name())) {
-                        throw std::logic_error(std::format("redeclared local variable '{}'", expr->name()));
-                    }
-
-                    uint32_t addr = m_evaluator->m_mem.push(value);
-                    m_evaluator->m_scope.back().emplace(expr->name(), addr);
-                }
+                m_impl.m_values.resize(m_values);
+                m_impl.m_callees.resize(m_callees);
+                m_impl.m_texts.resize(m_texts);
             }
 
-        private:
-            void openScope() {
-                m_evaluator->m_scope.emplace_back();
-                m_evaluator->m_subScope.emplace_back();
-                m_opened = true;
-            }
+            [[nodiscard]] std::size_t contexts() const { return m_contexts; }
         };
 
-        struct Context final : VisitorContext {
-            enum Action {
-                NONE,
-                RETURN,
-                BREAK,
-                CONTINUE
-            };
+        SymbolTable m_symbols;
+        // bindings per symbol id, innermost last, so the dynamic scope chain resolves by index instead of by search
+        std::vector<std::vector<VariableBinding>> m_variables;
+        std::vector<std::vector<SubBinding>> m_subs;
+        // the global scope first; entries from m_depth on are closed and only kept for their capacity
+        std::vector<Scope> m_scopes;
+        std::size_t m_depth = 1;
+        // node-based, so chunks keep their address while more subs are compiled
+        std::unordered_map<const SubStatement *, Chunk> m_subChunks;
+
+        std::vector<double> m_values;
+        std::vector<Context> m_contexts;
+        std::vector<SubBinding> m_callees;
+        std::vector<std::string> m_texts;
+        EvaluatorDiagnostics m_diagnostics;
+        // a block was published since memory was last known to be ours
+        bool m_memoryShared = false;
 
-            Scope scope;
-            Action action = NONE;
-            double result = 0.0;
-        };
-
-        static Context *context(VisitorContext *ctx) { return static_cast<Context *>(ctx); }
+        Memory &m_mem;
+        const std::function<void(std::unique_ptr<const EvaluatorMessage>, Evaluator &)> &m_callback;
+        Evaluator &m_owner;
+        std::function<void()> m_interrupt;
 
         static uint32_t toAddress(const double value) {
             if (!std::isfinite(value) || value < 0.0
@@ -112,21 +131,18 @@ namespace ngc {
         explicit Impl(Evaluator &owner, Memory &mem,
                            const std::function<void(std::unique_ptr<const EvaluatorMessage>, Evaluator &)> &callback,
                            std::function<void()> interrupt = {})
-            : m_scope(1), m_subScope(1), m_mem(mem), m_callback(callback), m_owner(owner), m_interrupt(std::move(interrupt)) { }
-
-        template<typename ...Args>
-        double call(std::string name, Args... args) requires (std::convertible_to<Args, double> && ...) {
-            std::vector<std::unique_ptr<ScalarExpression>> args2;
-            (args2.emplace_back(LiteralExpression::fromDouble(args)), ...);
-            return callImpl(std::move(name), std::move(args2));
-        }
+            : m_scopes(1), m_mem(mem), m_callback(callback), m_owner(owner), m_interrupt(std::move(interrupt)) { }
 
         void declareGlobal(const NamedVariableExpression *expr, uint32_t addr, const std::optional<double> value = std::nullopt) {
-            if(m_scope.back().contains(expr->name())) {
+            const auto id = m_symbols.name(expr->name());
+            bindSymbols();
+
+            if(declared(id)) {
                 throw std::logic_error(std::format("already declared global variable '{}'", expr->name()));
             }
 
             if(addr == 0) {
+                claimMemory();
                 const auto _value = value ? *value : 0.0;
                 addr = m_mem.addData(MemoryCell(MemoryCell::Flags::READ | MemoryCell::Flags::WRITE, _value));
             } else {
@@ -135,22 +151,20 @@ namespace ngc {
                 }
             }
 
-            m_scope.back().emplace(expr->name(), addr);
+            bind(id, addr);
         }
 
         void executeFirstPass(const std::span<const Statement * const> program) {
-            auto ctx = createScopeContext(true);
-
             for(const auto &stmt : program) {
                 interrupt();
                 if(const auto s = stmt->as<AliasStatement>(); s) {
-                    const auto addr = toAddress(eval(s->address(), &ctx));
+                    const auto addr = toAddress(evaluate(s->address()));
                     declareGlobal(s->variable(), addr);
                     continue;
                 }
 
                 if(const auto s = stmt->as<LetStatement>(); s) {
-                    const auto value = s->value() ? eval(s->value(), &ctx) : 0.0;
+                    const auto value = s->value() ? evaluate(s->value()) : 0.0;
                     declareGlobal(s->variable(), 0, value);
                     continue;
                 }
@@ -162,330 +176,437 @@ namespace ngc {
         }
 
         void executeSecondPass(const std::span<const Statement * const> program) {
-            auto ctx = createScopeContext(true);
-
-            for(const auto &stmt : program) {
-                executeStatement(stmt, &ctx);
-            }
+            Chunk chunk;
+            Compiler(chunk, m_symbols).compileProgram(program);
+            compiled(chunk);
+            run(chunk, 0, true);
         }
 
-        void visit(const SubStatement* stmt, VisitorContext* ctx) override {
-            if(context(ctx)->scope.global()) {
-                return;
+        double callImpl(const std::string &name, const std::span<const double> args) {
+            const auto signature = SubSignature(name, args.size());
+            const auto id = m_symbols.findSub(signature);
+
+            if(!id || m_subs[*id].empty()) {
+                throw std::logic_error(std::format("undefined sub '{}'", signature.toString()));
             }
 
-            declareSub(stmt);
+            const auto frame = Frame(*this);
+            const auto callee = m_subs[*id].back();
+            const auto arguments = m_values.size();
+            m_values.insert(m_values.end(), args.begin(), args.end());
+            return invokeSub(callee, arguments, args.size());
         }
 
-        void visit(const ExpressionStatement* stmt, VisitorContext* ctx) override {
-            stmt->expression()->accept(*this, ctx);
+        void synchronize() {
+            m_callback(std::make_unique<SynchronizationMessage>(), m_owner);
+            m_memoryShared = false;
         }
 
-        void visit(const CompoundStatement* stmt, VisitorContext* ctx) override {
-            Context newCtx;
+        void pauseProgram() {
+            m_callback(std::make_unique<ProgramPauseMessage>(), m_owner);
+        }
 
-            if(!ctx) {
-                newCtx = createScopeContext();
-                ctx = &newCtx;
-            }
+        [[nodiscard]] const EvaluatorDiagnostics &diagnostics() const { return m_diagnostics; }
 
-            for(const auto &s : stmt->statements()) {
-                executeStatement(s.get(), ctx);
-                if(context(ctx)->action != Context::NONE) break;
-            }
+        void toolChangeModalStateRestored() {
+            m_callback(
+                std::make_unique<ToolChangeModalStateRestoredMessage>(), m_owner);
         }
 
-        void visit(const AliasStatement *stmt, VisitorContext *ctx) override {
-            if(context(ctx)->scope.global()) {
-                return;
-            }
+    private:
+        double run(const Chunk &chunk, const std::size_t arguments, const bool global) {
+            const auto frame = Frame(*this);
+            m_contexts.push_back({ .global = global });
 
-            auto addr = toAddress(eval(stmt->address(), ctx));
-            m_scope.back().emplace(stmt->variable()->name(), addr);
-        }
+            const auto code = chunk.code.data();
+            std::uint32_t pc = 0;
 
-        void visit(const LetStatement* stmt, VisitorContext* ctx) override {
-            if(context(ctx)->scope.global()) {
-                return;
+            try {
+                for(;;) {
+                    const auto [op, operand] = code[pc++];
+
+                    switch(op) {
+                        case OpCode::STATEMENT:
+                            interrupt();
+                            break;
+                        case OpCode::CONSTANT:
+                            m_values.push_back(chunk.constants[operand]);
+                            break;
+                        case OpCode::ARGUMENT: {
+                            const auto value = m_values[arguments + operand];
+                            m_values.push_back(value);
+                            break;
+                        }
+                        case OpCode::LOOKUP:
+                            m_values.push_back(lookup(operand));
+                            break;
+                        case OpCode::SYNCHRONIZE:
+                            synchronize();
+                            break;
+                        case OpCode::READ:
+                            m_values.back() = read(toAddress(m_values.back()));
+                            break;
+                        case OpCode::ADDRESS:
+                            m_values.back() = toAddress(m_values.back());
+                            break;
+                        case OpCode::ASSIGN: {
+                            const auto right = pop();
+                            write(toAddress(m_values.back()), right);
+                            m_values.back() = right;
+                            break;
+                        }
+                        case OpCode::POP:
+                            m_values.pop_back();
+                            break;
+                        case OpCode::NEGATE:
+                            m_values.back() = -m_values.back();
+                            break;
+                        case OpCode::ADD: { const auto right = pop(); m_values.back() += right; break; }
+                        case OpCode::SUB: { const auto right = pop(); m_values.back() -= right; break; }
+                        case OpCode::MUL: { const auto right = pop(); m_values.back() *= right; break; }
+                        case OpCode::DIV: { const auto right = pop(); m_values.back() /= right; break; }
+                        case OpCode::MOD: { const auto right = pop(); m_values.back() = std::fmod(m_values.back(), right); break; }
+                        case OpCode::EQ: { const auto right = pop(); m_values.back() = m_values.back() == right; break; }
+                        case OpCode::NE: { const auto right = pop(); m_values.back() = m_values.back() != right; break; }
+                        case OpCode::LT: { const auto right = pop(); m_values.back() = m_values.back() < right; break; }
+                        case OpCode::LE: { const auto right = pop(); m_values.back() = m_values.back() <= right; break; }
+                        case OpCode::GT: { const auto right = pop(); m_values.back() = m_values.back() > right; break; }
+                        case OpCode::GE: { const auto right = pop(); m_values.back() = m_values.back() >= right; break; }
+                        case OpCode::AND: {
+                            const auto right = static_cast<bool>(pop());
+                            m_values.back() = static_cast<bool>(m_values.back()) && right;
+                            break;
+                        }
+                        case OpCode::OR: {
+                            const auto right = static_cast<bool>(pop());
+                            m_values.back() = static_cast<bool>(m_values.back()) || right;
+                            break;
+                        }
+                        case OpCode::XOR: {
+                            const auto right = static_cast<bool>(pop());
+                            const auto left = static_cast<bool>(m_values.back());
+                            m_values.back() = (left && !right) || (right && !left);
+                            break;
+                        }
+                        case OpCode::JUMP:
+                            pc = operand;
+                            break;
+                        case OpCode::JUMP_IF_ZERO:
+                            if(!(pop() != 0.0)) {
+                                pc = operand;
+                            }
+                            break;
+                        case OpCode::JUMP_IF_ACTION:
+                            if(m_contexts.back().action != Action::NONE) {
+                                pc = operand;
+                            }
+                            break;
+                        case OpCode::JUMP_IF_RETURN:
+                            if(m_contexts.back().action == Action::RETURN) {
+                                pc = operand;
+                            }
+                            break;
+                        case OpCode::ENTER_CONTEXT:
+                            m_contexts.push_back({});
+                            break;
+                        case OpCode::LEAVE_IF: {
+                            const auto child = leaveContext();
+                            propagateAction(m_contexts.back(), child);
+                            break;
+                        }
+                        case OpCode::LEAVE_LOOP: {
+                            const auto child = leaveContext();
+
+                            if(child.action == Action::RETURN) {
+                                propagateAction(m_contexts.back(), child);
+                                pc = operand;
+                            } else if(child.action == Action::BREAK) {
+                                pc = operand;
+                            }
+                            break;
+                        }
+                        case OpCode::BREAK:
+                            m_contexts.back().action = Action::BREAK;
+                            break;
+                        case OpCode::CONTINUE:
+                            m_contexts.back().action = Action::CONTINUE;
+                            break;
+                        case OpCode::RETURN:
+                            m_contexts.back().result = pop();
+                            m_contexts.back().action = Action::RETURN;
+                            break;
+                        case OpCode::ALLOCATE:
+                            allocate(m_contexts.back(), operand, pop());
+                            break;
+                        case OpCode::ALIAS: {
+                            const auto addr = toAddress(pop());
+
+                            if(!declared(operand)) {
+                                bind(operand, addr);
+                            }
+                            break;
+                        }
+                        case OpCode::DECLARE_SUB:
+                            declareSub(chunk.subs[operand]);
+                            break;
+                        case OpCode::FIND_SUB:
+                            m_callees.push_back(findSub(operand));
+                            break;
+                        case OpCode::CALL: {
+                            const auto callee = m_callees.back();
+                            m_callees.pop_back();
+                            const auto callArguments = m_values.size() - operand;
+                            const auto result = invokeSub(callee, callArguments, operand);
+                            m_values.resize(callArguments);
+                            m_values.push_back(result);
+                            break;
+                        }
+                        case OpCode::BLOCK:
+                            block(chunk.blocks[operand]);
+                            break;
+                        case OpCode::BEGIN_TEXT:
+                            m_texts.emplace_back();
+                            break;
+                        case OpCode::APPEND_VALUE:
+                            m_texts.back() += std::format("{}", pop());
+                            break;
+                        case OpCode::APPEND_STRING:
+                            m_texts.back() += chunk.strings[operand];
+                            break;
+                        case OpCode::PRINT:
+                        case OpCode::ALERT: {
+                            auto text = std::move(m_texts.back());
+                            m_texts.pop_back();
+
+                            if(op == OpCode::ALERT) {
+                                m_callback(std::make_unique<AlertMessage>(std::move(text)), m_owner);
+                            } else {
+                                m_callback(std::make_unique<PrintMessage>(std::move(text)), m_owner);
+                            }
+
+                            // built in functions return 0
+                            m_values.push_back(0.0);
+                            break;
+                        }
+                        case OpCode::FAIL:
+                            throw std::runtime_error(chunk.messages[operand]);
+                        case OpCode::END: {
+                            const auto &context = m_contexts[frame.contexts()];
+                            return context.action == Action::RETURN ? context.result : 0.0;
+                        }
+                    }
+                }
+            } catch(const std::exception &error) {
+                rethrowWithLocation(chunk, pc - 1, error);
             }
+        }
 
-            double value = 0.0;
+        double evaluate(const RealExpression *expression) {
+            Chunk chunk;
+            Compiler(chunk, m_symbols).compileExpression(expression);
+            compiled(chunk);
+            return run(chunk, 0, true);
+        }
 
-            if(stmt->value()) {
-                value = eval(stmt->value(), ctx);
+        double invokeSub(const SubBinding &callee, const std::size_t arguments, const std::size_t count) {
+            if(callee.statement->params().size() != count) {
+                throw std::runtime_error("params.size() != args.size()");
             }
 
-            context(ctx)->scope.allocate(stmt->variable(), value);
+            return run(*callee.chunk, arguments, false);
         }
 
-        void visit(const BlockStatement* stmt, VisitorContext* ctx) override {
-            std::vector<Word> words;
+        void declareSub(const SubStatement *stmt) {
+            const auto id = m_symbols.sub(SubSignature(stmt));
+            const auto &chunk = compileSub(stmt);
+            bindSymbols();
 
-            for(const auto &expr : stmt->expressions()) {
-                const Letter letter = convertLetter(expr->token().kind());
-                const double real = eval(expr->real(), ctx);
-                words.emplace_back(expr.get(), letter, real);
+            if(!m_subs[id].empty() && m_subs[id].back().depth == innermost()) {
+                throw std::logic_error(std::format("redeclared subroutine '{}'", stmt->name()));
             }
 
-            m_callback(std::make_unique<BlockMessage>(Block(stmt, std::move(words))), m_owner);
+            m_subs[id].push_back({ innermost(), stmt, &chunk });
+            m_scopes[innermost()].subs.push_back(id);
         }
 
-        void visit(const ReturnStatement* stmt, VisitorContext* ctx) override {
-            context(ctx)->result = eval(stmt->real(), ctx);
-            context(ctx)->action = Context::RETURN;
-        }
+        const Chunk &compileSub(const SubStatement *stmt) {
+            const auto [it, inserted] = m_subChunks.try_emplace(stmt);
 
-        void visit(const BreakStatement *, VisitorContext* ctx) override {
-            context(ctx)->action = Context::BREAK;
-        }
+            if(inserted) {
+                Compiler(it->second, m_symbols).compileSub(stmt);
+                compiled(it->second);
+            }
 
-        void visit(const ContinueStatement *, VisitorContext* ctx) override {
-            context(ctx)->action = Context::CONTINUE;
+            return it->second;
         }
 
-        void visit(const IfStatement* stmt, VisitorContext* ctx) override {
-            if(eval(stmt->condition(), ctx) != 0.0) {
-                auto newCtx = createScopeContext();
-                executeStatement(stmt->body(), &newCtx);
-                propagateAction(*context(ctx), newCtx);
-            } else {
-                if(stmt->elseBody()) {
-                    auto newCtx = createScopeContext();
-                    executeStatement(stmt->elseBody(), &newCtx);
-                    propagateAction(*context(ctx), newCtx);
-                }
+        SubBinding findSub(const std::uint32_t id) const {
+            if(m_subs[id].empty()) {
+                throw std::logic_error(std::format("undefined sub '{}'", m_symbols.subOf(id).toString()));
             }
-        }
-
-        void visit(const WhileStatement* stmt, VisitorContext* ctx) override {
-            while(eval(stmt->condition(), ctx) != 0.0) {
-                auto newCtx = createScopeContext();
-                executeStatement(stmt->body(), &newCtx);
 
-                if(newCtx.action == Context::RETURN) {
-                    propagateAction(*context(ctx), newCtx);
-                    return;
-                }
-                if(newCtx.action == Context::BREAK) return;
-            }
+            return m_subs[id].back();
         }
 
-        void visit(const CallExpression* expr, VisitorContext* ctx) override {
-            // functions implicitly return 0 if they dont return explicitly
-            context(ctx)->result = 0.0;
+        double lookup(const std::uint32_t id) const {
+            const auto &bindings = m_variables[id];
+            const auto addr = bindings.empty() ? 0 : bindings.back().address;
 
-            // TODO: more extensible way to evaluate built in functions
-            if (expr->name() == "print" || expr->name() == "alert") {
-                synchronize();
-                std::string text;
+            if(addr == 0) {
+                throw std::logic_error(std::format("undeclared variable '{}'", m_symbols.nameOf(id)));
+            }
 
-                for(const auto &arg : expr->args()) {
-                    if(const auto real = arg->as<RealExpression>()) {
-                        text += std::format("{}", eval(real, ctx));
-                    } else if(const auto str = arg->as<StringExpression>()) {
-                        text += str->value();
-                    }
-                }
+            return addr;
+        }
 
-                if (expr->name() == "alert") {
-                    m_callback(std::make_unique<AlertMessage>(text), m_owner);
-                } else {
-                    m_callback(std::make_unique<PrintMessage>(text), m_owner);
-                }
-                return;
+        void allocate(Context &context, const std::uint32_t id, const double value) {
+            if(!context.global && !context.opened) {
+                openScope();
+                context.opened = true;
             }
 
-            const auto sig = SubSignature(expr);
-            const SubStatement *stmt = nullptr;
+            claimMemory();
 
-            for(const auto &scope : std::views::reverse(m_subScope)) {
-                if(scope.contains(sig)) {
-                    stmt = scope.at(sig);
-                    break;
+            if(m_depth == 1) {
+                if(declared(id)) {
+                    throw std::logic_error(std::format("redeclared global variable '{}'", m_symbols.nameOf(id)));
                 }
-            }
-
-            if(!stmt) {
-                throw std::logic_error(std::format("undefined sub '{}'", sig.toString()));
-            }
 
-            auto &params = stmt->params();
-            auto &args = expr->args();
+                bind(id, m_mem.addData(MemoryCell(MemoryCell::Flags::READ | MemoryCell::Flags::WRITE, value)));
+            } else {
+                if(declared(id)) {
+                    throw std::logic_error(std::format("redeclared local variable '{}'", m_symbols.nameOf(id)));
+                }
 
-            if(params.size() != args.size()) {
-                throw std::runtime_error("params.size() != args.size()");
+                bind(id, m_mem.push(value));
             }
+        }
 
-            Context newCtx = createScopeContext();
+        void block(const BlockStatement *stmt) {
+            const auto expressions = stmt->expressions();
+            const auto base = m_values.size() - expressions.size();
+            std::vector<Word> words;
+            words.reserve(expressions.size());
 
-            for(size_t i = 0; i < params.size(); i++) {
-                const auto arg = expect<RealExpression>(args[i].get());
-                const auto value = eval(arg, ctx);
-                newCtx.scope.allocate(params[i].get(), value);
+            for(size_t i = 0; i < expressions.size(); i++) {
+                words.emplace_back(expressions[i], convertLetter(expressions[i]->token().kind()), m_values[base + i]);
             }
 
-            for(const auto &s : stmt->body()->statements()) {
-                executeStatement(s.get(), &newCtx);
-
-                if(newCtx.action == Context::RETURN) {
-                    context(ctx)->result = newCtx.result;
-                    break;
-                }
-            }
+            m_values.resize(base);
+            m_callback(std::make_unique<BlockMessage>(Block(stmt, std::move(words))), m_owner);
+            m_memoryShared = true;
         }
 
-        void visit(const NumericVariableExpression* expr, VisitorContext* ctx) override {
-            const auto addr = toAddress(eval(expr->real(), ctx));
-            context(ctx)->result = addr;
+        void claimMemory() {
+            if(m_memoryShared) {
+                m_memoryShared = false;
+                m_callback(std::make_unique<MemoryAccessMessage>(), m_owner);
+            }
         }
 
-        void visit(const NamedVariableExpression* expr, VisitorContext* ctx) override {
-            uint32_t addr = 0;
+        // statements wrap errors in their location, innermost first, unless the message already starts with it
+        [[noreturn]] static void rethrowWithLocation(const Chunk &chunk, const std::uint32_t pc, const std::exception &error) {
+            std::string message = error.what();
+            bool wrapped = false;
 
-            for(const auto &scope : std::views::reverse(m_scope)) {
-                if(scope.contains(expr->name())) {
-                    addr = scope.at(expr->name());
-                    break;
+            for(const auto &range : std::views::reverse(chunk.statements)) {
+                if(pc < range.begin || pc >= range.end) {
+                    continue;
                 }
-            }
 
-            if(addr == 0) {
-                throw std::logic_error(std::format("undeclared variable '{}'", expr->name()));
-            }
+                const auto location = range.statement->startToken().location();
 
-            context(ctx)->result = addr;
-        }
-
-        void visit(const BinaryExpression* expr, VisitorContext* ctx) override {
-            double left;
-            double right;
-
-            if(expr->op() == BinaryExpression::Op::ASSIGN) {
-                if(!expr->left()->is<VariableExpression>()) {
-                    throw std::logic_error(std::format("tried to assign to {}", expr->className()));
+                if(!message.starts_with(location)) {
+                    message = std::format("{}: {}", location, message);
+                    wrapped = true;
                 }
-
-                left = eval(expr->left(), ctx, false);
-                right = eval(expr->right(), ctx);
-                const auto addr = toAddress(left);
-                write(addr, right);
-            } else {
-                left = eval(expr->left(), ctx);
-                right = eval(expr->right(), ctx);
             }
 
-            double result;
-
-            switch (expr->op()) {
-                using enum BinaryExpression::Op;
-                case ASSIGN: result = right; break;
-                case AND: result = static_cast<bool>(left) && static_cast<bool>(right); break;
-                case OR: result = static_cast<bool>(left) || static_cast<bool>(right); break;
-                case XOR: result = (static_cast<bool>(left) && !static_cast<bool>(right)) || (static_cast<bool>(right) && !static_cast<bool>(left)); break;
-                case EQ: result = left == right; break;
-                case NE: result = left != right; break;
-                case LT: result = left < right; break;
-                case LE: result = left <= right; break;
-                case GT: result = left > right; break;
-                case GE: result = left >= right; break;
-                case ADD: result = left + right; break;
-                case SUB: result = left - right; break;
-                case MUL: result = left * right; break;
-                case DIV: result = left / right; break;
-                case MOD: result = std::fmod(left, right); break;
-                default: throw std::logic_error("missing ");
+            if(!wrapped) {
+                throw;
             }
 
-            context(ctx)->result = result;
+            throw std::runtime_error(message);
         }
 
-        void visit(const UnaryExpression* expr, VisitorContext* ctx) override {
-            double value;
-
-            if(expr->op() == UnaryExpression::Op::ADDRESS_OF) {
-                if(!expr->real()->is<VariableExpression>()) {
-                    throw std::runtime_error(std::format("tried to take address of {}", expr->className()));
-                }
-
-                value = toAddress(eval(expr->real(), ctx, false));
-            } else {
-                value = eval(expr->real(), ctx);
-            }
-
-            double result;
+        [[nodiscard]] std::uint32_t innermost() const {
+            return static_cast<std::uint32_t>(m_depth - 1);
+        }
 
-            switch (expr->op()) {
-                case UnaryExpression::Op::NEGATIVE: result = -value; break;
-                case UnaryExpression::Op::POSITIVE:
-                case UnaryExpression::Op::ADDRESS_OF: result = value; break;
-                default: throw std::runtime_error(std::format("invalid unary operator UnaryExpression::Op{}", std::to_underlying(expr->op())));
-            }
+        [[nodiscard]] bool declared(const std::uint32_t id) const {
+            const auto &bindings = m_variables[id];
+            return !bindings.empty() && bindings.back().depth == innermost();
+        }
 
-            context(ctx)->result = result;
+        void bind(const std::uint32_t id, const std::uint32_t addr) {
+            m_variables[id].push_back({ innermost(), addr });
+            m_scopes[innermost()].variables.push_back(id);
         }
 
-        void visit(const GroupingExpression* expr, VisitorContext* ctx) override {
-            context(ctx)->result = eval(expr->real(), ctx);
+        void compiled(const Chunk &chunk) {
+            m_diagnostics.foldedExpressions += chunk.foldedExpressions;
+            m_diagnostics.prunedBranches += chunk.prunedBranches;
+            bindSymbols();
         }
 
-        void visit(const LiteralExpression* expr, VisitorContext* ctx) override {
-            context(ctx)->result = expr->value();
+        // symbols interned by a compile get their (empty) binding stacks
+        void bindSymbols() {
+            m_variables.resize(m_symbols.names());
+            m_subs.resize(m_symbols.subs());
         }
 
-        // not needed
-        void visit(const StringExpression*, VisitorContext*) override { }
-        void visit(const CommentExpression*, VisitorContext*) override { }
-        void visit(const WordExpression*, VisitorContext*) override { }
+        void openScope() {
+            if(m_scopes.size() == m_depth) {
+                m_scopes.emplace_back();
+            }
 
-    private:
-        static void propagateAction(Context &parent, const Context &child) {
-            parent.action = child.action;
-            if(child.action == Context::RETURN) parent.result = child.result;
+            m_depth++;
         }
 
-        Context createScopeContext(const bool global = false) { return Context { .scope = Scope(*this, global) }; }
+        void closeScope(const bool releaseMemory) {
+            auto &scope = m_scopes[innermost()];
 
-    public:
-        double callImpl(std::string name, std::vector<std::unique_ptr<ScalarExpression>> args) {
-            const auto startToken = Token::fromString(Token::Kind::IDENTIFIER, std::move(name));
-            const auto endToken = Token::fromString(Token::Kind::RBRACKET, "]");
-            const auto call = std::make_unique<CallExpression>(startToken, endToken, std::move(args));
-            auto ctx = createScopeContext(true);
-            return eval(call.get(), &ctx);
-        }
+            if(releaseMemory && !scope.variables.empty()) {
+                claimMemory();
+            }
 
-        void declareSub(const SubStatement *stmt) {
-            auto sig = SubSignature(stmt);
+            for(const auto id : scope.variables) {
+                m_variables[id].pop_back();
 
-            if(m_subScope.back().contains(sig)) {
-                throw std::logic_error(std::format("redeclared subroutine '{}'", sig.name()));
+                if(releaseMemory) {
+                    m_mem.pop();
+                }
             }
 
-            m_subScope.back().emplace(sig, stmt);
+            for(const auto id : scope.subs) {
+                m_subs[id].pop_back();
+            }
+
+            scope.variables.clear();
+            scope.subs.clear();
+            m_depth--;
         }
 
-        void executeStatement(const Statement *statement, VisitorContext *ctx) {
-            interrupt();
-            try {
-                statement->accept(*this, ctx);
-            } catch(const std::exception &error) {
-                const auto location = statement->startToken().location();
-                if(std::string_view(error.what()).starts_with(location)) throw;
-                throw std::runtime_error(std::format("{}: {}", location, error.what()));
+        Context leaveContext(const bool releaseMemory = true) {
+            const auto context = m_contexts.back();
+
+            if(context.opened) {
+                closeScope(releaseMemory);
             }
-        }
 
-        void synchronize() {
-            m_callback(std::make_unique<SynchronizationMessage>(), m_owner);
+            m_contexts.pop_back();
+            return context;
         }
 
-        void pauseProgram() {
-            m_callback(std::make_unique<ProgramPauseMessage>(), m_owner);
+        static void propagateAction(Context &parent, const Context &child) {
+            parent.action = child.action;
+            if(child.action == Action::RETURN) parent.result = child.result;
         }
 
-        void toolChangeModalStateRestored() {
-            m_callback(
-                std::make_unique<ToolChangeModalStateRestoredMessage>(), m_owner);
+        double pop() {
+            const auto value = m_values.back();
+            m_values.pop_back();
+            return value;
         }
 
         void interrupt() const {
@@ -506,24 +627,6 @@ namespace ngc {
             throw std::logic_error("unknown memory error");
         }
 
-        double eval(const RealExpression *expr, VisitorContext *ctx, const bool dereference = true) {
-            if(dereference && expr->is<VariableExpression>()) synchronize();
-            expr->accept(*this, ctx);
-
-            if(dereference && expr->is<VariableExpression>()) {
-                const auto addr = toAddress(context(ctx)->result);
-                return read(addr);
-            }
-
-            return context(ctx)->result;
-        }
-
-        bool isVolatile(const uint32_t addr) {
-            const auto result = m_mem.isVolatile(addr);
-            if(!result) throwMemoryError(result.error());
-            return *result;
-        }
-
         [[nodiscard]] double read(const uint32_t addr) {
             auto result = m_mem.read(addr);
             if(!result) throwMemoryError(result.error());
@@ -531,27 +634,17 @@ namespace ngc {
         }
 
         void write(const uint32_t addr, const double value) {
+            claimMemory();
             if(auto result = m_mem.write(addr, value); !result)
                 throwMemoryError(result.error());
         }
-
-        template<typename T>
-        const T *expect(const Expression *expr) {
-            auto t = expr->as<T>();
-
-            if(!t) {
-                throw std::logic_error(std::format("expected {}, but found {}", T::staticClassName(), expr->className()));
-            }
-
-            return t;
-        }
     };
 
     Evaluator::Evaluator(Memory &memory, const Callback &callback, std::function<void()> interrupt)
         : m_impl(std::make_unique<Impl>(*this, memory, callback, std::move(interrupt))) { }
     Evaluator::~Evaluator() = default;
-    double Evaluator::callPrepared(std::string name, std::vector<std::unique_ptr<ScalarExpression>> args) {
-        return m_impl->callImpl(std::move(name), std::move(args));
+    double Evaluator::callPrepared(const std::string &name, const std::span<const double> args) {
+        return m_impl->callImpl(name, args);
     }
     void Evaluator::declareGlobal(const NamedVariableExpression *expression, const std::uint32_t address,
                                   const std::optional<double> value) {
@@ -574,4 +667,8 @@ namespace ngc {
     void Evaluator::toolChangeModalStateRestored() {
         m_impl->toolChangeModalStateRestored();
     }
+
+    const EvaluatorDiagnostics &Evaluator::diagnostics() const {
+        return m_impl->diagnostics();
+    }
 }
@@ -58,7 +58,7 @@ namespace ngc {
             m_physicalToolNumber = 0;
             m_pendingProbe.reset();
             m_state = GCodeState::makeDefault();
-            const auto num = static_cast<int>(m_memory.read(Var::COORDSYS));
+            const auto num = static_cast<int>(m_memory.read<Var::COORDSYS>());
             m_state.affectState(coordsys(num));
             m_workOffset = offset(*m_state.modeCoordSys);
         }
@@ -335,16 +335,16 @@ namespace ngc {
 
             const auto workPosition = result.triggerPosition - m_pendingProbe->workOffset - m_pendingProbe->toolOffset;
             const auto scale = linearScale(m_pendingProbe->programUnit);
-            m_memory.write(Var::PROBE_X, workPosition.x / scale, true);
-            m_memory.write(Var::PROBE_Y, workPosition.y / scale, true);
-            m_memory.write(Var::PROBE_Z, workPosition.z / scale, true);
-            m_memory.write(Var::PROBE_A, workPosition.a, true);
-            m_memory.write(Var::PROBE_B, workPosition.b, true);
-            m_memory.write(Var::PROBE_C, workPosition.c, true);
-            m_memory.write(Var::PROBE_U, 0.0, true);
-            m_memory.write(Var::PROBE_V, 0.0, true);
-            m_memory.write(Var::PROBE_W, 0.0, true);
-            m_memory.write(Var::PROBE_SUCCESS, result.status == ProbeStatus::Triggered ? 1.0 : 0.0, true);
+            m_memory.write<Var::PROBE_X>(workPosition.x / scale);
+            m_memory.write<Var::PROBE_Y>(workPosition.y / scale);
+            m_memory.write<Var::PROBE_Z>(workPosition.z / scale);
+            m_memory.write<Var::PROBE_A>(workPosition.a);
+            m_memory.write<Var::PROBE_B>(workPosition.b);
+            m_memory.write<Var::PROBE_C>(workPosition.c);
+            m_memory.write<Var::PROBE_U>(0.0);
+            m_memory.write<Var::PROBE_V>(0.0);
+            m_memory.write<Var::PROBE_W>(0.0);
+            m_memory.write<Var::PROBE_SUCCESS>(result.status == ProbeStatus::Triggered ? 1.0 : 0.0);
             m_pos = result.stoppedPosition;
             m_pendingProbe.reset();
         }
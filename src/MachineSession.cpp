@@ -175,7 +175,13 @@ namespace ngc {
                    m_geometryFeedback, m_geometryCancelled, limits),
           m_programExecution(m_executorDemand, m_driver,
                              m_coordinator.commands()),
-          m_limits(limits) { }
+          m_limits(limits) {
+        // re-runs and re-previews of this session reuse prepared windows
+        if(!m_geometryPolicy.preparationCache)
+            m_geometryPolicy.preparationCache = std::make_shared<PreparedGeometryCache>();
+        // horizon compiles run beside the servo-period refill loop
+        m_driver.setPipelinedPlanning(true);
+    }
 
     MachineSession::~MachineSession() {
         (void)finishExecutionEpoch(ExecutionEpochOutcome::Abandoned);
@@ -436,6 +442,7 @@ namespace ngc {
             result.diagnostics = m_geometryProducer->diagnostics();
         }
         m_geometryProducer.reset();
+        m_driver.finish();
         m_programExecution.finish();
         PreparedForwardMessage forward;
         while (m_geometryForward.tryPop(forward)) { }
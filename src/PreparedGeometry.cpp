@@ -8,6 +8,7 @@
 #include <numeric>
 #include <stdexcept>
 #include <tuple>
+#include <type_traits>
 
 #include "path_tempo/Sampling.h"
 
@@ -154,11 +155,42 @@ namespace ngc {
 
         CurveEvaluationWorkspace::SplineEntry &splineWorkspace(
                 const PreparedCurve &curve, CurveEvaluationWorkspace &workspace) {
-            const auto found = std::ranges::find_if(workspace.splines,
-                [&](const auto &entry) { return entry.curve == &curve; });
-            if(found != workspace.splines.end()) return *found;
-            workspace.splines.push_back({ .curve = &curve });
-            return workspace.splines.back();
+            if(auto *found = workspace.splines.find(curve)) return *found;
+            return workspace.splines.insert({ .curve = &curve });
+        }
+
+        // Monotone (Fritsch-Carlson limited) cubic Hermite interpolation of
+        // parameter(distance) over one table bracket, using dt/ds = 1/|q'| at
+        // its ends. Empty when the curve has no speeds or a bracket end stalls.
+        std::optional<double> splineInverseSeed(const PreparedSplineCurve &spline,
+                                                const std::size_t index, const double distance) {
+            if(spline.speeds.size() != spline.parameters.size()) return std::nullopt;
+            const auto low = spline.parameters[index];
+            const auto high = spline.parameters[index + 1];
+            const auto bracket = spline.distances[index + 1] - spline.distances[index];
+            const auto lowSpeed = spline.speeds[index];
+            const auto highSpeed = spline.speeds[index + 1];
+            if(!(bracket > 0.0) || !(lowSpeed > 1e-15) || !(highSpeed > 1e-15)
+               || !std::isfinite(lowSpeed) || !std::isfinite(highSpeed))
+                return std::nullopt;
+            const auto secant = (high - low) / bracket;
+            auto lowSlope = 1.0 / lowSpeed;
+            auto highSlope = 1.0 / highSpeed;
+            const auto alpha = lowSlope / secant;
+            const auto beta = highSlope / secant;
+            if(const auto radius = alpha * alpha + beta * beta; radius > 9.0) {
+                const auto limit = 3.0 / std::sqrt(radius);
+                lowSlope = limit * alpha * secant;
+                highSlope = limit * beta * secant;
+            }
+            const auto u = (distance - spline.distances[index]) / bracket;
+            const auto u2 = u * u;
+            const auto u3 = u2 * u;
+            const auto parameter = (2.0 * u3 - 3.0 * u2 + 1.0) * low
+                + (u3 - 2.0 * u2 + u) * bracket * lowSlope
+                + (-2.0 * u3 + 3.0 * u2) * high
+                + (u3 - u2) * bracket * highSlope;
+            return std::clamp(parameter, low, high);
         }
 
         struct OrderedSplineInverseState {
@@ -201,7 +233,8 @@ namespace ngc {
                 return cache.parameter;
             }
             std::size_t index = 0;
-            if(ordered && distance >= ordered->previousDistance) {
+            if(ordered && std::isfinite(ordered->previousDistance)
+               && distance >= ordered->previousDistance) {
                 index = std::min(ordered->tableIndex, spline.distances.size() - 2);
                 while(index + 1 < spline.distances.size() - 1
                       && spline.distances[index + 1] <= distance) ++index;
@@ -220,9 +253,15 @@ namespace ngc {
             auto parameter = bracket > 0.0
                 ? std::lerp(low, high, (distance - spline.distances[index]) / bracket)
                 : low;
-            // The table is a deterministic bracket only. Reintegrate against
-            // the actual curve before accepting the inverse.
+            ++workspace.splineInverse.queries;
+            if(const auto seed = splineInverseSeed(spline, index, distance)) {
+                parameter = *seed;
+                ++workspace.splineInverse.surrogateSeeds;
+            }
+            // The table and its surrogate are a deterministic seed only.
+            // Reintegrate against the actual curve before accepting the inverse.
             for(unsigned iteration = 0; iteration < 12; ++iteration) {
+                ++workspace.splineInverse.integralEvaluations;
                 double speed = 0.0;
                 const auto traveled = spline.distances[index]
                     + integrateSpeed(spline, integrationStart, parameter, &speed,
@@ -300,11 +339,14 @@ namespace ngc {
                 // wrong basis span for all but the middle interval.
                 spline.parameters.reserve(spans + 1);
                 spline.distances.reserve(spans + 1);
+                spline.speeds.reserve(spans + 1);
                 for (std::size_t span = 0; span <= spans; ++span) {
                     const auto parameter = static_cast<double>(span);
                     spline.parameters.push_back(parameter);
                     spline.distances.push_back(
                         (splineAt(spline, parameter) - spline.controls.front()).length());
+                    spline.speeds.push_back(derivativeSpeed(spline, parameter,
+                        std::min(span, spans - 1)));
                 }
                 return std::make_shared<const PreparedCurve>(PreparedCurve{
                     std::move(spline), displacement.length(), true});
@@ -312,17 +354,21 @@ namespace ngc {
             const auto intervals = spans * std::max<std::size_t>(1, intervalsPerSpan);
             spline.parameters.reserve(intervals + 1);
             spline.distances.reserve(intervals + 1);
+            spline.speeds.reserve(intervals + 1);
             spline.parameters.push_back(0.0);
             spline.distances.push_back(0.0);
+            spline.speeds.push_back(derivativeSpeed(spline, 0.0, 0));
             auto distance = 0.0;
             for(std::size_t index = 1; index <= intervals; ++index) {
                 const auto parameter = static_cast<double>(spans) * index / intervals;
                 const auto parameterSpan = std::min(
                     spans - 1, (index - 1) / std::max<std::size_t>(1, intervalsPerSpan));
+                double speed = 0.0;
                 distance += integrateSpeed(spline, spline.parameters.back(), parameter,
-                                           nullptr, parameterSpan);
+                                           &speed, parameterSpan);
                 spline.parameters.push_back(parameter);
                 spline.distances.push_back(distance);
+                spline.speeds.push_back(speed);
             }
             if(!std::isfinite(distance) || distance <= 1e-12) return {};
             for(const auto &control : spline.derivatives[1].controls)
@@ -334,13 +380,11 @@ namespace ngc {
 
         const simulation_detail::ArcReference *arcReference(const PreparedCurve &curve,
                                                               CurveEvaluationWorkspace &workspace) {
-            for(auto &entry : workspace.arcs)
-                if(entry.curve == &curve) return entry.reference.get();
+            if(const auto *found = workspace.arcs.find(curve)) return found->reference.get();
             const auto *arc = std::get_if<PreparedArcCurve>(&curve.value);
             if(!arc) return nullptr;
-            workspace.arcs.push_back({ &curve,
-                std::make_unique<simulation_detail::ArcReference>(arc->arc) });
-            return workspace.arcs.back().reference.get();
+            return workspace.arcs.insert({ &curve,
+                std::make_unique<simulation_detail::ArcReference>(arc->arc) }).reference.get();
         }
 
         position_t derivativeAt(const PreparedSplineCurve &spline, double parameter,
@@ -372,6 +416,97 @@ namespace ngc {
             return scaled(parameterDerivative, 1.0 / speed);
         }
 
+        void evaluateAtDistancesImpl(const PreparedCurve &curve,
+                                     const std::span<const double> distances,
+                                     const CurveEvaluationOutputs &outputs,
+                                     CurveEvaluationWorkspace &workspace,
+                                     const std::optional<std::size_t> splineParameterSpan,
+                                     OrderedSplineInverseState &ordered) {
+            for(const auto output : { outputs.positions, outputs.tangents,
+                                      outputs.curvatures, outputs.curvatureDerivatives })
+                if(!output.empty() && output.size() < distances.size())
+                    throw std::invalid_argument("curve evaluation output is shorter than its distances");
+            const auto wantPosition = !outputs.positions.empty();
+            const auto wantTangent = !outputs.tangents.empty();
+            const auto wantCurvature = !outputs.curvatures.empty();
+            const auto wantDerivative = !outputs.curvatureDerivatives.empty();
+            std::visit([&](const auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                for(std::size_t index = 0; index < distances.size(); ++index) {
+                    const auto distance = std::clamp(distances[index], 0.0, curve.length);
+                    if constexpr(std::same_as<T, PreparedLineCurve>) {
+                        const auto fraction = curve.length > 1e-15 ? distance / curve.length : 0.0;
+                        if(wantPosition)
+                            outputs.positions[index] = value.from + scaled(value.to - value.from, fraction);
+                        if(wantTangent)
+                            outputs.tangents[index] = curve.length > 1e-15
+                                ? scaled(value.to - value.from, 1.0 / curve.length) : position_t{};
+                        if(wantCurvature) outputs.curvatures[index] = {};
+                        if(wantDerivative) outputs.curvatureDerivatives[index] = {};
+                    } else if constexpr(std::same_as<T, PreparedArcCurve>) {
+                        const auto *reference = arcReference(curve, workspace);
+                        if(!reference) {
+                            if(wantPosition) outputs.positions[index] = value.arc.from();
+                            if(wantTangent) outputs.tangents[index] = {};
+                            if(wantCurvature) outputs.curvatures[index] = {};
+                            if(wantDerivative) outputs.curvatureDerivatives[index] = {};
+                            continue;
+                        }
+                        reference->derivativesAtDistance(distance,
+                            wantPosition ? &outputs.positions[index] : nullptr,
+                            wantTangent ? &outputs.tangents[index] : nullptr,
+                            wantCurvature ? &outputs.curvatures[index] : nullptr,
+                            wantDerivative ? &outputs.curvatureDerivatives[index] : nullptr);
+                    } else {
+                        const auto parameter = splineParameterAtDistance(
+                            curve, value, distance, workspace, &ordered);
+                        if(wantPosition) outputs.positions[index] = splineAt(value, parameter);
+                        const auto endpointCurvature = distance == 0.0 && value.startCurvature
+                            ? value.startCurvature
+                            : distance == curve.length && value.endCurvature
+                                ? value.endCurvature : std::nullopt;
+                        const auto curvatureFromDerivatives = wantCurvature && !endpointCurvature;
+                        const auto sharedDerivative = wantDerivative && !splineParameterSpan;
+                        position_t first{};
+                        position_t second{};
+                        if(wantTangent || curvatureFromDerivatives || sharedDerivative)
+                            first = derivativeAt(value, parameter, 1);
+                        if(curvatureFromDerivatives || sharedDerivative)
+                            second = derivativeAt(value, parameter, 2);
+                        const auto speed = first.length();
+                        if(wantTangent)
+                            outputs.tangents[index] = speed > 1e-15
+                                ? scaled(first, 1.0 / speed) : position_t{};
+                        if(wantCurvature) {
+                            if(endpointCurvature) {
+                                outputs.curvatures[index] = *endpointCurvature;
+                            } else if(speed <= 1e-15) {
+                                outputs.curvatures[index] = {};
+                            } else {
+                                const auto tangent = scaled(first, 1.0 / speed);
+                                outputs.curvatures[index] = scaled(
+                                    second - scaled(tangent, dot(second, tangent)),
+                                    1.0 / (speed * speed));
+                            }
+                        }
+                        if(wantDerivative) {
+                            auto spanFirst = first;
+                            auto spanSecond = second;
+                            if(splineParameterSpan) {
+                                spanFirst = derivativeAt(value, parameter, 1, splineParameterSpan);
+                                spanSecond = derivativeAt(value, parameter, 2, splineParameterSpan);
+                            }
+                            const auto third = derivativeAt(value, parameter, 3, splineParameterSpan);
+                            const auto spanSpeed = spanFirst.length();
+                            outputs.curvatureDerivatives[index] = spanSpeed <= 1e-15 ? position_t{}
+                                : curvatureDerivativeFromParameterDerivatives(
+                                    spanFirst, spanSecond, third, spanSpeed);
+                        }
+                    }
+                }
+            }, curve.value);
+        }
+
         path_tempo::Vector<6> pathTempoVector(const position_t &value) {
             return {value.x,value.y,value.z,value.a,value.b,value.c};
         }
@@ -390,33 +525,34 @@ namespace ngc {
             return "unknown sampling error";
         }
 
-        std::expected<std::vector<PreparedGeometricSample>,std::string>
+        std::expected<PreparedGeometricSamples,std::string>
         samplePreparedInterval(const PreparedPathPiece &piece,
                                CurveEvaluationWorkspace &workspace,
                                const double curveFrom,const double curveTo,
                                const std::size_t sampleIntervals,
                                const std::optional<std::size_t> splineParameterSpan = {}) {
             const auto length=curveTo-curveFrom;
+            // PathTempo requests stations front to back, so one ordered state
+            // lets spline inverses continue from the previous station.
+            OrderedSplineInverseState ordered;
             const auto sampled=path_tempo::sampleArcLengthCurve<6>(length,1,1.0,
                 sampleIntervals,[&](const double distance) {
-                    const auto source=curveFrom+distance;
+                    const double source=curveFrom+distance;
+                    position_t tangent,curvature,curvatureDerivative;
+                    evaluateAtDistancesImpl(*piece.curve,{&source,1},
+                        {.tangents={&tangent,1},.curvatures={&curvature,1},
+                         .curvatureDerivatives={&curvatureDerivative,1}},
+                        workspace,splineParameterSpan,ordered);
                     return path_tempo::DifferentialState<6>{
-                        .tangent=pathTempoVector(tangentAtDistance(
-                            *piece.curve,source,workspace)),
-                        .curvature=pathTempoVector(curvatureAtDistance(
-                            *piece.curve,source,workspace)),
-                        .thirdDerivative=pathTempoVector(
-                            splineParameterSpan
-                                ?curvatureDerivativeAtDistance(
-                                    *piece.curve,source,workspace,*splineParameterSpan)
-                                :curvatureDerivativeAtDistance(
-                                    *piece.curve,source,workspace)),
+                        .tangent=pathTempoVector(tangent),
+                        .curvature=pathTempoVector(curvature),
+                        .thirdDerivative=pathTempoVector(curvatureDerivative),
                     };
                 });
             if(!sampled)
                 return std::unexpected(std::format("PathTempo geometry sampling failed: {}",
                     samplingErrorText(sampled.error())));
-            std::vector<PreparedGeometricSample> result;
+            PreparedGeometricSamples result;
             result.reserve(sampled->stations.size());
             for(const auto &station:sampled->stations)
                 result.push_back({station.distance,
@@ -552,25 +688,32 @@ namespace ngc {
                         &position_t::x,&position_t::y,&position_t::z,
                         &position_t::a,&position_t::b,&position_t::c,
                     };
-                    const auto samples=std::span{piece.geometricSamples}.subspan(
+                    const auto samples=piece.geometricSamples.subview(
                         prepared.firstGeometricSample,prepared.geometricSampleCount);
+                    // Each limit is monotonic in its magnitude, so the per-axis
+                    // limits follow from one column maximum each.
+                    const auto columnMaximum=[](const std::span<const double> column) {
+                        auto maximum=0.0;
+                        for(const auto value:column) maximum=std::max(maximum,std::abs(value));
+                        return maximum;
+                    };
+                    for(std::size_t axis=0;axis<components.size();++axis) {
+                        const auto component=components[axis];
+                        const auto tangent=columnMaximum(samples.tangents(axis));
+                        if(tangent>1e-15)
+                            velocityLimit=std::min(velocityLimit,
+                                effort.splineVelocityLimits.axisVelocity.*component/tangent);
+                        const auto curvature=columnMaximum(samples.curvatures(axis));
+                        if(curvature>1e-15)
+                            velocityLimit=std::min(velocityLimit,std::sqrt(
+                                effort.splineVelocityLimits.axisAcceleration.*component
+                                    /curvature));
+                        const auto derivative=columnMaximum(samples.curvatureDerivatives(axis));
+                        if(derivative>1e-15)
+                            velocityLimit=std::min(velocityLimit,std::cbrt(
+                                effort.splineVelocityLimits.axisJerk.*component/derivative));
+                    }
                     for(const auto &sample:samples) {
-                        for(const auto component:components) {
-                            const auto tangent=std::abs(sample.tangent.*component);
-                            if(tangent>1e-15)
-                                velocityLimit=std::min(velocityLimit,
-                                    effort.splineVelocityLimits.axisVelocity.*component/tangent);
-                            const auto curvature=std::abs(sample.curvature.*component);
-                            if(curvature>1e-15)
-                                velocityLimit=std::min(velocityLimit,std::sqrt(
-                                    effort.splineVelocityLimits.axisAcceleration.*component
-                                        /curvature));
-                            const auto derivative=
-                                std::abs(sample.curvatureDerivative.*component);
-                            if(derivative>1e-15)
-                                velocityLimit=std::min(velocityLimit,std::cbrt(
-                                    effort.splineVelocityLimits.axisJerk.*component/derivative));
-                        }
                         const auto curvature=sample.curvature.length();
                         if(curvature>1e-15)
                             velocityLimit=std::min(velocityLimit,std::sqrt(
@@ -607,11 +750,6 @@ namespace ngc {
             return positionAtDistance(*entity.curve, distance, workspace);
         }
 
-        position_t sourceTangent(const SourceEntity &entity, double distance,
-                                 CurveEvaluationWorkspace &workspace) {
-            return tangentAtDistance(*entity.curve, distance, workspace);
-        }
-
         struct CurvatureMatchedBlend {
             std::vector<position_t> controls;
             position_t startCurvature{};
@@ -626,14 +764,14 @@ namespace ngc {
                                                 CurveEvaluationWorkspace &workspace) {
             const auto startDistance = incoming.length - 3.0 * incomingScale;
             const auto endDistance = 3.0 * outgoingScale;
-            const auto start = sourcePosition(incoming, startDistance, workspace);
-            const auto end = sourcePosition(outgoing, endDistance, workspace);
-            const auto startTangent = sourceTangent(incoming, startDistance, workspace);
-            const auto endTangent = sourceTangent(outgoing, endDistance, workspace);
-            const auto startCurvature = curvatureAtDistance(
-                *incoming.curve, startDistance, workspace);
-            const auto endCurvature = curvatureAtDistance(
-                *outgoing.curve, endDistance, workspace);
+            position_t start, startTangent, startCurvature;
+            position_t end, endTangent, endCurvature;
+            evaluateAtDistances(*incoming.curve, { &startDistance, 1 },
+                { .positions = { &start, 1 }, .tangents = { &startTangent, 1 },
+                  .curvatures = { &startCurvature, 1 } }, workspace);
+            evaluateAtDistances(*outgoing.curve, { &endDistance, 1 },
+                { .positions = { &end, 1 }, .tangents = { &endTangent, 1 },
+                  .curvatures = { &endCurvature, 1 } }, workspace);
             const auto fittedHandle = [](const position_t &endpoint,
                                          const position_t &tangent,
                                          const position_t &curvature,
@@ -839,6 +977,14 @@ namespace ngc {
         }, curve.value);
     }
 
+    void evaluateAtDistances(const PreparedCurve &curve, const std::span<const double> distances,
+                             const CurveEvaluationOutputs &outputs,
+                             CurveEvaluationWorkspace &workspace,
+                             const std::optional<std::size_t> splineParameterSpan) {
+        OrderedSplineInverseState ordered;
+        evaluateAtDistancesImpl(curve, distances, outputs, workspace, splineParameterSpan, ordered);
+    }
+
     std::expected<PreparedContinuousGeometry, std::string> prepareExactStopGeometry(
             const std::span<const PreparedCommandRecord> records,
             const position_t expectedStart, const GeometryPreparationEffort &effort) {
@@ -1081,18 +1227,16 @@ namespace ngc {
                     source.velocityLimits=effort.splineVelocityLimits;
                     const auto startDistance = entities[index].length - 3.0 * leftScale;
                     const auto endDistance = 3.0 * rightScale;
-                    source.startTangent = tangentAtDistance(
-                        *entities[index].curve, startDistance, workspace);
-                    source.startCurvature = curvatureAtDistance(
-                        *entities[index].curve, startDistance, workspace);
-                    source.startCurvatureDerivative = curvatureDerivativeAtDistance(
-                        *entities[index].curve, startDistance, workspace);
-                    source.endTangent = tangentAtDistance(
-                        *entities[right].curve, endDistance, workspace);
-                    source.endCurvature = curvatureAtDistance(
-                        *entities[right].curve, endDistance, workspace);
-                    source.endCurvatureDerivative = curvatureDerivativeAtDistance(
-                        *entities[right].curve, endDistance, workspace);
+                    evaluateAtDistances(*entities[index].curve, { &startDistance, 1 },
+                        { .tangents = { &source.startTangent, 1 },
+                          .curvatures = { &source.startCurvature, 1 },
+                          .curvatureDerivatives = { &source.startCurvatureDerivative, 1 } },
+                        workspace);
+                    evaluateAtDistances(*entities[right].curve, { &endDistance, 1 },
+                        { .tangents = { &source.endTangent, 1 },
+                          .curvatures = { &source.endCurvature, 1 },
+                          .curvatureDerivatives = { &source.endCurvatureDerivative, 1 } },
+                        workspace);
                     auto fitted = spline_detail::reconstructSpline(
                         controls, source, blendScale, effort.certifySourceTube,
                         effort.splineFitSolver);
@@ -1166,4 +1310,249 @@ namespace ngc {
         if(result.pieces.empty()) return std::unexpected("continuous path produced no geometry");
         return result;
     }
+
+    namespace {
+        class PreparedGeometryKey {
+            std::string m_bytes;
+
+        public:
+            template<typename T> requires std::is_trivially_copyable_v<T>
+            void append(const T &value) {
+                m_bytes.append(reinterpret_cast<const char *>(&value), sizeof value);
+            }
+
+            void append(const position_t &value) {
+                for(const auto component : {value.x, value.y, value.z, value.a, value.b, value.c})
+                    append(component);
+            }
+
+            // Appends value as a whole number of quanta. Fails for values the
+            // grid cannot represent, which are then left unkeyed.
+            bool appendQuantized(const position_t &value, const double quantum) {
+                for(const auto component : {value.x, value.y, value.z, value.a, value.b, value.c}) {
+                    const auto steps = std::round(component / quantum);
+                    if(!(std::abs(steps) < 0x1p62)) return false;
+                    append(static_cast<std::int64_t>(steps));
+                }
+                return true;
+            }
+
+            std::string take() { return std::move(m_bytes); }
+        };
+
+        // Source coordinates relative to the start are rounded to this
+        // fraction of the blend scale in the key, as the same program at
+        // another work offset is only equal to within the rounding of the
+        // offset addition. The key only finds a candidate; see translatesOnto().
+        constexpr double KEY_QUANTUM_PER_BLEND_SCALE = 1e-6;
+
+        // The planner joins slices whose boundaries agree to 1e-12; half of it
+        // leaves the neighbouring slice room for its own rounding.
+        constexpr double REUSE_POSITION_TOLERANCE = 0.5e-12;
+
+        // Only windows of lines and arcs are keyed; anything else is left to
+        // prepareContinuousGeometry() to reject.
+        std::optional<std::string> preparedGeometryKey(
+                const std::span<const PreparedCommandRecord> records, const double blendScale,
+                const position_t &origin, const GeometryPreparationEffort &effort,
+                const ContinuousGeometryBoundaries &boundaries) {
+            const auto quantum = blendScale * KEY_QUANTUM_PER_BLEND_SCALE;
+            if(!std::isfinite(quantum) || quantum <= 0.0) return std::nullopt;
+            const vec3_t origin3(origin.x, origin.y, origin.z);
+            PreparedGeometryKey key;
+            key.append(blendScale);
+            key.append(effort.certifySourceTube);
+            key.append(effort.generateSamples);
+            key.append(effort.lengthTableIntervalsPerKnotSpan);
+            key.append(effort.splineFitSolver);
+            key.append(effort.splineVelocityLimits.pathAcceleration);
+            key.append(effort.splineVelocityLimits.pathJerk);
+            key.append(effort.splineVelocityLimits.axisVelocity);
+            key.append(effort.splineVelocityLimits.axisAcceleration);
+            key.append(effort.splineVelocityLimits.axisJerk);
+            key.append(boundaries.incomingReplacement);
+            key.append(boundaries.deferFinalRetainedSection);
+            key.append(records.size());
+            for(const auto &record : records) {
+                const auto keyed = std::visit([&](const auto &command) {
+                    using T = std::decay_t<decltype(command)>;
+                    if constexpr(std::same_as<T, MoveLine>) {
+                        key.append(record.command.index());
+                        key.append(command.speed());
+                        key.append(command.machineCoordinates());
+                        return key.appendQuantized(command.from() - origin, quantum)
+                            && key.appendQuantized(command.to() - origin, quantum);
+                    } else if constexpr(std::same_as<T, MoveArc>) {
+                        const auto center = command.center() - origin3;
+                        key.append(record.command.index());
+                        key.append(command.axis());
+                        key.append(command.speed());
+                        return key.appendQuantized(command.from() - origin, quantum)
+                            && key.appendQuantized(command.to() - origin, quantum)
+                            && key.appendQuantized({center.x, center.y, center.z, 0, 0, 0}, quantum);
+                    } else {
+                        return false;
+                    }
+                }, record.command);
+                if(!keyed) return std::nullopt;
+            }
+            return key.take();
+        }
+
+        bool zeroOffset(const position_t &offset) {
+            return offset.x == 0.0 && offset.y == 0.0 && offset.z == 0.0
+                && offset.a == 0.0 && offset.b == 0.0 && offset.c == 0.0;
+        }
+
+        std::shared_ptr<const PreparedCurve> translatedCurve(const PreparedCurve &curve,
+                                                             const position_t &offset) {
+            auto result = std::make_shared<PreparedCurve>(curve);
+            std::visit([&](auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr(std::same_as<T, PreparedLineCurve>) {
+                    value.from = value.from + offset;
+                    value.to = value.to + offset;
+                } else if constexpr(std::same_as<T, PreparedArcCurve>) {
+                    value.arc = MoveArc(value.arc.from() + offset, value.arc.to() + offset,
+                                        value.arc.center() + vec3_t(offset.x, offset.y, offset.z),
+                                        value.arc.axis(), value.arc.speed());
+                } else {
+                    // derivative hodographs, curvatures and length tables are translation invariant
+                    for(auto &control : value.controls) control = control + offset;
+                }
+            }, result->value);
+            return result;
+        }
+
+        // Whether the cached window's exact source commands, moved by offset,
+        // are the requested ones. Windows within half a key quantum share a
+        // key, but serving one for the other would leave its pieces off the
+        // programmed endpoints.
+        bool translatesOnto(const PreparedContinuousGeometry &cached,
+                            const std::span<const PreparedCommandRecord> records,
+                            const position_t &offset) {
+            if(cached.commands.size() != records.size()) return false;
+            const vec3_t offset3(offset.x, offset.y, offset.z);
+            const auto near = [&](const position_t &source, const position_t &target) {
+                return (source + offset - target).length() <= REUSE_POSITION_TOLERANCE;
+            };
+            for(std::size_t index = 0; index < records.size(); ++index) {
+                const auto &source = cached.commands[index].command;
+                const auto &target = records[index].command;
+                if(source.index() != target.index()) return false;
+                if(const auto *line = std::get_if<MoveLine>(&source)) {
+                    const auto &requested = std::get<MoveLine>(target);
+                    if(!near(line->from(), requested.from()) || !near(line->to(), requested.to()))
+                        return false;
+                } else if(const auto *arc = std::get_if<MoveArc>(&source)) {
+                    const auto &requested = std::get<MoveArc>(target);
+                    if(!near(arc->from(), requested.from()) || !near(arc->to(), requested.to())
+                       || (arc->center() + offset3 - requested.center()).length()
+                              > REUSE_POSITION_TOLERANCE)
+                        return false;
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        PreparedContinuousGeometry reusePreparedGeometry(
+                const PreparedContinuousGeometry &cached,
+                const std::span<const PreparedCommandRecord> records, const position_t &offset) {
+            std::unordered_map<PreparedCommandId, PreparedCommandId> commandIds;
+            for(std::size_t index = 0; index < records.size(); ++index)
+                commandIds.emplace(cached.commands[index].id, records[index].id);
+            const auto renamed = [&](const PreparedCommandId id) { return commandIds.at(id); };
+
+            const auto translate = !zeroOffset(offset);
+            // pieces and replaced source intervals share curves; keep them shared
+            std::unordered_map<const PreparedCurve *, std::shared_ptr<const PreparedCurve>> curves;
+            const auto moved = [&](const std::shared_ptr<const PreparedCurve> &curve) {
+                if(!translate || !curve) return curve;
+                auto &result = curves[curve.get()];
+                if(!result) result = translatedCurve(*curve, offset);
+                return result;
+            };
+
+            PreparedContinuousGeometry result;
+            result.commands.assign(records.begin(), records.end());
+            result.diagnostics = cached.diagnostics;
+            result.pieces = cached.pieces;
+            for(auto &piece : result.pieces) {
+                piece.curve = moved(piece.curve);
+                piece.primaryCommand = renamed(piece.primaryCommand);
+                for(auto &station : piece.activationStations)
+                    station.command = renamed(station.command);
+                for(auto &command : piece.sourceCommands) command = renamed(command);
+                for(auto &interval : piece.replacedSourceIntervals) {
+                    interval.command = renamed(interval.command);
+                    interval.curve = moved(interval.curve);
+                }
+            }
+            return result;
+        }
+    }
+
+    PreparedGeometryCache::PreparedGeometryCache(const std::size_t capacity)
+        : m_capacity(std::max<std::size_t>(1, capacity)) { }
+
+    std::expected<PreparedContinuousGeometry, std::string> PreparedGeometryCache::prepareContinuous(
+            const std::span<const PreparedCommandRecord> records, const double blendScale,
+            const position_t expectedStart, const GeometryPreparationEffort &effort,
+            const ContinuousGeometryBoundaries &boundaries) {
+        auto key = preparedGeometryKey(records, blendScale, expectedStart, effort, boundaries);
+        if(!key || records.empty())
+            return prepareContinuousGeometry(records, blendScale, expectedStart, effort, boundaries);
+
+        std::shared_ptr<const PreparedContinuousGeometry> cached;
+        position_t origin{};
+        {
+            std::scoped_lock lock(m_mutex);
+            if(const auto found = m_index.find(*key); found != m_index.end()
+               && translatesOnto(*found->second->prepared, records,
+                                 expectedStart - found->second->origin)) {
+                m_entries.splice(m_entries.begin(), m_entries, found->second);
+                cached = m_entries.front().prepared;
+                origin = m_entries.front().origin;
+                ++m_diagnostics.hits;
+                if(!zeroOffset(expectedStart - origin)) ++m_diagnostics.translatedHits;
+            } else {
+                if(found != m_index.end()) ++m_diagnostics.mismatchedKeys;
+                ++m_diagnostics.misses;
+            }
+        }
+        if(cached) return reusePreparedGeometry(*cached, records, expectedStart - origin);
+
+        // prepared outside the lock; a concurrent miss on the same window only repeats work
+        auto prepared = prepareContinuousGeometry(records, blendScale, expectedStart, effort, boundaries);
+        if(!prepared) return prepared;
+        auto entry = std::make_shared<const PreparedContinuousGeometry>(*prepared);
+        std::scoped_lock lock(m_mutex);
+        if(m_index.contains(*key)) return prepared;
+        if(m_entries.size() >= m_capacity) {
+            m_index.erase(m_entries.back().key);
+            m_entries.pop_back();
+            ++m_diagnostics.evictions;
+        }
+        m_entries.push_front({ std::move(*key), expectedStart, std::move(entry) });
+        m_index.emplace(m_entries.front().key, m_entries.begin());
+        return prepared;
+    }
+
+    PreparedGeometryCacheDiagnostics PreparedGeometryCache::diagnostics() const {
+        std::scoped_lock lock(m_mutex);
+        return m_diagnostics;
+    }
+
+    std::size_t PreparedGeometryCache::size() const {
+        std::scoped_lock lock(m_mutex);
+        return m_entries.size();
+    }
+
+    void PreparedGeometryCache::clear() {
+        std::scoped_lock lock(m_mutex);
+        m_index.clear();
+        m_entries.clear();
+    }
 }
@@ -53,6 +53,69 @@ namespace ngc {
         }
 
         using spline_detail::SplineFitSolver;
+    }
+
+    std::vector<double> spline_detail::endpointDerivativeCoefficients(
+            const std::span<const double> knots,const std::size_t splineDegree,
+            const std::size_t count,const std::size_t order,const bool end) {
+        // Only the first or last order+1 basis rows reach the requested endpoint
+        // derivative, so the difference table is reduced in place over that window.
+        const auto rows=order+1;
+        const auto firstRow=end?count-rows:0;
+        std::vector<double> values(rows*count);
+        for(std::size_t row=0;row<rows;++row) values[row*count+firstRow+row]=1.0;
+        auto degree=splineDegree;
+        for(std::size_t derivative=0;derivative<order;++derivative) {
+            for(std::size_t row=0;row+1<rows-derivative;++row) {
+                const auto index=firstRow+row;
+                const auto factor=static_cast<double>(degree)
+                    /(knots[index+degree+1+derivative]-knots[index+1+derivative]);
+                for(std::size_t source=0;source<count;++source)
+                    values[row*count+source]=factor
+                        *(values[(row+1)*count+source]-values[row*count+source]);
+            }
+            --degree;
+        }
+        values.resize(count);
+        return values;
+    }
+
+    bool spline_detail::factorBandLdlt(const std::span<SymmetricBandRow> band) {
+        constexpr auto halfBandwidth=std::tuple_size_v<SymmetricBandRow>-1;
+        for(std::size_t i=0;i<band.size();++i) {
+            const auto firstJ=i>halfBandwidth?i-halfBandwidth:0;
+            for(auto j=firstJ;j<=i;++j) {
+                auto value=band[i][i-j];
+                for(auto k=firstJ;k<j;++k)
+                    value-=band[i][i-k]*band[k][0]*band[j][j-k];
+                if(i==j) {
+                    if(!std::isfinite(value)||value<=1e-18) return false;
+                    band[i][0]=value;
+                } else band[i][i-j]=value/band[j][0];
+            }
+        }
+        return true;
+    }
+
+    void spline_detail::solveBandLdlt(const std::span<const SymmetricBandRow> factors,
+                                      const std::span<position_t> values) {
+        constexpr auto halfBandwidth=std::tuple_size_v<SymmetricBandRow>-1;
+        const auto count=values.size();
+        for(std::size_t i=0;i<count;++i) {
+            const auto maximum=std::min(halfBandwidth,i);
+            for(std::size_t distance=1;distance<=maximum;++distance)
+                values[i]=subtract(values[i],scaled(values[i-distance],factors[i][distance]));
+        }
+        for(std::size_t i=0;i<count;++i) values[i]=scaled(values[i],1.0/factors[i][0]);
+        for(auto reverse=count;reverse-->0;) {
+            const auto maximum=std::min(halfBandwidth,count-1-reverse);
+            for(std::size_t distance=1;distance<=maximum;++distance)
+                values[reverse]=subtract(values[reverse],
+                    scaled(values[reverse+distance],factors[reverse+distance][distance]));
+        }
+    }
+
+    namespace {
 
         struct FittingSpline {
             std::size_t degree=0;
@@ -89,26 +152,8 @@ namespace ngc {
 
         std::vector<double> endpointDerivativeCoefficients(
                 const FittingSpline &spline,const std::size_t order,const bool end) {
-            const auto count=spline.controls.size();
-            std::vector<std::vector<double>> values(count,std::vector<double>(count));
-            for(std::size_t index=0;index<count;++index) values[index][index]=1.0;
-            auto knots=spline.knots;
-            auto degree=spline.degree;
-            for(std::size_t derivative=0;derivative<order;++derivative) {
-                std::vector<std::vector<double>> next(
-                    values.size()-1,std::vector<double>(count));
-                for(std::size_t index=0;index<next.size();++index) {
-                    const auto factor=static_cast<double>(degree)
-                        /(knots[index+degree+1]-knots[index+1]);
-                    for(std::size_t source=0;source<count;++source)
-                        next[index][source]=factor
-                            *(values[index+1][source]-values[index][source]);
-                }
-                values=std::move(next);
-                knots={knots.begin()+1,knots.end()-1};
-                --degree;
-            }
-            return end?values.back():values.front();
+            return spline_detail::endpointDerivativeCoefficients(
+                spline.knots,spline.degree,spline.controls.size(),order,end);
         }
 
         void imposeEndpointDerivative(FittingSpline &spline,const std::size_t order,
@@ -368,12 +413,77 @@ namespace ngc {
             std::size_t candidateCount=0;
         };
 
+        // Normal equations I+w*DtWD of the third-difference fairness fit over the free
+        // quintic controls. The row-weighted stencil and its coupling to the fixed end
+        // controls are accumulated once per set of row weights; each fairness weight then
+        // rescales them into the LDLt band, refactors in place and solves all six axes in
+        // one forward and backward sweep without allocating.
+        class BandedFairnessSystem {
+        public:
+            static constexpr std::size_t HALF_BANDWIDTH=3;
+
+            BandedFairnessSystem(const std::span<const position_t> controls,
+                                 const std::size_t firstFree,const std::size_t lastFree)
+                : m_controls(controls),m_firstFree(firstFree),m_lastFree(lastFree),
+                  m_stencil(lastFree-firstFree),m_factors(lastFree-firstFree),
+                  m_fixedCoupling(lastFree-firstFree),m_solution(lastFree-firstFree) {}
+
+            void setRowWeights(const std::span<const double> rowWeights) {
+                std::ranges::fill(m_stencil,Band{});
+                std::ranges::fill(m_fixedCoupling,position_t{});
+                for(std::size_t row=0;row+3<m_controls.size();++row) {
+                    for(std::size_t a=0;a<THIRD_DIFFERENCE.size();++a) {
+                        const auto controlA=row+a;
+                        if(controlA<m_firstFree||controlA>=m_lastFree) continue;
+                        const auto freeA=controlA-m_firstFree;
+                        for(std::size_t b=0;b<THIRD_DIFFERENCE.size();++b) {
+                            const auto controlB=row+b;
+                            const auto value=rowWeights[row]
+                                *THIRD_DIFFERENCE[a]*THIRD_DIFFERENCE[b];
+                            if(controlB>=m_firstFree&&controlB<m_lastFree) {
+                                const auto freeB=controlB-m_firstFree;
+                                if(freeB<=freeA) m_stencil[freeA][freeA-freeB]+=value;
+                            } else m_fixedCoupling[freeA]=add(m_fixedCoupling[freeA],
+                                scaled(m_controls[controlB],value));
+                        }
+                    }
+                }
+            }
+
+            // The free controls for one fairness weight under the current row weights, or
+            // nullopt when the band is not numerically positive definite. The span stays
+            // valid until the next solve.
+            std::optional<std::span<const position_t>> solve(const double fairnessWeight) {
+                for(std::size_t i=0;i<m_factors.size();++i) {
+                    for(std::size_t distance=0;distance<=HALF_BANDWIDTH;++distance)
+                        m_factors[i][distance]=fairnessWeight*m_stencil[i][distance];
+                    m_factors[i][0]+=1.0;
+                }
+                if(!spline_detail::factorBandLdlt(m_factors)) return std::nullopt;
+                for(std::size_t i=0;i<m_solution.size();++i)
+                    m_solution[i]=subtract(m_controls[m_firstFree+i],
+                        scaled(m_fixedCoupling[i],fairnessWeight));
+                spline_detail::solveBandLdlt(m_factors,m_solution);
+                return m_solution;
+            }
+
+        private:
+            using Band=spline_detail::SymmetricBandRow;
+            static constexpr std::array<double,4> THIRD_DIFFERENCE{-1.0,3.0,-3.0,1.0};
+
+            std::span<const position_t> m_controls;
+            std::size_t m_firstFree=0;
+            std::size_t m_lastFree=0;
+            std::vector<Band> m_stencil;
+            std::vector<Band> m_factors;
+            std::vector<position_t> m_fixedCoupling;
+            std::vector<position_t> m_solution;
+        };
+
         std::expected<SplineFitResult,std::string> fitQuinticSpline(
                 FittingSpline initial,const SplineFitSource &source,
                 const double programmedScale,const SplineFitSolver solver) {
             constexpr std::size_t FIXED_CONTROLS_PER_END=4;
-            constexpr std::size_t HALF_BANDWIDTH=3;
-            constexpr std::array<double,4> THIRD_DIFFERENCE{-1.0,3.0,-3.0,1.0};
             const auto firstFree=FIXED_CONTROLS_PER_END;
             const auto lastFree=initial.controls.size()-FIXED_CONTROLS_PER_END;
             if(lastFree<=firstFree) return SplineFitResult{std::move(initial),0};
@@ -447,76 +557,14 @@ namespace ngc {
                 return result;
             }
 
-            const auto freeCount=lastFree-firstFree;
             const auto rowCount=initial.controls.size()-3;
             const std::vector<double> uniformRowWeights(rowCount,1.0);
-            const auto solve=[&](const double fairnessWeight,
-                                 const std::span<const double> rowWeights)
-                    ->std::optional<FittingSpline> {
-                std::vector<std::array<double,2*HALF_BANDWIDTH+1>> matrix(freeCount);
-                std::vector<position_t> rightHandSide(freeCount);
-                for(std::size_t free=0;free<freeCount;++free) {
-                    matrix[free][HALF_BANDWIDTH]=1.0;
-                    rightHandSide[free]=initial.controls[firstFree+free];
-                }
-                for(std::size_t row=0;row+3<initial.controls.size();++row) {
-                    for(std::size_t a=0;a<THIRD_DIFFERENCE.size();++a) {
-                        const auto controlA=row+a;
-                        if(controlA<firstFree||controlA>=lastFree) continue;
-                        const auto freeA=controlA-firstFree;
-                        for(std::size_t b=0;b<THIRD_DIFFERENCE.size();++b) {
-                            const auto controlB=row+b;
-                            const auto value=fairnessWeight*rowWeights[row]
-                                *THIRD_DIFFERENCE[a]*THIRD_DIFFERENCE[b];
-                            if(controlB>=firstFree&&controlB<lastFree) {
-                                const auto freeB=controlB-firstFree;
-                                if(freeB<=freeA)
-                                    matrix[freeA][HALF_BANDWIDTH+freeB-freeA]+=value;
-                            } else {
-                                for(const auto component:AXIS_COMPONENTS)
-                                    rightHandSide[freeA].*component-=
-                                        value*(initial.controls[controlB].*component);
-                            }
-                        }
-                    }
-                }
-                std::vector<std::array<double,HALF_BANDWIDTH+1>> lower(freeCount);
-                for(std::size_t i=0;i<freeCount;++i) {
-                    const auto firstJ=i>HALF_BANDWIDTH?i-HALF_BANDWIDTH:0;
-                    for(auto j=firstJ;j<=i;++j) {
-                        auto value=matrix[i][HALF_BANDWIDTH+j-i];
-                        const auto firstK=std::max(
-                            i>HALF_BANDWIDTH?i-HALF_BANDWIDTH:0,
-                            j>HALF_BANDWIDTH?j-HALF_BANDWIDTH:0);
-                        for(auto k=firstK;k<j;++k)
-                            value-=lower[i][i-k]*lower[j][j-k];
-                        if(i==j) {
-                            if(!std::isfinite(value)||value<=1e-18) return std::nullopt;
-                            lower[i][0]=std::sqrt(value);
-                        } else lower[i][i-j]=value/lower[j][0];
-                    }
-                }
+            BandedFairnessSystem fairness(initial.controls,firstFree,lastFree);
+            const auto solve=[&](const double fairnessWeight)->std::optional<FittingSpline> {
+                const auto freeControls=fairness.solve(fairnessWeight);
+                if(!freeControls) return std::nullopt;
                 auto candidate=initial;
-                for(const auto component:AXIS_COMPONENTS) {
-                    std::vector<double> intermediate(freeCount),solution(freeCount);
-                    for(std::size_t i=0;i<freeCount;++i) {
-                        auto value=rightHandSide[i].*component;
-                        const auto maximum=std::min(HALF_BANDWIDTH,i);
-                        for(std::size_t distance=1;distance<=maximum;++distance)
-                            value-=lower[i][distance]*intermediate[i-distance];
-                        intermediate[i]=value/lower[i][0];
-                    }
-                    for(auto reverse=freeCount;reverse-->0;) {
-                        auto value=intermediate[reverse];
-                        const auto maximum=std::min(
-                            HALF_BANDWIDTH,freeCount-1-reverse);
-                        for(std::size_t distance=1;distance<=maximum;++distance)
-                            value-=lower[reverse+distance][distance]
-                                *solution[reverse+distance];
-                        solution[reverse]=value/lower[reverse][0];
-                        candidate.controls[firstFree+reverse].*component=solution[reverse];
-                    }
-                }
+                std::ranges::copy(*freeControls,candidate.controls.begin()+firstFree);
                 return candidate;
             };
 
@@ -529,8 +577,9 @@ namespace ngc {
                 double score=std::numeric_limits<double>::infinity();
             };
             std::array<std::optional<ActiveSeed>,3> activeSeeds;
+            fairness.setRowWeights(uniformRowWeights);
             for(const auto fairnessWeight:FAIRNESS_WEIGHTS) {
-                auto candidate=solve(fairnessWeight,uniformRowWeights);
+                auto candidate=solve(fairnessWeight);
                 ++result.candidateCount;
                 if(!candidate) continue;
                 const auto measurement=measureSplineFit(
@@ -606,7 +655,8 @@ namespace ngc {
                             }
                         }
                         if(!changed) break;
-                        auto candidate=solve(seed->fairnessWeight,rowWeights);
+                        fairness.setRowWeights(rowWeights);
+                        auto candidate=solve(seed->fairnessWeight);
                         ++result.candidateCount;
                         if(!candidate) break;
                         const auto measurement=measureSplineFit(*candidate,source,16);
@@ -13,8 +13,10 @@
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <numbers>
 #include <numeric>
+#include <optional>
 #include <span>
 #include <tuple>
 #include <type_traits>
@@ -87,6 +89,7 @@ namespace ngc {
         }
 
         struct PathSample { position_t position; position_t tangent; };
+        struct PathState { position_t position; position_t tangent; position_t curvature; };
         struct TimeBoundary {
             double time;
             double distance;
@@ -130,7 +133,15 @@ namespace ngc {
 
         struct TimeLawWorkspace {
             path_tempo::ScalarTransitionPlanner planner;
+            ScalarTransitionCache *cache=nullptr;
         };
+    }
+
+    struct ScalarTransitionCache::Result {
+        std::expected<TimeLaw, std::string> timeLaw;
+    };
+
+    namespace {
 
         enum class TimeLawPurpose {
             ExactStop,
@@ -931,6 +942,8 @@ namespace ngc {
                                       const std::string_view section)
                     -> std::optional<std::string> {
                 for (const auto &span : spans) {
+                    // exact ranges of all axes, once any control hull leaves its limits
+                    std::optional<trajectory_detail::AxisPositionRanges> ranges;
                     for (std::size_t axis = 0;
                             axis < AXIS_COMPONENTS.size(); ++axis) {
                         const auto component = AXIS_COMPONENTS[axis];
@@ -939,19 +952,22 @@ namespace ngc {
                                 limits.maximum.*component)) {
                             continue;
                         }
-                        const auto range = trajectory_detail::axisPositionRange(
-                            span, component);
-                        if (!std::isfinite(range.minimum)
-                           || !std::isfinite(range.maximum)
-                           || range.minimum < limits.minimum.*component
+                        if (!ranges) {
+                            ranges = trajectory_detail::axisPositionRanges(span);
+                        }
+                        const auto minimum = ranges->minimum.*component;
+                        const auto maximum = ranges->maximum.*component;
+                        if (!std::isfinite(minimum)
+                           || !std::isfinite(maximum)
+                           || minimum < limits.minimum.*component
                                 - POSITION_LIMIT_TOLERANCE
-                           || range.maximum > limits.maximum.*component
+                           || maximum > limits.maximum.*component
                                 + POSITION_LIMIT_TOLERANCE) {
                             return std::format(
                                 "trajectory chunk {} {} execution span {} axis {} "
                                 "range [{}, {}] is outside [{}, {}]",
                                 chunk.id, section, span.id, AXIS_NAMES[axis],
-                                range.minimum, range.maximum,
+                                minimum, maximum,
                                 limits.minimum.*component,
                                 limits.maximum.*component);
                         }
@@ -1247,10 +1263,31 @@ namespace ngc {
                 const double requestedVelocity,const double acceleration,const double jerk) {
             auto &diagnostics=instrumentation.begin(purpose,correctionPass);
             TimeLawCallTimer timer {diagnostics};
+            ScalarTransitionCache::Key key;
+            if(workspace.cache) {
+                const std::array values{length,fromVelocity,fromAcceleration,toVelocity,
+                    toAcceleration,requestedVelocity,acceleration,jerk};
+                std::ranges::transform(values,key.bits.begin(),[](const double value) {
+                    return std::bit_cast<std::uint64_t>(value);
+                });
+                if(const auto cached=workspace.cache->find(key)) {
+                    ++diagnostics.cacheHits;
+                    if(cached->timeLaw) ++diagnostics.cacheSuccessfulHits;
+                    else ++diagnostics.cacheFailureHits;
+                    timer.succeeded=cached->timeLaw.has_value();
+                    return cached->timeLaw;
+                }
+                ++diagnostics.cacheMisses;
+            }
             ++diagnostics.solverCalls;
             auto result=solveTimeLawBetween(workspace,length,fromVelocity,fromAcceleration,
                 toVelocity,toAcceleration,requestedVelocity,acceleration,jerk);
             timer.succeeded=result.has_value();
+            if(workspace.cache) {
+                workspace.cache->insert(key,std::make_shared<const ScalarTransitionCache::Result>(
+                    ScalarTransitionCache::Result{result}));
+                ++diagnostics.cacheMaterializations;
+            }
             return result;
         }
 
@@ -1291,13 +1328,16 @@ namespace ngc {
             double programmedVelocity=0.0;
             double staticVelocityLimit=std::numeric_limits<double>::infinity();
             bool linear=false;
-            std::span<const PreparedGeometricSample> geometricSamples{};
+            std::shared_ptr<const PreparedCurve> curve;
+            PreparedGeometricSampleView geometricSamples{};
             double geometricSampleDistanceOffset=0.0;
             std::function<PathSample(double)> sampleAt;
             std::function<position_t(double)> curvatureAt;
             std::function<position_t(double)> infiniteJerkCurvatureAt;
             std::function<position_t(double)> curvatureDerivativeAt;
             std::function<position_t(double)> positionAt;
+            // Position, tangent and curvature from one batched curve evaluation.
+            std::function<PathState(double)> pathStateAt;
             std::function<double(double,double)> chordErrorBound;
         };
 
@@ -1372,8 +1412,104 @@ namespace ngc {
 
             return result;
         }
+
+        struct QuinticCandidate {
+            bool accepted=false;
+            bool constraintsVerified=false;
+            bool geometryEvaluated=false;
+            bool geometryVerified=false;
+            bool progressVerified=false;
+            double maximumRatio=0.0;
+            double maximumCorrectionRatio=0.0;
+            double acceptanceRatio=0.0;
+            double accelerationExcursionRatio=0.0;
+            bool subServoJerkAccepted=false;
+            ContinuousPolynomialConstraintKind constraint=
+                ContinuousPolynomialConstraintKind::PathAcceleration;
+            std::size_t axis=std::numeric_limits<std::size_t>::max();
+        };
+
+        struct AdaptiveLeaf {
+            double from=0.0;
+            double to=0.0;
+            bool accepted=false;
+            QuinticCandidate candidate;
+            LocalQuinticBezier quintic;
+        };
+
+        // A timing piece's quintic materialization depends only on its curve
+        // interval, its velocity cap and its scalar time law, so equal bits
+        // reproduce the same accepted leaves.
+        struct MaterializedPieceKey {
+            const PreparedCurve *curve=nullptr;
+            std::size_t knotInterval=0;
+            std::vector<std::uint64_t> bits;
+
+            bool operator==(const MaterializedPieceKey &) const=default;
+        };
+
+        struct MaterializedPieceKeyHash {
+            std::size_t operator()(const MaterializedPieceKey &key) const {
+                auto hash=std::hash<const void *>{}(key.curve)^(key.knotInterval*0x9e3779b97f4a7c15ULL);
+                for(const auto bits:key.bits) hash^=bits+0x9e3779b97f4a7c15ULL+(hash<<6)+(hash>>2);
+                return hash;
+            }
+        };
+
+        struct MaterializedPiece {
+            // Keeps the curve in the key alive.
+            std::shared_ptr<const PreparedCurve> curve;
+            QuinticCandidate initial;
+            unsigned maximumDepth=0;
+            std::vector<AdaptiveLeaf> leaves;
+        };
+
+        MaterializedPieceKey materializedPieceKey(const GeometryPiece &piece,
+                                                  const double pathVelocityLimit,
+                                                  const TimeLaw &boundaries) {
+            MaterializedPieceKey key{piece.curve.get(),piece.knotInterval,{}};
+            key.bits.reserve(3+5*boundaries.size());
+            const auto append=[&](const double value) {
+                key.bits.push_back(std::bit_cast<std::uint64_t>(value));
+            };
+            append(piece.curveFrom);
+            append(piece.curveTo);
+            append(pathVelocityLimit);
+            for(const auto &boundary:boundaries) {
+                append(boundary.time);
+                append(boundary.distance);
+                append(boundary.velocity);
+                append(boundary.acceleration);
+                append(boundary.jerk);
+            }
+            return key;
+        }
+
+        using MaterializationLimitsKey=std::array<std::uint64_t,22>;
+
+        MaterializationLimitsKey materializationLimitsKey(const TrajectoryLimits &limits,
+                                                          const ContinuousPlanningEffort &effort) {
+            MaterializationLimitsKey key{};
+            auto next=key.begin();
+            const auto append=[&](const double value) {
+                *next++=std::bit_cast<std::uint64_t>(value);
+            };
+            append(limits.arcChordTolerance);
+            append(limits.pathAcceleration);
+            append(limits.pathJerk);
+            for(const auto &axes:{limits.axisVelocity,limits.axisAcceleration,limits.axisJerk})
+                for(const auto value:{axes.x,axes.y,axes.z,axes.a,axes.b,axes.c}) append(value);
+            append(effort.quinticServoPeriod);
+            return key;
+        }
     }
 
+    struct ContinuousMaterializationMemo {
+        MaterializationLimitsKey limits{};
+        std::unordered_map<MaterializedPieceKey,std::shared_ptr<const MaterializedPiece>,
+            MaterializedPieceKeyHash> pieces;
+    };
+
     namespace trajectory_detail {
         namespace {
             double maximumAbsolutePolynomial(
@@ -1401,6 +1537,158 @@ namespace ngc {
                     span.coefficients[4].*component,
                 };
             }
+
+            // One value per axis. Every loop over a lane array is branch-free
+            // so that it stays in vector registers.
+            using AxisLanes = std::array<double, AXIS_COMPONENTS.size()>;
+            template<std::size_t Count>
+            using LanePolynomial = std::array<AxisLanes, Count>;
+
+            constexpr unsigned LANE_ROOT_ITERATIONS = 64;
+            constexpr double LANE_ROOT_TOLERANCE = 1e-15;
+
+            template<std::size_t Count>
+            AxisLanes evaluateLanes(const LanePolynomial<Count> &coefficients,
+                    const AxisLanes &parameter) {
+                AxisLanes result{};
+                for (auto coefficient = Count; coefficient-- > 0;) {
+                    for (std::size_t lane = 0; lane < result.size(); ++lane) {
+                        result[lane] = result[lane] * parameter[lane]
+                            + coefficients[coefficient][lane];
+                    }
+                }
+                return result;
+            }
+
+            template<std::size_t Count>
+            LanePolynomial<Count - 1> laneDerivative(
+                    const LanePolynomial<Count> &coefficients) {
+                LanePolynomial<Count - 1> result{};
+                for (std::size_t index = 1; index < Count; ++index) {
+                    for (std::size_t lane = 0; lane < result[0].size(); ++lane) {
+                        result[index - 1][lane] =
+                            static_cast<double>(index) * coefficients[index][lane];
+                    }
+                }
+                return result;
+            }
+
+            // Parameters in [0, 1] that include every sign-changing root of
+            // the polynomial in each lane. A slot without such a root holds
+            // an interval end instead, which is a harmless extra candidate.
+            template<std::size_t Count>
+            LanePolynomial<Count - 1> laneRootCandidates(
+                    const LanePolynomial<Count> &coefficients) {
+                static_assert(Count >= 2);
+                LanePolynomial<Count - 1> result{};
+                if constexpr (Count == 2) {
+                    for (std::size_t lane = 0; lane < result[0].size(); ++lane) {
+                        const auto slope = coefficients[1][lane];
+                        const auto root = slope != 0.0
+                            ? -coefficients[0][lane] / slope : 1.0;
+                        result[0][lane] = std::clamp(root, 0.0, 1.0);
+                    }
+                } else {
+                    // Between consecutive turning points the polynomial is
+                    // monotone, so each interval holds at most one sign
+                    // change, which safeguarded Newton steps isolate.
+                    const auto slopes = laneDerivative(coefficients);
+                    const auto turning = laneRootCandidates(slopes);
+                    LanePolynomial<Count> bounds{};
+                    bounds.front().fill(0.0);
+                    std::ranges::copy(turning, bounds.begin() + 1);
+                    bounds.back().fill(1.0);
+                    for (std::size_t pass = 1; pass < Count; ++pass) {
+                        for (std::size_t index = 1; index + pass <= Count; ++index) {
+                            for (std::size_t lane = 0; lane < bounds[0].size(); ++lane) {
+                                const auto low = std::min(
+                                    bounds[index - 1][lane], bounds[index][lane]);
+                                const auto high = std::max(
+                                    bounds[index - 1][lane], bounds[index][lane]);
+                                bounds[index - 1][lane] = low;
+                                bounds[index][lane] = high;
+                            }
+                        }
+                    }
+                    for (std::size_t interval = 0; interval + 1 < Count; ++interval) {
+                        auto left = bounds[interval];
+                        auto right = bounds[interval + 1];
+                        const auto leftValue = evaluateLanes(coefficients, left);
+                        const auto rightValue = evaluateLanes(coefficients, right);
+                        std::array<bool, AXIS_COMPONENTS.size()> active{};
+                        auto &root = result[interval];
+                        auto pending = false;
+                        for (std::size_t lane = 0; lane < root.size(); ++lane) {
+                            active[lane] = std::signbit(leftValue[lane])
+                                != std::signbit(rightValue[lane]);
+                            root[lane] = active[lane]
+                                ? 0.5 * (left[lane] + right[lane]) : left[lane];
+                            pending = pending || active[lane];
+                        }
+                        for (unsigned iteration = 0;
+                                pending && iteration < LANE_ROOT_ITERATIONS; ++iteration) {
+                            const auto value = evaluateLanes(coefficients, root);
+                            const auto slope = evaluateLanes(slopes, root);
+                            pending = false;
+                            for (std::size_t lane = 0; lane < root.size(); ++lane) {
+                                const auto keepRight = std::signbit(value[lane])
+                                    == std::signbit(leftValue[lane]);
+                                left[lane] = keepRight ? root[lane] : left[lane];
+                                right[lane] = keepRight ? right[lane] : root[lane];
+                                const auto newton = root[lane] - value[lane] / slope[lane];
+                                const auto next = newton > left[lane] && newton < right[lane]
+                                    ? newton : 0.5 * (left[lane] + right[lane]);
+                                const auto settled = value[lane] == 0.0
+                                    || std::abs(next - root[lane]) <= LANE_ROOT_TOLERANCE;
+                                root[lane] = active[lane] && !settled ? next : root[lane];
+                                active[lane] = active[lane] && !settled;
+                                pending = pending || active[lane];
+                            }
+                        }
+                    }
+                }
+                return result;
+            }
+
+            template<std::size_t Count>
+            AxisLanes maximumAbsoluteLanes(const LanePolynomial<Count> &values) {
+                AxisLanes result{};
+                const auto accumulate = [&](const AxisLanes &parameter) {
+                    const auto value = evaluateLanes(values, parameter);
+                    for (std::size_t lane = 0; lane < result.size(); ++lane) {
+                        result[lane] = std::max(result[lane], std::abs(value[lane]));
+                    }
+                };
+                AxisLanes endpoint{};
+                accumulate(endpoint);
+                endpoint.fill(1.0);
+                accumulate(endpoint);
+                for (const auto &parameter :
+                        laneRootCandidates(laneDerivative(values))) {
+                    accumulate(parameter);
+                }
+                return result;
+            }
+
+            LanePolynomial<6> positionLanes(const AxisPolynomialSpan &span) {
+                LanePolynomial<6> result{};
+                for (std::size_t axis = 0; axis < AXIS_COMPONENTS.size(); ++axis) {
+                    const auto component = AXIS_COMPONENTS[axis];
+                    result[0][axis] = span.origin.*component;
+                    for (std::size_t index = 0; index < span.coefficients.size(); ++index) {
+                        result[index + 1][axis] = span.coefficients[index].*component;
+                    }
+                }
+                return result;
+            }
+
+            position_t positionFromLanes(const AxisLanes &lanes, const double scale) {
+                position_t result{};
+                for (std::size_t axis = 0; axis < AXIS_COMPONENTS.size(); ++axis) {
+                    result.*AXIS_COMPONENTS[axis] = lanes[axis] * scale;
+                }
+                return result;
+            }
         }
 
         AxisPositionRange axisPositionRange(const AxisPolynomialSpan &span,
@@ -1465,6 +1753,43 @@ namespace ngc {
                 * span.inverseDurationCubed;
         }
 
+        AxisSpanExtrema axisSpanExtrema(const AxisPolynomialSpan &span) {
+            const auto velocity = laneDerivative(positionLanes(span));
+            const auto acceleration = laneDerivative(velocity);
+            const auto jerk = laneDerivative(acceleration);
+            return {
+                .maximumVelocity = positionFromLanes(
+                    maximumAbsoluteLanes(velocity), span.inverseDuration),
+                .maximumAcceleration = positionFromLanes(
+                    maximumAbsoluteLanes(acceleration), span.inverseDurationSquared),
+                .maximumJerk = positionFromLanes(
+                    maximumAbsoluteLanes(jerk), span.inverseDurationCubed),
+            };
+        }
+
+        AxisPositionRanges axisPositionRanges(const AxisPolynomialSpan &span) {
+            const auto position = positionLanes(span);
+            AxisLanes parameter{};
+            auto minimum = evaluateLanes(position, parameter);
+            auto maximum = minimum;
+            const auto accumulate = [&](const AxisLanes &value) {
+                for (std::size_t lane = 0; lane < value.size(); ++lane) {
+                    minimum[lane] = std::min(minimum[lane], value[lane]);
+                    maximum[lane] = std::max(maximum[lane], value[lane]);
+                }
+            };
+            parameter.fill(1.0);
+            accumulate(evaluateLanes(position, parameter));
+            for (const auto &candidate :
+                    laneRootCandidates(laneDerivative(position))) {
+                accumulate(evaluateLanes(position, candidate));
+            }
+            return {
+                .minimum = positionFromLanes(minimum, 1.0),
+                .maximum = positionFromLanes(maximum, 1.0),
+            };
+        }
+
         double maximumPathAcceleration(const AxisPolynomialSpan &span) {
             return maximumLinearAcceleration(span);
         }
@@ -1493,6 +1818,53 @@ namespace ngc {
         }
     }
 
+    ScalarTransitionCache::ScalarTransitionCache(const std::size_t capacity)
+        : m_capacity(std::max<std::size_t>(1, capacity)) { }
+
+    std::size_t ScalarTransitionCache::KeyHash::operator()(const Key &key) const {
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+        for(const auto bits : key.bits) {
+            hash ^= bits + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return static_cast<std::size_t>(hash);
+    }
+
+    std::shared_ptr<const ScalarTransitionCache::Result> ScalarTransitionCache::find(
+            const Key &key) {
+        std::scoped_lock lock(m_mutex);
+        const auto found = m_index.find(key);
+        if(found == m_index.end()) return nullptr;
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+        return found->second->result;
+    }
+
+    void ScalarTransitionCache::insert(const Key &key, std::shared_ptr<const Result> result) {
+        std::scoped_lock lock(m_mutex);
+        if(const auto found = m_index.find(key); found != m_index.end()) {
+            // Another compiler solved the same transition concurrently; the
+            // results are identical, so keep the resident one.
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return;
+        }
+        if(m_entries.size() == m_capacity) {
+            m_index.erase(m_entries.back().key);
+            m_entries.pop_back();
+        }
+        m_entries.push_front({key, std::move(result)});
+        m_index.emplace(key, m_entries.begin());
+    }
+
+    std::size_t ScalarTransitionCache::size() const {
+        std::scoped_lock lock(m_mutex);
+        return m_entries.size();
+    }
+
+    void ScalarTransitionCache::clear() {
+        std::scoped_lock lock(m_mutex);
+        m_index.clear();
+        m_entries.clear();
+    }
+
     TrajectoryCompiler::TrajectoryCompiler(TrajectoryLimits limits) : m_limits(limits) { }
 
     void TrajectoryCompiler::reset(const EpochId epoch, const position_t &position) {
@@ -1522,6 +1894,7 @@ namespace ngc {
         chunk.predecessorBranch = m_previousBranch;
         chunk.branch = chunk.id;
         TimeLawWorkspace timeLawWorkspace;
+        timeLawWorkspace.cache = m_scalarTransitionCache.get();
         TimeLawCompilationRecorder timeLawRecorder {m_lastTimeLawDiagnostics};
         CurveEvaluationWorkspace preparedWorkspace;
         if(preparedPiece && (!preparedPiece->curve||preparedPiece->length()<=1e-12))
@@ -1538,10 +1911,10 @@ namespace ngc {
             position_t maximum{};
             if(!preparedPiece) return maximum;
             if(!preparedPiece->geometricSamples.empty()) {
-                for(const auto &sample : preparedPiece->geometricSamples)
-                    for(const auto component : AXIS_COMPONENTS)
-                        maximum.*component = std::max(
-                            maximum.*component, std::abs(sample.tangent.*component));
+                for(std::size_t axis = 0; axis < AXIS_COMPONENTS.size(); ++axis)
+                    for(const auto tangent : preparedPiece->geometricSamples.tangents(axis))
+                        maximum.*AXIS_COMPONENTS[axis] = std::max(
+                            maximum.*AXIS_COMPONENTS[axis], std::abs(tangent));
             } else {
                 constexpr unsigned samples = 64;
                 for(unsigned index = 0; index <= samples; ++index) {
@@ -1640,15 +2013,16 @@ namespace ngc {
             for(const auto &span : chunk.normalMotion) {
                 maximumAcceleration = std::max(maximumAcceleration, maximumLinearAcceleration(span));
                 maximumJerk = std::max(maximumJerk, maximumLinearJerk(span));
+                const auto extrema = trajectory_detail::axisSpanExtrema(span);
                 for(const auto component : AXIS_COMPONENTS) {
                     axisScaleFactor = std::max(axisScaleFactor,
-                        trajectory_detail::maximumAxisVelocity(span, component)
+                        extrema.maximumVelocity.*component
                             / (m_limits.axisVelocity.*component));
                     axisScaleFactor = std::max(axisScaleFactor, std::sqrt(
-                        trajectory_detail::maximumAxisAcceleration(span, component)
+                        extrema.maximumAcceleration.*component
                             / (m_limits.axisAcceleration.*component)));
                     axisScaleFactor = std::max(axisScaleFactor, std::cbrt(
-                        trajectory_detail::maximumAxisJerk(span, component)
+                        extrema.maximumJerk.*component
                             / (m_limits.axisJerk.*component)));
                 }
             }
@@ -1867,6 +2241,7 @@ namespace ngc {
                   != ContinuousBoundaryAccelerationMode::Optimized))
             return std::unexpected("continuous planning effort is outside its bounded range");
         reportProgress();
+        if(cancellationRequested()) return std::unexpected("continuous compile cancelled");
 
         std::vector<GeometryPiece> pieces;
         auto timingPieceCount=std::size_t{0};
@@ -1914,7 +2289,7 @@ namespace ngc {
             const auto appendTimingPiece=[&](
                     const double from,const double to,const double programmedVelocity,
                     const double staticVelocityLimit,const std::size_t knotInterval,
-                    const std::span<const PreparedGeometricSample> samples)
+                    const PreparedGeometricSampleView samples)
                     ->std::expected<void,std::string> {
                 const auto length=to-from;
                 const auto sampleOffset=from-prepared.curveFrom;
@@ -1929,16 +2304,17 @@ namespace ngc {
                         "prepared continuous piece {} timing interval has no geometric samples",
                         prepared.id));
                 const auto distanceTolerance=std::max(1e-10,prepared.length()*1e-10);
-                if(!std::isfinite(samples.front().distance)
-                   ||!std::isfinite(samples.back().distance)
-                   ||std::abs(samples.front().distance-sampleOffset)>distanceTolerance
-                   ||std::abs(samples.back().distance-(sampleOffset+length))>distanceTolerance)
+                const auto distances=samples.distances();
+                if(!std::isfinite(distances.front())
+                   ||!std::isfinite(distances.back())
+                   ||std::abs(distances.front()-sampleOffset)>distanceTolerance
+                   ||std::abs(distances.back()-(sampleOffset+length))>distanceTolerance)
                     return std::unexpected(std::format(
                         "prepared continuous piece {} timing samples do not match their interval",
                         prepared.id));
-                for(std::size_t sample=1;sample<samples.size();++sample)
-                    if(!std::isfinite(samples[sample].distance)
-                       ||samples[sample].distance<=samples[sample-1].distance)
+                for(std::size_t sample=1;sample<distances.size();++sample)
+                    if(!std::isfinite(distances[sample])
+                       ||distances[sample]<=distances[sample-1])
                         return std::unexpected(std::format(
                             "prepared continuous piece {} timing samples are not ordered",
                             prepared.id));
@@ -1977,6 +2353,7 @@ namespace ngc {
                     .programmedVelocity=programmedVelocity,
                     .staticVelocityLimit=staticVelocityLimit,
                     .linear=prepared.curve->geometricallyLinear,
+                    .curve=curve,
                     .geometricSamples=samples,
                     .geometricSampleDistanceOffset=sampleOffset,
                     .sampleAt=[curve,workspace,from,length](const double distance) {
@@ -2006,6 +2383,14 @@ namespace ngc {
                         return positionAtDistance(*curve,
                             from+std::clamp(distance,0.0,length),*workspace);
                     },
+                    .pathStateAt=[curve,workspace,from,length](const double distance) {
+                        const auto source=from+std::clamp(distance,0.0,length);
+                        PathState state;
+                        evaluateAtDistances(*curve,{&source,1},
+                            {.positions={&state.position,1},.tangents={&state.tangent,1},
+                             .curvatures={&state.curvature,1}},*workspace);
+                        return state;
+                    },
                     .chordErrorBound=[curve,workspace,from,length](const double a,const double b) {
                         return chordErrorBound(*curve,from+std::clamp(a,0.0,length),
                             from+std::clamp(b,0.0,length),*workspace);
@@ -2058,7 +2443,7 @@ namespace ngc {
                     return std::unexpected(std::format(
                         "prepared spline {} knot interval {} has invalid parameter span {}",
                         prepared.id,intervalIndex,interval.parameterSpan));
-                const auto samples=std::span{prepared.geometricSamples}.subspan(
+                const auto samples=prepared.geometricSamples.subview(
                     interval.firstGeometricSample,interval.geometricSampleCount);
                 if(auto appended=appendTimingPiece(interval.curveFrom,interval.curveTo,
                         interval.programmedFeed,interval.geometricVelocityLimit,
@@ -2154,13 +2539,23 @@ namespace ngc {
             auto local=std::clamp(boundary.distance,0.0,piece.length);
             if(local<1e-10) local=0.0;
             else if(piece.length-local<1e-10) local=piece.length;
-            const auto sample=piece.sampleAt(local);
-            const auto curvature = piece.linear
-                ? position_t{} : piece.curvatureAt(local);
+            // Timing-piece ends are the first and last prepared samples, so
+            // only their position needs an exact evaluation. Elsewhere one
+            // batched evaluation replaces separate position, tangent and
+            // curvature queries.
+            PathState state;
+            if(local==0.0||local==piece.length) {
+                const auto sample=local==0.0
+                    ?piece.geometricSamples.front():piece.geometricSamples.back();
+                state={piece.positionAt(local),sample.tangent,sample.curvature};
+                ++result->materialization.preparedSampleBoundaryStates;
+            } else state=piece.pathStateAt(local);
+            result->materialization.geometricEvaluationsAvoided+=piece.linear?1:2;
+            const auto curvature = piece.linear ? position_t{} : state.curvature;
             return KinematicPathState {
-                .position=sample.position,
-                .velocity=scaled(sample.tangent,boundary.velocity),
-                .acceleration=add(scaled(sample.tangent,boundary.acceleration),
+                .position=state.position,
+                .velocity=scaled(state.tangent,boundary.velocity),
+                .acceleration=add(scaled(state.tangent,boundary.acceleration),
                                   scaled(curvature,boundary.velocity*boundary.velocity)),
             };
         };
@@ -2229,6 +2624,16 @@ namespace ngc {
                         : path_tempo::BoundaryAccelerationMode::Optimized,
             },
         };
+        // Accepted piece materializations from the previous compile and from
+        // earlier passes of this one; the verified pass becomes the next memo.
+        const auto limitsKey = materializationLimitsKey(m_limits, m_continuousPlanningEffort);
+        decltype(ContinuousMaterializationMemo::pieces) materializations;
+        if (m_continuousMaterializationMemo
+           && m_continuousMaterializationMemo->limits == limitsKey) {
+            materializations = m_continuousMaterializationMemo->pieces;
+        }
+        std::vector<std::pair<MaterializedPieceKey, std::shared_ptr<const MaterializedPiece>>>
+            verifiedMaterializations;
         auto materializationPass = 0U;
         const path_tempo::MaterializationCorrection materializationCorrection =
             [&](const path_tempo::PlannedPath &candidate)
@@ -2238,6 +2643,7 @@ namespace ngc {
             result->materialization.candidatePieces+=pieces.size();
             const auto conversionStarted=std::chrono::steady_clock::now();
             reportProgress();
+            if(cancellationRequested()) return std::unexpected("continuous compile cancelled");
             const auto *planned = &candidate;
             if (planned->pieceBoundaries.size()!=pieces.size()+1
                ||planned->pieceLimits.size()!=pieces.size()) {
@@ -2268,6 +2674,8 @@ namespace ngc {
 
             std::vector<double> correction(pieces.size(), 1.0);
             std::vector<double> quinticCorrection(pieces.size(), 1.0);
+            std::vector<std::pair<MaterializedPieceKey, std::shared_ptr<const MaterializedPiece>>>
+                passMaterializations;
             {
                 // Construct the production degree-aware normal-motion sequence.
                 auto &quintic = result->materialization.quintic;
@@ -2385,6 +2793,9 @@ namespace ngc {
                     return {};
                 };
                 for (std::size_t pieceIndex = 0; pieceIndex < pieces.size(); ++pieceIndex) {
+                    if (cancellationRequested()) {
+                        return std::unexpected("continuous compile cancelled");
+                    }
                     const auto &piece = pieces[pieceIndex];
                     const auto &boundaries = pieceTiming[pieceIndex];
                     const auto pieceDuration = boundaries.back().time;
@@ -2410,21 +2821,6 @@ namespace ngc {
                         return result;
                     };
                     const auto firstShadowSpan = quintic.shadowSpans.size();
-                    struct QuinticCandidate {
-                        bool accepted = false;
-                        bool constraintsVerified = false;
-                        bool geometryEvaluated = false;
-                        bool geometryVerified = false;
-                        bool progressVerified = false;
-                        double maximumRatio = 0.0;
-                        double maximumCorrectionRatio = 0.0;
-                        double acceptanceRatio = 0.0;
-                        double accelerationExcursionRatio = 0.0;
-                        bool subServoJerkAccepted = false;
-                        ContinuousPolynomialConstraintKind constraint =
-                            ContinuousPolynomialConstraintKind::PathAcceleration;
-                        std::size_t axis = std::numeric_limits<std::size_t>::max();
-                    };
                     const auto pathVelocityLimit =
                         std::min(piece.programmedVelocity, piece.staticVelocityLimit);
                     const auto proveGeometry = [&](QuinticCandidate &candidate,
@@ -2560,9 +2956,15 @@ namespace ngc {
                         return stateAtTime(totalDuration * u);
                     };
 
+                    auto memoKey = materializedPieceKey(
+                        piece, pathVelocityLimit, boundaries);
+                    const auto memoized = materializations.find(memoKey);
+                    const auto *reused = memoized != materializations.end()
+                        ? memoized->second.get() : nullptr;
                     LocalQuinticBezier initialQuintic;
-                    const auto initial = evaluateStates(
-                        boundaries.front(), boundaries.back(), &initialQuintic);
+                    const auto initial = reused ? reused->initial
+                        : evaluateStates(
+                            boundaries.front(), boundaries.back(), &initialQuintic);
                     ++quintic.initialSpans;
                     ++quintic.initialWorstRatioHistogram[
                         polynomialSeverityBin(initial.maximumRatio)];
@@ -2579,14 +2981,8 @@ namespace ngc {
                         quintic.worstInitialAxis = initial.axis;
                     }
 
-                    struct AdaptiveLeaf {
-                        double from = 0.0;
-                        double to = 0.0;
-                        bool accepted = false;
-                        QuinticCandidate candidate;
-                        LocalQuinticBezier quintic;
-                    };
                     std::vector<AdaptiveLeaf> leaves;
+                    auto pieceDepth = 0U;
                     const auto refine = [&](const auto &self, const double u0,
                                             const double u1, const unsigned depth,
                                             const QuinticCandidate *retainedCandidate,
@@ -2608,14 +3004,14 @@ namespace ngc {
                         if (candidate.accepted) {
                             leaves.push_back({
                                 u0, u1, true, candidate, candidateQuintic});
-                            quintic.maximumDepth = std::max(quintic.maximumDepth, depth);
+                            pieceDepth = std::max(pieceDepth, depth);
                             return;
                         }
                         if (depth >= 20) {
                             leaves.push_back({
                                 u0, u1, false, candidate, candidateQuintic});
                             ++quintic.numericallyUnrefinableIntervals;
-                            quintic.maximumDepth = std::max(quintic.maximumDepth, depth);
+                            pieceDepth = std::max(pieceDepth, depth);
                             return;
                         }
                         auto split = std::midpoint(u0, u1);
@@ -2678,26 +3074,33 @@ namespace ngc {
                             leaves.push_back({
                                 u0, u1, false, candidate, candidateQuintic});
                             ++quintic.numericallyUnrefinableIntervals;
-                            quintic.maximumDepth = std::max(quintic.maximumDepth, depth);
+                            pieceDepth = std::max(pieceDepth, depth);
                             return;
                         }
                         ++quintic.subdivisions;
                         self(self, u0, split, depth + 1, nullptr, nullptr);
                         self(self, split, u1, depth + 1, nullptr, nullptr);
                     };
-                    if (initial.accepted) {
+                    if (reused) {
+                        pieceDepth = reused->maximumDepth;
+                        ++result->materialization.reusedPieces;
+                        result->materialization.reusedQuinticSpans +=
+                            reused->leaves.size();
+                    } else if (initial.accepted) {
                         leaves.push_back({
                             0.0, 1.0, true, initial, initialQuintic});
                     } else {
                         refine(refine, 0.0, 1.0, 0,
                             &initial, &initialQuintic);
                     }
+                    quintic.maximumDepth = std::max(quintic.maximumDepth, pieceDepth);
+                    const auto &pieceLeaves = reused ? reused->leaves : leaves;
 
                     const auto allLeavesAccepted =
-                        std::ranges::all_of(leaves, &AdaptiveLeaf::accepted);
+                        std::ranges::all_of(pieceLeaves, &AdaptiveLeaf::accepted);
                     if (!allLeavesAccepted) {
                         auto pieceFailures = std::size_t{0};
-                        for (const auto &leaf : leaves) {
+                        for (const auto &leaf : pieceLeaves) {
                             if (leaf.accepted) {
                                 continue;
                             }
@@ -2877,7 +3280,7 @@ namespace ngc {
                         shadowGlobalTime += pieceDuration;
                         continue;
                     }
-                    for (const auto &leaf : leaves) {
+                    for (const auto &leaf : pieceLeaves) {
                         const auto fromTime = totalDuration * leaf.from;
                         const auto toTime = totalDuration * leaf.to;
                         const auto from = stateAt(leaf.from);
@@ -2962,6 +3365,17 @@ namespace ngc {
                             !assigned) {
                         return std::unexpected(assigned.error());
                     }
+                    if (reused) {
+                        passMaterializations.emplace_back(
+                            std::move(memoKey), memoized->second);
+                    } else if (!quintic.resourceExhausted) {
+                        auto materialized = std::make_shared<const MaterializedPiece>(
+                            MaterializedPiece{piece.curve, initial, pieceDepth,
+                                              std::move(leaves)});
+                        materializations.emplace(memoKey, materialized);
+                        passMaterializations.emplace_back(
+                            std::move(memoKey), std::move(materialized));
+                    }
                     shadowGlobalTime += pieceDuration;
                     if (quintic.finalQuinticSpans >= maximumQuinticSpans) {
                         quintic.resourceExhausted = true;
@@ -3352,6 +3766,7 @@ namespace ngc {
                 *std::ranges::max_element(correction);
             if (worst <= 1.0 + 1e-9) {
                 constraintsVerified = true;
+                verifiedMaterializations = std::move(passMaterializations);
                 result->pieceTiming.clear();
                 result->pieceTiming.reserve(pieces.size());
                 for (std::size_t pieceIndex = 0;
@@ -3433,6 +3848,13 @@ namespace ngc {
         }
 
         result->correctionHistory = correctionHistory;
+        auto memo = std::make_shared<ContinuousMaterializationMemo>();
+        memo->limits = limitsKey;
+        memo->pieces.reserve(verifiedMaterializations.size());
+        for (auto &[key, piece] : verifiedMaterializations) {
+            memo->pieces.emplace(std::move(key), std::move(piece));
+        }
+        m_continuousMaterializationMemo = std::move(memo);
 
         const auto &quintic =
             result->materialization.quintic;
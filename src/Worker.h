@@ -3,6 +3,7 @@
 #include <condition_variable>
 #include <cstdint>
 #include <format>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <thread>
@@ -77,6 +78,17 @@ public:
         return true;
     }
 
+    bool setProgramCache(std::shared_ptr<const ngc::ProgramCache> cache) {
+        std::scoped_lock lock(m_mutex);
+
+        if(m_busy) {
+            return false;
+        }
+
+        m_session.setProgramCache(std::move(cache));
+        return true;
+    }
+
     bool setPersistentParameters(const std::unordered_map<ngc::Var, double> &parameters) {
         std::scoped_lock lock(m_mutex);
         if (m_busy) {
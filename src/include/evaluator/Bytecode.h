@@ -0,0 +1,563 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parser/Expression.h"
+#include "parser/Statement.h"
+#include "parser/SubSignature.h"
+#include "parser/Visitor.h"
+
+namespace ngc {
+    enum class OpCode : std::uint8_t {
+        // polls for interruption at the start of every statement
+        STATEMENT,
+
+        CONSTANT,
+        ARGUMENT,
+        LOOKUP,
+        SYNCHRONIZE,
+        READ,
+        ADDRESS,
+        ASSIGN,
+        POP,
+
+        NEGATE,
+        ADD, SUB, MUL, DIV, MOD,
+        EQ, NE, LT, LE, GT, GE,
+        AND, OR, XOR,
+
+        JUMP,
+        JUMP_IF_ZERO,
+        JUMP_IF_ACTION,
+        JUMP_IF_RETURN,
+
+        // contexts carry the lazily opened scope and the pending break/continue/return of an if or loop body
+        ENTER_CONTEXT,
+        LEAVE_IF,
+        LEAVE_LOOP,
+        BREAK,
+        CONTINUE,
+        RETURN,
+
+        ALLOCATE,
+        ALIAS,
+        DECLARE_SUB,
+        FIND_SUB,
+        CALL,
+
+        BLOCK,
+        BEGIN_TEXT,
+        APPEND_VALUE,
+        APPEND_STRING,
+        PRINT,
+        ALERT,
+
+        FAIL,
+        END
+    };
+
+    struct Instruction {
+        OpCode op;
+        std::uint32_t operand = 0;
+    };
+
+    // Flat code for one statement list, sub body or expression. Operands index the pools below, name and sub
+    // symbols of the SymbolTable, or jump targets in code.
+    struct Chunk {
+        struct StatementRange {
+            std::uint32_t begin;
+            std::uint32_t end;
+            const Statement *statement;
+        };
+
+        std::vector<Instruction> code;
+        std::vector<double> constants;
+        std::vector<const BlockStatement *> blocks;
+        std::vector<const SubStatement *> subs;
+        std::vector<std::string_view> strings;
+        std::vector<std::string> messages;
+        // in preorder, so the ranges enclosing an instruction appear outermost first
+        std::vector<StatementRange> statements;
+        // expressions replaced by their constant value and conditions decided while compiling
+        std::uint32_t foldedExpressions = 0;
+        std::uint32_t prunedBranches = 0;
+    };
+
+    // Interns variable names and sub signatures into dense ids, so bindings are found by index at run time.
+    // Keys view the program sources, which must outlive the table.
+    class SymbolTable {
+        std::unordered_map<std::string_view, std::uint32_t> m_nameIds;
+        std::vector<std::string_view> m_names;
+        std::unordered_map<SubSignature, std::uint32_t> m_subIds;
+        std::vector<SubSignature> m_subs;
+
+    public:
+        std::uint32_t name(const std::string_view name) {
+            const auto [it, inserted] = m_nameIds.try_emplace(name, static_cast<std::uint32_t>(m_names.size()));
+
+            if(inserted) {
+                m_names.push_back(name);
+            }
+
+            return it->second;
+        }
+
+        std::uint32_t sub(const SubSignature &signature) {
+            const auto [it, inserted] = m_subIds.try_emplace(signature, static_cast<std::uint32_t>(m_subs.size()));
+
+            if(inserted) {
+                m_subs.push_back(signature);
+            }
+
+            return it->second;
+        }
+
+        // looks a signature up without interning it, for names that do not come from a program source
+        [[nodiscard]] std::optional<std::uint32_t> findSub(const SubSignature &signature) const {
+            if(const auto it = m_subIds.find(signature); it != m_subIds.end()) {
+                return it->second;
+            }
+
+            return std::nullopt;
+        }
+
+        [[nodiscard]] std::string_view nameOf(const std::uint32_t id) const { return m_names[id]; }
+        [[nodiscard]] const SubSignature &subOf(const std::uint32_t id) const { return m_subs[id]; }
+        [[nodiscard]] std::size_t names() const { return m_names.size(); }
+        [[nodiscard]] std::size_t subs() const { return m_subs.size(); }
+    };
+
+    // Lowers statements and expressions into a Chunk. Every expression leaves exactly one value on the stack.
+    class Compiler final : public Visitor {
+        Chunk &m_chunk;
+        SymbolTable &m_symbols;
+        // let, alias and sub statements in the global context are handled by the first pass
+        bool m_global = false;
+
+    public:
+        Compiler(Chunk &chunk, SymbolTable &symbols) : m_chunk(chunk), m_symbols(symbols) { }
+
+        void compileProgram(const std::span<const Statement * const> program) {
+            m_global = true;
+
+            for(const auto statement : program) {
+                compileStatement(statement);
+            }
+
+            emit(OpCode::END);
+        }
+
+        void compileSub(const SubStatement *sub) {
+            m_global = false;
+
+            for(std::uint32_t i = 0; const auto param : sub->params()) {
+                emit(OpCode::ARGUMENT, i++);
+                emit(OpCode::ALLOCATE, m_symbols.name(param->name()));
+            }
+
+            // only a return ends the body early, a stray break or continue does not
+            std::vector<std::uint32_t> returns;
+
+            for(const auto statement : sub->body()->statements()) {
+                compileStatement(statement);
+                returns.push_back(emit(OpCode::JUMP_IF_RETURN));
+            }
+
+            patch(returns);
+            emit(OpCode::END);
+        }
+
+        void compileExpression(const RealExpression *expression) {
+            m_global = true;
+            compileValue(expression);
+            // the value is handed back like a sub's return value
+            emit(OpCode::RETURN);
+            emit(OpCode::END);
+        }
+
+        void visit(const ExpressionStatement *stmt, VisitorContext *) override {
+            if(const auto real = stmt->expression()->as<RealExpression>()) {
+                real->accept(*this, nullptr);
+                emit(OpCode::POP);
+            }
+        }
+
+        void visit(const CompoundStatement *stmt, VisitorContext *) override {
+            std::vector<std::uint32_t> exits;
+
+            for(const auto statement : stmt->statements()) {
+                compileStatement(statement);
+                exits.push_back(emit(OpCode::JUMP_IF_ACTION));
+            }
+
+            patch(exits);
+        }
+
+        void visit(const BlockStatement *stmt, VisitorContext *) override {
+            for(const auto word : stmt->expressions()) {
+                compileValue(word->real());
+            }
+
+            emit(OpCode::BLOCK, pool(m_chunk.blocks, stmt));
+        }
+
+        void visit(const SubStatement *stmt, VisitorContext *) override {
+            if(!m_global) {
+                emit(OpCode::DECLARE_SUB, pool(m_chunk.subs, stmt));
+            }
+        }
+
+        void visit(const IfStatement *stmt, VisitorContext *) override {
+            if(const auto condition = constant(stmt->condition())) {
+                m_chunk.prunedBranches++;
+
+                if(const auto body = *condition != 0.0 ? stmt->body() : stmt->elseBody()) {
+                    compileBody(body);
+                    emit(OpCode::LEAVE_IF);
+                }
+
+                return;
+            }
+
+            compileValue(stmt->condition());
+            const auto skipBody = emit(OpCode::JUMP_IF_ZERO);
+            compileBody(stmt->body());
+            emit(OpCode::LEAVE_IF);
+
+            if(!stmt->elseBody()) {
+                patch(skipBody);
+                return;
+            }
+
+            const auto skipElse = emit(OpCode::JUMP);
+            patch(skipBody);
+            compileBody(stmt->elseBody());
+            emit(OpCode::LEAVE_IF);
+            patch(skipElse);
+        }
+
+        void visit(const WhileStatement *stmt, VisitorContext *) override {
+            const auto condition = constant(stmt->condition());
+
+            if(condition) {
+                m_chunk.prunedBranches++;
+
+                if(!(*condition != 0.0)) {
+                    return;
+                }
+            }
+
+            // a constant true condition is not tested again, only break or return leave the loop
+            const auto top = here();
+            std::optional<std::uint32_t> exit;
+
+            if(!condition) {
+                compileValue(stmt->condition());
+                exit = emit(OpCode::JUMP_IF_ZERO);
+            }
+
+            compileBody(stmt->body());
+            const auto leave = emit(OpCode::LEAVE_LOOP);
+            emit(OpCode::JUMP, top);
+
+            if(exit) {
+                patch(*exit);
+            }
+
+            patch(leave);
+        }
+
+        void visit(const ReturnStatement *stmt, VisitorContext *) override {
+            compileValue(stmt->real());
+            emit(OpCode::RETURN);
+        }
+
+        void visit(const BreakStatement *, VisitorContext *) override {
+            emit(OpCode::BREAK);
+        }
+
+        void visit(const ContinueStatement *, VisitorContext *) override {
+            emit(OpCode::CONTINUE);
+        }
+
+        void visit(const AliasStatement *stmt, VisitorContext *) override {
+            if(!m_global) {
+                compileValue(stmt->address());
+                emit(OpCode::ALIAS, m_symbols.name(stmt->variable()->name()));
+            }
+        }
+
+        void visit(const LetStatement *stmt, VisitorContext *) override {
+            if(m_global) {
+                return;
+            }
+
+            if(stmt->value()) {
+                compileValue(stmt->value());
+            } else {
+                emit(OpCode::CONSTANT, pool(m_chunk.constants, 0.0));
+            }
+
+            emit(OpCode::ALLOCATE, m_symbols.name(stmt->variable()->name()));
+        }
+
+        void visit(const LiteralExpression *expr, VisitorContext *) override {
+            emit(OpCode::CONSTANT, pool(m_chunk.constants, expr->value()));
+        }
+
+        void visit(const NumericVariableExpression *expr, VisitorContext *) override {
+            compileValue(expr->real());
+            emit(OpCode::ADDRESS);
+        }
+
+        void visit(const NamedVariableExpression *expr, VisitorContext *) override {
+            emit(OpCode::LOOKUP, m_symbols.name(expr->name()));
+        }
+
+        void visit(const UnaryExpression *expr, VisitorContext *) override {
+            switch(expr->op()) {
+                case UnaryExpression::Op::ADDRESS_OF:
+                    if(!expr->real()->is<VariableExpression>()) {
+                        fail(std::format("tried to take address of {}", expr->className()));
+                        return;
+                    }
+
+                    compileValue(expr->real(), false);
+                    emit(OpCode::ADDRESS);
+                    return;
+                case UnaryExpression::Op::NEGATIVE:
+                    compileValue(expr->real());
+                    emit(OpCode::NEGATE);
+                    return;
+                case UnaryExpression::Op::POSITIVE:
+                    compileValue(expr->real());
+                    return;
+            }
+        }
+
+        void visit(const BinaryExpression *expr, VisitorContext *) override {
+            if(expr->op() == BinaryExpression::Op::ASSIGN) {
+                if(!expr->left()->is<VariableExpression>()) {
+                    fail(std::format("tried to assign to {}", expr->className()));
+                    return;
+                }
+
+                compileValue(expr->left(), false);
+                compileValue(expr->right());
+                emit(OpCode::ASSIGN);
+                return;
+            }
+
+            compileValue(expr->left());
+            compileValue(expr->right());
+
+            switch(expr->op()) {
+                using enum BinaryExpression::Op;
+                case AND: emit(OpCode::AND); break;
+                case OR: emit(OpCode::OR); break;
+                case XOR: emit(OpCode::XOR); break;
+                case EQ: emit(OpCode::EQ); break;
+                case NE: emit(OpCode::NE); break;
+                case LT: emit(OpCode::LT); break;
+                case LE: emit(OpCode::LE); break;
+                case GT: emit(OpCode::GT); break;
+                case GE: emit(OpCode::GE); break;
+                case ADD: emit(OpCode::ADD); break;
+                case SUB: emit(OpCode::SUB); break;
+                case MUL: emit(OpCode::MUL); break;
+                case DIV: emit(OpCode::DIV); break;
+                case MOD: emit(OpCode::MOD); break;
+                default: throw std::logic_error(std::format("invalid binary operator BinaryExpression::Op{}", std::to_underlying(expr->op())));
+            }
+        }
+
+        void visit(const CallExpression *expr, VisitorContext *) override {
+            // TODO: more extensible way to evaluate built in functions
+            if(expr->name() == "print" || expr->name() == "alert") {
+                emit(OpCode::SYNCHRONIZE);
+                emit(OpCode::BEGIN_TEXT);
+
+                for(const auto arg : expr->args()) {
+                    if(const auto real = arg->as<RealExpression>()) {
+                        compileValue(real);
+                        emit(OpCode::APPEND_VALUE);
+                    } else if(const auto str = arg->as<StringExpression>()) {
+                        emit(OpCode::APPEND_STRING, pool(m_chunk.strings, str->value()));
+                    }
+                }
+
+                emit(expr->name() == "alert" ? OpCode::ALERT : OpCode::PRINT);
+                return;
+            }
+
+            // the sub is resolved before its arguments are evaluated, in the caller's scope
+            emit(OpCode::FIND_SUB, m_symbols.sub(SubSignature(expr)));
+
+            for(const auto arg : expr->args()) {
+                if(const auto real = arg->as<RealExpression>()) {
+                    compileValue(real);
+                } else {
+                    fail(std::format("expected {}, but found {}", RealExpression::staticClassName(), arg->className()));
+                }
+            }
+
+            emit(OpCode::CALL, static_cast<std::uint32_t>(expr->args().size()));
+        }
+
+        void visit(const GroupingExpression *expr, VisitorContext *) override {
+            compileValue(expr->real());
+        }
+
+        // never evaluated for their value, but must keep the stack balanced
+        void visit(const StringExpression *, VisitorContext *) override { emit(OpCode::CONSTANT, pool(m_chunk.constants, 0.0)); }
+        void visit(const CommentExpression *, VisitorContext *) override { emit(OpCode::CONSTANT, pool(m_chunk.constants, 0.0)); }
+        void visit(const WordExpression *, VisitorContext *) override { emit(OpCode::CONSTANT, pool(m_chunk.constants, 0.0)); }
+
+    private:
+        void compileStatement(const Statement *statement) {
+            // interruption is polled outside the range, so it is not attributed to the statement
+            emit(OpCode::STATEMENT);
+            const auto range = m_chunk.statements.size();
+            m_chunk.statements.push_back({ here(), 0, statement });
+            statement->accept(*this, nullptr);
+            m_chunk.statements[range].end = here();
+        }
+
+        // if and while bodies run in a context of their own, which is never the global one
+        void compileBody(const CompoundStatement *body) {
+            const auto global = std::exchange(m_global, false);
+            emit(OpCode::ENTER_CONTEXT);
+            compileStatement(body);
+            m_global = global;
+        }
+
+        // variables are read where they are used as values, after synchronizing with the machine
+        void compileValue(const RealExpression *expression, const bool dereference = true) {
+            if(!expression->is<LiteralExpression>()) {
+                if(const auto value = constant(expression)) {
+                    m_chunk.foldedExpressions++;
+                    emit(OpCode::CONSTANT, pool(m_chunk.constants, *value));
+                    return;
+                }
+            }
+
+            const auto variable = dereference && expression->is<VariableExpression>();
+
+            if(variable) {
+                emit(OpCode::SYNCHRONIZE);
+            }
+
+            expression->accept(*this, nullptr);
+
+            if(variable) {
+                emit(OpCode::READ);
+            }
+        }
+
+        // the value of an expression built only from literals, computed like the instructions it replaces;
+        // variables and calls are never constant, since memory and subs can change while the program runs
+        static std::optional<double> constant(const RealExpression *expression) {
+            if(const auto literal = expression->as<LiteralExpression>()) {
+                return literal->value();
+            }
+
+            if(const auto grouping = expression->as<GroupingExpression>()) {
+                return constant(grouping->real());
+            }
+
+            if(const auto unary = expression->as<UnaryExpression>()) {
+                if(unary->op() == UnaryExpression::Op::ADDRESS_OF) {
+                    return std::nullopt;
+                }
+
+                const auto value = constant(unary->real());
+
+                if(!value) {
+                    return std::nullopt;
+                }
+
+                return unary->op() == UnaryExpression::Op::NEGATIVE ? -*value : *value;
+            }
+
+            const auto binary = expression->as<BinaryExpression>();
+
+            if(!binary || binary->op() == BinaryExpression::Op::ASSIGN) {
+                return std::nullopt;
+            }
+
+            const auto left = constant(binary->left());
+
+            if(!left) {
+                return std::nullopt;
+            }
+
+            const auto right = constant(binary->right());
+
+            if(!right) {
+                return std::nullopt;
+            }
+
+            const auto l = *left;
+            const auto r = *right;
+
+            switch(binary->op()) {
+                using enum BinaryExpression::Op;
+                case AND: return static_cast<bool>(l) && static_cast<bool>(r);
+                case OR: return static_cast<bool>(l) || static_cast<bool>(r);
+                case XOR: return (static_cast<bool>(l) && !static_cast<bool>(r)) || (static_cast<bool>(r) && !static_cast<bool>(l));
+                case EQ: return l == r;
+                case NE: return l != r;
+                case LT: return l < r;
+                case LE: return l <= r;
+                case GT: return l > r;
+                case GE: return l >= r;
+                case ADD: return l + r;
+                case SUB: return l - r;
+                case MUL: return l * r;
+                case DIV: return l / r;
+                case MOD: return std::fmod(l, r);
+                default: return std::nullopt;
+            }
+        }
+
+        void fail(std::string message) {
+            m_chunk.messages.push_back(std::move(message));
+            emit(OpCode::FAIL, static_cast<std::uint32_t>(m_chunk.messages.size() - 1));
+        }
+
+        std::uint32_t emit(const OpCode op, const std::uint32_t operand = 0) {
+            m_chunk.code.push_back({ op, operand });
+            return static_cast<std::uint32_t>(m_chunk.code.size() - 1);
+        }
+
+        [[nodiscard]] std::uint32_t here() const {
+            return static_cast<std::uint32_t>(m_chunk.code.size());
+        }
+
+        void patch(const std::uint32_t jump) {
+            m_chunk.code[jump].operand = here();
+        }
+
+        void patch(const std::vector<std::uint32_t> &jumps) {
+            for(const auto jump : jumps) {
+                patch(jump);
+            }
+        }
+
+        template<typename T>
+        static std::uint32_t pool(std::vector<T> &values, T value) {
+            values.push_back(std::move(value));
+            return static_cast<std::uint32_t>(values.size() - 1);
+        }
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <concepts>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -18,6 +20,7 @@ namespace ngc {
     class Evaluator;
     class AlertMessage;
     class BlockMessage;
+    class MemoryAccessMessage;
     class PrintMessage;
     class ProgramPauseMessage;
     class SynchronizationMessage;
@@ -28,6 +31,7 @@ namespace ngc {
         virtual ~EvaluatorMessageVisitor() = default;
         virtual void visit(const AlertMessage &) = 0;
         virtual void visit(const BlockMessage &) = 0;
+        virtual void visit(const MemoryAccessMessage &) = 0;
         virtual void visit(const PrintMessage &) = 0;
         virtual void visit(const ProgramPauseMessage &) = 0;
         virtual void visit(const SynchronizationMessage &) = 0;
@@ -40,6 +44,7 @@ namespace ngc {
         virtual void accept(EvaluatorMessageVisitor &visitor) const = 0;
         virtual bool isImpl(const AlertMessage *) const { return false; }
         virtual bool isImpl(const BlockMessage *) const { return false; }
+        virtual bool isImpl(const MemoryAccessMessage *) const { return false; }
         virtual bool isImpl(const PrintMessage *) const { return false; }
         virtual bool isImpl(const ProgramPauseMessage *) const { return false; }
         virtual bool isImpl(const SynchronizationMessage *) const { return false; }
@@ -91,6 +96,14 @@ namespace ngc {
         void accept(EvaluatorMessageVisitor &visitor) const override { visitor.visit(*this); }
     };
 
+    // Sent before the evaluator writes memory for the first time after publishing a block, since whoever
+    // handles blocks may still be executing them against the same memory.
+    class MemoryAccessMessage final : public EvaluatorMessage {
+    public:
+        bool isImpl(const MemoryAccessMessage *) const override { return true; }
+        void accept(EvaluatorMessageVisitor &visitor) const override { visitor.visit(*this); }
+    };
+
     class ToolChangeModalStateRestoredMessage final : public EvaluatorMessage {
     public:
         bool isImpl(const ToolChangeModalStateRestoredMessage *) const override {
@@ -99,6 +112,12 @@ namespace ngc {
         void accept(EvaluatorMessageVisitor &visitor) const override { visitor.visit(*this); }
     };
 
+    // counts what the compiler resolved ahead of evaluation
+    struct EvaluatorDiagnostics {
+        std::uint64_t foldedExpressions = 0;
+        std::uint64_t prunedBranches = 0;
+    };
+
     class Evaluator {
     public:
         using Callback = std::function<void(std::unique_ptr<const EvaluatorMessage>, Evaluator &)>;
@@ -110,9 +129,8 @@ namespace ngc {
 
         template<typename ...Args>
         double call(std::string name, Args... args) requires (std::convertible_to<Args, double> && ...) {
-            std::vector<std::unique_ptr<ScalarExpression>> values;
-            (values.emplace_back(LiteralExpression::fromDouble(args)), ...);
-            return callPrepared(std::move(name), std::move(values));
+            const std::array<double, sizeof...(Args)> values { static_cast<double>(args)... };
+            return callPrepared(name, values);
         }
 
         void declareGlobal(const NamedVariableExpression *expression, std::uint32_t address,
@@ -122,10 +140,11 @@ namespace ngc {
         void pauseProgram();
         void synchronize();
         void toolChangeModalStateRestored();
+        [[nodiscard]] const EvaluatorDiagnostics &diagnostics() const;
 
     private:
         class Impl;
         std::unique_ptr<Impl> m_impl;
-        double callPrepared(std::string name, std::vector<std::unique_ptr<ScalarExpression>> args);
+        double callPrepared(const std::string &name, std::span<const double> args);
     };
 }
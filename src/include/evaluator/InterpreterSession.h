@@ -1,17 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <exception>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <print>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -20,7 +26,9 @@
 #include "evaluator/InterpreterStatus.h"
 #include "evaluator/Preamble.h"
 #include "machine/Machine.h"
+#include "machine/OwningSpscChannel.h"
 #include "parser/Program.h"
+#include "parser/ProgramCache.h"
 
 namespace ngc {
     enum class InterpretationMode {
@@ -38,6 +46,22 @@ namespace ngc {
         return 0.0;
     }
 
+    enum class ProgramParsing {
+        // every program is parsed by compile() before execution starts
+        Complete,
+        // the last program is parsed statement by statement while it executes; its subs must be declared
+        // before they are called and a syntax error is only reported once execution reaches it
+        Incremental,
+    };
+
+    // what the last InterpreterSession::compile() had to do; programs whose name and text were unchanged since the
+    // previous setPrograms() keep their parse and are counted as reused, those found in the ProgramCache as cached
+    struct ProgramCompileDiagnostics {
+        std::size_t parsedPrograms = 0;
+        std::size_t reusedPrograms = 0;
+        std::size_t cachedPrograms = 0;
+    };
+
     struct InterpreterCompleted { };
 
     struct InterpreterError {
@@ -77,10 +101,28 @@ namespace ngc {
     class InterpreterSession {
         struct ExecutionStopped { };
 
+        // An evaluator message or block lifecycle change, in the order the evaluation thread produced them. The
+        // evaluation thread runs ahead of the consumer and only waits after a barrier, until everything up to it
+        // has been consumed.
+        struct PublishedEvent {
+            std::unique_ptr<const EvaluatorMessage> message {};
+            std::optional<BlockExecution> block {};
+            std::optional<InterpreterBlockLifecycle> lifecycle {};
+            bool barrier = false;
+        };
+
+        static constexpr std::size_t PUBLISHED_EVENT_QUEUE_CAPACITY = 256;
+
         Machine m_machine;
         InterpretationMode m_mode;
         std::vector<Program> m_programs;
+        ProgramParsing m_parsing = ProgramParsing::Complete;
         std::vector<Parser::Error> m_parserErrors;
+        // compiled programs of the previous setPrograms(), keyed by programHash(), so that sources submitted with
+        // every run (the autoload subroutines) are parsed once
+        std::unordered_multimap<std::size_t, Program> m_parsedPrograms;
+        ProgramCompileDiagnostics m_compileDiagnostics;
+        std::shared_ptr<const ProgramCache> m_programCache;
         std::vector<InterpreterStatusMessage> m_statusMessages;
         std::vector<std::string> m_blockMessages;
         bool m_compiled = false;
@@ -88,8 +130,8 @@ namespace ngc {
         std::mutex m_executionMutex;
         std::condition_variable m_executionCv;
         std::thread m_executionThread;
-        std::unique_ptr<const EvaluatorMessage> m_pendingMessage;
-        std::optional<BlockExecution> m_pendingMessageBlock;
+        OwningSpscChannel<PublishedEvent, PUBLISHED_EVENT_QUEUE_CAPACITY> m_publishedEvents;
+        bool m_barrierConsumed = false;
         std::deque<MachineCommand> m_pendingCommands;
         std::deque<InterpreterBlockLifecycle> m_pendingBlockLifecycle;
         std::optional<std::uint64_t> m_pendingProbe;
@@ -97,14 +139,12 @@ namespace ngc {
         bool m_pendingProgramPause = false;
         bool m_pendingToolChangeModalStateRestored = false;
         std::optional<Machine::ToolChangeModalCheckpoint> m_toolChangeModalCheckpoint;
-        bool m_evaluatorPaused = false;
         bool m_resumeEvaluator = false;
         bool m_executionStarted = false;
-        bool m_executionFinished = false;
-        bool m_stopExecution = false;
+        std::atomic<bool> m_executionFinished = false;
+        std::atomic<bool> m_stopExecution = false;
         std::optional<std::string> m_executionError;
         std::uint64_t m_nextBlockExecutionId = 1;
-        std::optional<InterpreterBlockLifecycle> m_publishedBlockLifecycle;
 
     public:
         InterpreterSession(const Machine::Unit unit, const InterpretationMode mode) : m_machine(unit), m_mode(mode) { }
@@ -127,33 +167,62 @@ namespace ngc {
         }
 
         bool compiled() const { return m_compiled; }
+        const ProgramCompileDiagnostics &compileDiagnostics() const { return m_compileDiagnostics; }
+
+        // programs compile() has to parse are looked up in, and then added to, the cache; nullptr disables it
+        void setProgramCache(std::shared_ptr<const ProgramCache> cache) {
+            m_programCache = std::move(cache);
+        }
 
         void setPrograms(const std::vector<std::tuple<std::string, std::string>> &programs) {
             stop();
-            m_programs.clear();
+            recycleParsedPrograms();
             m_parserErrors.clear();
             m_statusMessages.clear();
             m_blockMessages.clear();
 
             for(const auto &[source, name] : programs) {
-                m_programs.emplace_back(source, name);
+                if(auto program = takeParsedProgram(source, name)) {
+                    m_programs.push_back(std::move(*program));
+                } else {
+                    m_programs.emplace_back(source, name);
+                }
             }
 
+            m_parsedPrograms.clear();
+
+            m_parsing = ProgramParsing::Complete;
+            m_compiled = false;
+        }
+
+        // the parsing mode has no default, so a braced list of sources still picks the overload above
+        void setPrograms(std::vector<Program> programs, const ProgramParsing parsing) {
+            stop();
+            m_parsedPrograms.clear();
+            m_programs = std::move(programs);
+            m_parsing = parsing;
+            m_parserErrors.clear();
+            m_statusMessages.clear();
+            m_blockMessages.clear();
             m_compiled = false;
         }
 
         template<typename Synchronize>
         void compile(Synchronize &&synchronize) {
             stop();
-            std::vector<Parser::Error> errors;
+            std::vector<Program *> pending;
+            m_compileDiagnostics = {};
 
-            for(auto &program : m_programs) {
-                auto result = program.compile();
-                if(!result) {
-                    errors.emplace_back(std::move(result.error()));
+            for(auto &program : eagerPrograms()) {
+                if(program.compiled()) {
+                    m_compileDiagnostics.reusedPrograms++;
+                } else {
+                    pending.push_back(&program);
                 }
             }
 
+            auto errors = parsePrograms(pending);
+
             for(const auto &error:errors) std::println(stderr,"ERROR: {}",error.text());
 
             synchronize([&] {
@@ -190,12 +259,9 @@ namespace ngc {
             m_pendingProgramPause = false;
             m_pendingToolChangeModalStateRestored = false;
             m_toolChangeModalCheckpoint.reset();
-            m_pendingMessage.reset();
-            m_pendingMessageBlock.reset();
+            discardPublishedEvents();
             m_executionError.reset();
             m_nextBlockExecutionId = 1;
-            m_publishedBlockLifecycle.reset();
-            m_evaluatorPaused = false;
             m_resumeEvaluator = false;
             m_executionFinished = false;
             m_stopExecution = false;
@@ -208,7 +274,7 @@ namespace ngc {
                 if (position.has_value()) {
                     m_machine.synchronizePosition(*position);
                 }
-                m_machine.memory().write(Var::TASK, taskValue(m_mode), true);
+                m_machine.memory().write<Var::TASK>(taskValue(m_mode));
             } catch(const std::exception &error) {
                 m_executionError = error.what();
                 m_executionFinished = true;
@@ -296,23 +362,24 @@ namespace ngc {
 
                 resumePausedEvaluator();
 
-                std::unique_lock lock(m_executionMutex);
-                m_executionCv.wait(lock, [&] {
-                    return m_pendingMessage || m_publishedBlockLifecycle || m_executionFinished;
+                PublishedEvent event;
+                const auto published = m_publishedEvents.waitPop(event, [&] {
+                    return m_executionFinished.load(std::memory_order_acquire);
                 });
 
-                if(m_publishedBlockLifecycle) {
-                    auto lifecycle = std::move(*m_publishedBlockLifecycle);
-                    m_publishedBlockLifecycle.reset();
-                    lock.unlock();
-                    synchronize([&] { m_pendingBlockLifecycle.emplace_back(std::move(lifecycle)); });
-                    continue;
-                }
+                if(published) {
+                    m_barrierConsumed = event.barrier;
 
-                if(m_pendingMessage) {
-                    auto message = std::move(m_pendingMessage);
-                    auto block = std::exchange(m_pendingMessageBlock, std::nullopt);
-                    lock.unlock();
+                    if(event.lifecycle) {
+                        synchronize([&] { m_pendingBlockLifecycle.emplace_back(std::move(*event.lifecycle)); });
+                        continue;
+                    }
+
+                    auto message = std::move(event.message);
+                    auto block = std::move(event.block);
+                    if(message->as<MemoryAccessMessage>()) {
+                        continue;
+                    }
                     if(message->as<SynchronizationMessage>()) {
                         m_pendingSynchronization = true;
                         return InterpreterWaitingForSynchronization {};
@@ -354,6 +421,7 @@ namespace ngc {
                     continue;
                 }
 
+                std::unique_lock lock(m_executionMutex);
                 const auto error = m_executionError;
                 lock.unlock();
                 finishExecutionThread();
@@ -398,16 +466,14 @@ namespace ngc {
                 m_resumeEvaluator = true;
             }
             m_executionCv.notify_all();
+            m_publishedEvents.notifyAll();
         }
 
         void stop() {
             requestStop();
             finishExecutionThread();
             m_executionStarted = false;
-            m_evaluatorPaused = false;
-            m_pendingMessage.reset();
-            m_pendingMessageBlock.reset();
-            m_publishedBlockLifecycle.reset();
+            discardPublishedEvents();
             m_pendingCommands.clear();
             m_pendingBlockLifecycle.clear();
             m_pendingProbe.reset();
@@ -436,8 +502,8 @@ namespace ngc {
                         const BlockExecution execution {
                             .id = m_nextBlockExecutionId++,
                             .text = statement.text(),
-                            .source = std::string(token.source()->name()),
-                            .line = token.source()->line(),
+                            .source = std::string(token.sourceName()),
+                            .line = token.line(),
                         };
                         GCodeState state;
 
@@ -512,20 +578,23 @@ namespace ngc {
                 };
 
                 const auto interrupt = [&] {
-                    std::scoped_lock lock(m_executionMutex);
-                    if(m_stopExecution) throw ExecutionStopped {};
+                    if(m_stopExecution.load(std::memory_order_acquire)) throw ExecutionStopped {};
                 };
                 Evaluator evaluator(m_machine.memory(), callback, interrupt);
                 Preamble preamble(m_machine.memory());
                 evaluator.executeFirstPass(preamble.statements());
 
-                for(const auto &program : m_programs) {
+                for(const auto &program : eagerPrograms()) {
                     evaluator.executeFirstPass(program.statements());
                 }
 
-                for(const auto &program : m_programs) {
+                for(const auto &program : eagerPrograms()) {
                     evaluator.executeSecondPass(program.statements());
                 }
+
+                if(m_parsing == ProgramParsing::Incremental && !m_programs.empty()) {
+                    evaluateIncrementally(evaluator, m_programs.back());
+                }
             } catch(const ExecutionStopped &) {
             } catch(const std::exception &error) {
                 std::scoped_lock lock(m_executionMutex);
@@ -535,40 +604,179 @@ namespace ngc {
                 m_executionError = "unknown interpreter error";
             }
 
+            m_executionFinished.store(true, std::memory_order_release);
+            m_publishedEvents.notifyAll();
+        }
+
+        static std::size_t programHash(const std::string_view text, const std::string_view name) {
+            const auto hash = std::hash<std::string_view>()(text);
+            return hash ^ (std::hash<std::string_view>()(name) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2));
+        }
+
+        // moves the compiled programs out of m_programs into the cache, replacing whatever the cache held before
+        void recycleParsedPrograms() {
+            m_parsedPrograms.clear();
+
+            for(auto &program : m_programs) {
+                if(program.compiled()) {
+                    const auto &source = program.source();
+                    const auto hash = programHash(source.text(), source.name());
+                    m_parsedPrograms.emplace(hash, std::move(program));
+                }
+            }
+
+            m_programs.clear();
+        }
+
+        std::optional<Program> takeParsedProgram(const std::string &text, const std::string &name) {
+            auto [first, last] = m_parsedPrograms.equal_range(programHash(text, name));
+
+            for(auto it = first; it != last; ++it) {
+                const auto &source = it->second.source();
+
+                if(source.text() == text && source.name() == name) {
+                    auto program = std::move(it->second);
+                    m_parsedPrograms.erase(it);
+                    return program;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // Programs are independent until evaluation, so each is parsed on its own thread. Errors come back in the
+        // order of the programs, whichever finished first.
+        std::vector<Parser::Error> parsePrograms(const std::span<Program * const> programs) {
+            std::vector<std::optional<Parser::Error>> results(programs.size());
+            std::vector<std::exception_ptr> failures(programs.size());
+            std::atomic<std::size_t> next = 0;
+            std::atomic<std::size_t> cached = 0;
+
+            const auto work = [&] {
+                for(auto i = next++; i < programs.size(); i = next++) {
+                    try {
+                        if(m_programCache && m_programCache->load(*programs[i])) {
+                            cached++;
+                            continue;
+                        }
+
+                        auto result = programs[i]->compile();
+
+                        if(!result) {
+                            results[i].emplace(std::move(result.error()));
+                        } else if(m_programCache) {
+                            // a cache that cannot be written only costs the next run its head start
+                            m_programCache->store(*programs[i]);
+                        }
+                    } catch(...) {
+                        failures[i] = std::current_exception();
+                    }
+                }
+            };
+
             {
-                std::scoped_lock lock(m_executionMutex);
-                m_executionFinished = true;
+                const auto threads = std::min<std::size_t>(programs.size(), std::max(1u, std::thread::hardware_concurrency()));
+                std::vector<std::jthread> workers;
+
+                for(std::size_t i = 1; i < threads; i++) {
+                    workers.emplace_back(work);
+                }
+
+                work();
+            }
+
+            m_compileDiagnostics.cachedPrograms = cached;
+            m_compileDiagnostics.parsedPrograms = programs.size() - cached;
+            std::vector<Parser::Error> errors;
+
+            for(std::size_t i = 0; i < programs.size(); i++) {
+                if(failures[i]) {
+                    std::rethrow_exception(failures[i]);
+                }
+
+                if(results[i]) {
+                    errors.push_back(std::move(*results[i]));
+                }
+            }
+
+            return errors;
+        }
+
+        std::span<Program> eagerPrograms() {
+            if(m_parsing == ProgramParsing::Incremental && !m_programs.empty()) {
+                return std::span(m_programs).first(m_programs.size() - 1);
+            }
+
+            return m_programs;
+        }
+
+        static void evaluateIncrementally(Evaluator &evaluator, Program &program) {
+            const auto execute = [&](const Statement *statement) {
+                const auto single = std::span(&statement, 1);
+                evaluator.executeFirstPass(single);
+                evaluator.executeSecondPass(single);
+            };
+
+            // a previous run already parsed everything, so there is nothing left to overlap with
+            if(program.compiled()) {
+                for(const auto statement : program.statements()) {
+                    execute(statement);
+                }
+
+                return;
+            }
+
+            program.restart();
+
+            for(;;) {
+                auto statement = program.next();
+
+                if(!statement) {
+                    throw std::runtime_error(statement.error().text());
+                }
+
+                if(!*statement) {
+                    return;
+                }
+
+                execute(*statement);
             }
-            m_executionCv.notify_all();
+        }
+
+        // Blocks and status output only queue up; the consumer has to catch up before the evaluator may read or
+        // write machine state again, or before it continues past a pause or a tool-change restore.
+        static bool isBarrier(const EvaluatorMessage &message) {
+            return message.as<SynchronizationMessage>() || message.as<MemoryAccessMessage>()
+                || message.as<ProgramPauseMessage>() || message.as<ToolChangeModalStateRestoredMessage>();
         }
 
         void publishMessage(std::unique_ptr<const EvaluatorMessage> message,
                             std::optional<BlockExecution> block = std::nullopt) {
-            std::unique_lock lock(m_executionMutex);
-            m_pendingMessage = std::move(message);
-            m_pendingMessageBlock = std::move(block);
-            m_evaluatorPaused = true;
-            m_executionCv.notify_all();
-            m_executionCv.wait(lock, [&] { return m_resumeEvaluator || m_stopExecution; });
+            const auto barrier = isBarrier(*message);
+            publish({ .message = std::move(message), .block = std::move(block), .barrier = barrier });
+        }
+
+        void publishBlockLifecycle(InterpreterBlockLifecycle lifecycle) {
+            publish({ .lifecycle = std::move(lifecycle) });
+        }
 
-            if(m_stopExecution) {
+        void publish(PublishedEvent event) {
+            const auto barrier = event.barrier;
+            const auto stopped = [&] { return m_stopExecution.load(std::memory_order_acquire); };
+
+            if(!m_publishedEvents.waitPush(std::move(event), stopped)) {
                 throw ExecutionStopped {};
             }
 
-            m_resumeEvaluator = false;
-            m_evaluatorPaused = false;
-        }
+            if(!barrier) {
+                return;
+            }
 
-        void publishBlockLifecycle(InterpreterBlockLifecycle lifecycle) {
             std::unique_lock lock(m_executionMutex);
-            m_publishedBlockLifecycle = std::move(lifecycle);
-            m_evaluatorPaused = true;
-            m_executionCv.notify_all();
-            m_executionCv.wait(lock, [&] { return m_resumeEvaluator || m_stopExecution; });
+            m_executionCv.wait(lock, [&] { return m_resumeEvaluator || stopped(); });
 
-            if(m_stopExecution) throw ExecutionStopped {};
+            if(stopped()) throw ExecutionStopped {};
             m_resumeEvaluator = false;
-            m_evaluatorPaused = false;
         }
 
         std::optional<InterpreterStatusMessage> processMessage(
@@ -607,12 +815,24 @@ namespace ngc {
             return std::nullopt;
         }
 
+        // called once everything the consumer took from the queue has been handed out
         void resumePausedEvaluator() {
-            std::scoped_lock lock(m_executionMutex);
-            if(m_evaluatorPaused) {
+            if(!std::exchange(m_barrierConsumed, false)) {
+                return;
+            }
+
+            {
+                std::scoped_lock lock(m_executionMutex);
                 m_resumeEvaluator = true;
-                m_executionCv.notify_all();
             }
+            m_executionCv.notify_all();
+        }
+
+        // only while no evaluation thread is running
+        void discardPublishedEvents() {
+            PublishedEvent event;
+            while(m_publishedEvents.tryPop(event)) { }
+            m_barrierConsumed = false;
         }
 
         void finishExecutionThread() {
@@ -1,31 +1,38 @@
 #pragma once
 
-#include <memory>
-#include <vector>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string>
 
 #include "memory/Memory.h"
 #include "memory/Vars.h"
+#include "parser/Program.h"
 #include "parser/Statement.h"
 
 namespace ngc {
     class Preamble {
-        std::vector<std::unique_ptr<Statement>> m_statements;
-        std::vector<const Statement *> m_ptrStatements;
+        Program m_program;
 
-    public:
-        Preamble(const Memory &mem) {
+        static std::string generate(const Memory &mem) {
             const auto &addrs = mem.addrs();
+            std::string text;
 
             for(size_t i = 0; const auto &[var, name, addr, flags, value] : gVars) {
-                auto startToken = Token::fromString(Token::Kind::ALIAS, "alias");
-                auto variable = NamedVariableExpression::fromName(std::string(name));
-                auto alias = std::make_unique<AliasStatement>(startToken, std::move(variable), LiteralExpression::fromDouble(addrs[i]));
-                m_ptrStatements.emplace_back(alias.get());
-                m_statements.emplace_back(std::move(alias));
+                text += std::format("alias #{} = {}\n", name, addrs[i]);
                 i++;
             }
+
+            return text;
+        }
+
+    public:
+        Preamble(const Memory &mem) : m_program(generate(mem), "preamble") {
+            if(auto result = m_program.compile(); !result) {
+                throw std::logic_error(std::format("failed to compile preamble: {}", result.error().text()));
+            }
         }
 
-        std::span<const Statement * const> statements() const { return m_ptrStatements; }
+        std::span<const Statement * const> statements() const { return m_program.statements(); }
     };
 }
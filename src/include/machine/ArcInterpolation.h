@@ -12,6 +12,7 @@ namespace ngc::simulation_detail {
         std::size_t constructionIntegralEvaluations = 0;
         std::size_t queries = 0;
         std::size_t endpointQueries = 0;
+        std::size_t closedFormQueries = 0;
         std::size_t exactCacheHits = 0;
         std::size_t inverseIntegralEvaluations = 0;
         std::size_t newtonIterations = 0;
@@ -40,6 +41,9 @@ namespace ngc::simulation_detail {
         std::optional<ArcGeometry> m_geometry;
         std::vector<LengthNode> m_lengthNodes;
         double m_length = 0.0;
+        // Circular arcs and constant-pitch helices have constant parametric speed, so distance is
+        // linear in the parameter and neither the length table nor the integrator is needed.
+        bool m_constantSpeed = false;
         ArcInverseDiagnostics *m_inverseDiagnostics = nullptr;
         struct InverseCacheEntry {
             double distance = 0.0;
@@ -68,6 +72,10 @@ namespace ngc::simulation_detail {
         position_t tangentAtDistance(double distance) const;
         position_t curvatureAtDistance(double distance) const;
         position_t curvatureDerivativeAtDistance(double distance) const;
+        // Evaluates the requested outputs (null pointers are skipped) with one inverse solve and
+        // one set of arm rotations instead of one per *AtDistance call.
+        void derivativesAtDistance(double distance, position_t *position, position_t *tangent,
+                                   position_t *curvature, position_t *curvatureDerivative) const;
         double chordErrorBound(double fromDistance, double toDistance) const;
         double curvatureAccelerationBound() const;
     };
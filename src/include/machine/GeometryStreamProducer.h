@@ -5,6 +5,8 @@
 #include <chrono>
 #include <cmath>
 #include <concepts>
+#include <deque>
+#include <exception>
 #include <format>
 #include <memory>
 #include <map>
@@ -13,13 +15,14 @@
 #include <set>
 #include <stdexcept>
 #include <string>
-#include <thread>
 #include <utility>
 #include <vector>
 
 #include "evaluator/InterpreterSession.h"
 #include "machine/OwningSpscChannel.h"
 #include "machine/PreparedGeometry.h"
+#include "machine/SplineHandleOptimization.h"
+#include "machine/WorkerPool.h"
 
 namespace ngc {
     inline constexpr std::size_t PREPARED_GEOMETRY_QUEUE_CAPACITY = 64;
@@ -34,6 +37,18 @@ namespace ngc {
 
     struct GeometryStreamPolicy {
         double publishNominalDuration = 0.25;
+        // Threads preparing finalized geometry windows while the producer
+        // keeps interpreting. Zero prepares every window on the producer.
+        std::size_t preparationWorkers = 2;
+        // Short source entities one all-short region may collect before the
+        // chain is ended after them as a protected split. This bounds the
+        // retained source of point-cloud style programs at the cost of a stop
+        // at the split; zero, the default, keeps the region open until a long
+        // anchor arrives.
+        std::size_t maximumShortClusterEntities = 0;
+        // Continuous windows already prepared by an earlier run, possibly at
+        // another work offset. Null prepares every window.
+        std::shared_ptr<PreparedGeometryCache> preparationCache;
         spline_detail::SplineFitSolver splineFitSolver =
             spline_detail::continuousSplineFitSolver();
         spline_detail::SplineVelocityLimits splineVelocityLimits;
@@ -50,18 +65,57 @@ namespace ngc {
         double preparedSeconds = 0.0;
         double preparationSeconds = 0.0;
         std::size_t retainedSourceHighWater = 0;
+        std::size_t preparationsInFlightHighWater = 0;
+        std::uint64_t protectedClusterSplits = 0;
         std::string lastFailure;
     };
 
+    // One finalized source window. Preparation depends only on these inputs,
+    // so it can run on any thread; the producer consumes the result.
+    struct GeometryPreparationJob {
+        std::vector<PreparedCommandRecord> window;
+        ExecutablePathMode pathMode = ExecutablePathMode::Continuous;
+        double scale = 0.001;
+        position_t start{};
+        GeometryPreparationEffort effort;
+        ContinuousGeometryBoundaries boundaries;
+        ContinuousChainId chain = 0;
+        std::shared_ptr<PreparedGeometryCache> cache;
+        std::optional<std::expected<PreparedContinuousGeometry, std::string>> result;
+        std::exception_ptr error;
+        double seconds = 0.0;
+        bool done = false;
+
+        void run() {
+            const auto started = std::chrono::steady_clock::now();
+            try {
+                result = pathMode == ExecutablePathMode::ExactStop
+                    ? prepareExactStopGeometry(window, start, effort)
+                    : cache ? cache->prepareContinuous(window, scale, start, effort, boundaries)
+                    : prepareContinuousGeometry(window, scale, start, effort, boundaries);
+            } catch(...) {
+                error = std::current_exception();
+            }
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        }
+    };
+
+    using GeometryPreparationPool = WorkerPool<GeometryPreparationJob>;
+
     // Owns all calls into the active interpreter and the shared prepared-
-    // geometry builder. It publishes only immutable NRT messages; the backend
-    // is intentionally not visible from this class.
+    // geometry builder. Finalized windows are prepared on a worker pool while
+    // interpretation continues; every message, including the slices built
+    // from those windows, is still published in interpreter order with the
+    // same sequences and piece IDs as serial preparation. It publishes only
+    // immutable NRT messages; the backend is intentionally not visible from
+    // this class.
     class GeometryStreamProducer {
         InterpreterSession &m_session;
         PreparedGeometryForwardChannel &m_forward;
         GeometryFeedbackChannel &m_feedback;
         std::atomic<bool> &m_cancelled;
         GeometryStreamPolicy m_policy;
+        GeometryPreparationPool m_preparation;
         GeometryStreamDiagnostics m_diagnostics;
         GeometryEpoch m_epoch = 0;
         GeometrySequence m_sequence = 1;
@@ -74,10 +128,30 @@ namespace ngc {
         std::optional<SynchronizationFenceId> m_pendingSynchronization;
         std::vector<BlockExecution> m_activeBlocks;
         std::vector<PreparedCommandRecord> m_continuous;
+        // Publication state. It advances only as ordered output is published,
+        // so it always reflects the interpreter order regardless of which
+        // windows have already been prepared.
         std::map<PreparedCommandId, PreparedCommandRecord> m_commandRecords;
         std::vector<PreparedPathPiece> m_pendingPieces;
         double m_pendingDuration = 0.0;
+        ContinuousChainId m_pendingChain = 0;
         std::set<PreparedCommandId> m_activatedCommands;
+
+        enum class WindowCompletion {
+            ThroughLongAnchor,
+            Publish,
+            EndChain,
+        };
+
+        struct OrderedOutput {
+            std::optional<PreparedStreamMessage> message{};
+            std::shared_ptr<GeometryPreparationJob> window{};
+            WindowCompletion completion = WindowCompletion::Publish;
+        };
+        std::deque<OrderedOutput> m_ordered;
+        std::size_t m_windowsInFlight = 0;
+
+        spline_detail::ShortEntityClusterDetector m_clusters;
         bool m_haveLongAnchor = false;
         bool m_processedLongAnchor = false;
         std::optional<double> m_continuousScale;
@@ -98,18 +172,42 @@ namespace ngc {
         }
 
         bool publish(PreparedStreamMessage message) {
+            std::visit([&](auto &value) {
+                value.epoch = m_epoch;
+                value.sequence = m_sequence++;
+            }, message);
+            const auto standalone = std::holds_alternative<PreparedStandaloneCommand>(message);
+            const auto continuousEnd = std::holds_alternative<PreparedContinuousEnd>(message);
             auto value = std::make_unique<PreparedStreamMessage>(std::move(message));
             if(!m_forward.waitPush(std::move(value), [&] { return m_cancelled.load(std::memory_order_acquire); }))
                 return false;
             ++m_diagnostics.messagesPublished;
             m_diagnostics.forwardQueueHighWater = std::max(m_diagnostics.forwardQueueHighWater,
                 m_forward.size());
+            if(standalone) ++m_diagnostics.standaloneCommandsPublished;
+            if(continuousEnd) {
+                ++m_diagnostics.continuousEndsPublished;
+                m_commandRecords.clear();
+                m_activatedCommands.clear();
+            }
+            return true;
+        }
+
+        // Publishes in interpreter order: directly when nothing is waiting
+        // for preparation, otherwise behind the windows queued before it.
+        bool emit(PreparedStreamMessage message) {
+            if(m_ordered.empty()) return publish(std::move(message));
+            m_ordered.push_back({ .message = std::move(message) });
             return true;
         }
 
+        // Only called for the oldest ordered window: everything before it is
+        // already published, and what is still ordered follows the failure in
+        // source order, so it is dropped as the serial producer never reached it.
         bool failPreparation(std::string error) {
             m_diagnostics.lastFailure = std::move(error);
-            publish(PreparedFailure{m_epoch, m_sequence++, m_diagnostics.lastFailure});
+            m_ordered.clear();
+            publish(PreparedFailure{ .error = m_diagnostics.lastFailure });
             m_cancelled.store(true, std::memory_order_release);
             return false;
         }
@@ -129,10 +227,6 @@ namespace ngc {
             }, record.command);
         }
 
-        bool isLongSource(const PreparedCommandRecord &record) const {
-            return sourceLength(record) > 6.0 * m_continuousScale.value_or(0.001);
-        }
-
         void appendPending(PreparedPathPiece piece) {
             tag(piece);
             if(piece.programmedFeed > 0.0)
@@ -142,7 +236,6 @@ namespace ngc {
 
         void pruneCommandRecords() {
             std::set<PreparedCommandId> retained;
-            for(const auto &command : m_continuous) retained.insert(command.id);
             for(const auto &piece : m_pendingPieces) {
                 retained.insert(piece.primaryCommand);
                 for(const auto &station:piece.activationStations)
@@ -157,9 +250,7 @@ namespace ngc {
         bool publishPending() {
             if(m_pendingPieces.empty()) return true;
             PreparedGeometrySlice slice;
-            slice.epoch = m_epoch;
-            slice.sequence = m_sequence++;
-            slice.chain = m_chain;
+            slice.chain = m_pendingChain;
             slice.nominalDuration = m_pendingDuration;
             slice.pieces = std::move(m_pendingPieces);
 
@@ -193,48 +284,115 @@ namespace ngc {
             return true;
         }
 
-        std::expected<PreparedContinuousGeometry, std::string> prepareWindow(
-                const bool deferFinalRetainedSection = false) {
-            const auto started = std::chrono::steady_clock::now();
-            position_t start{};
-            if(const auto value = motionStart(m_continuous.front().command)) start = *value;
-            const GeometryPreparationEffort effort{
+        bool submitWindow(const WindowCompletion completion,
+                          const bool deferFinalRetainedSection = false) {
+            auto job = std::make_shared<GeometryPreparationJob>();
+            job->window = m_continuous;
+            job->pathMode = m_geometryPathMode.value_or(ExecutablePathMode::Continuous);
+            job->scale = m_continuousScale.value_or(0.001);
+            if(const auto value = motionStart(m_continuous.front().command)) job->start = *value;
+            job->effort = {
                 .certifySourceTube = false,
                 .generateSamples = true,
                 .lengthTableIntervalsPerKnotSpan = 32,
                 .splineFitSolver = m_policy.splineFitSolver,
                 .splineVelocityLimits = m_policy.splineVelocityLimits };
-            auto prepared = m_geometryPathMode == ExecutablePathMode::ExactStop
-                ? prepareExactStopGeometry(m_continuous, start, effort)
-                : prepareContinuousGeometry(m_continuous,
-                    m_continuousScale.value_or(0.001), start, effort,
-                    ContinuousGeometryBoundaries{
-                        .incomingReplacement = m_processedLongAnchor,
-                        .deferFinalRetainedSection = deferFinalRetainedSection });
+            job->boundaries = {
+                .incomingReplacement = m_processedLongAnchor,
+                .deferFinalRetainedSection = deferFinalRetainedSection };
+            job->chain = m_chain;
+            job->cache = m_policy.preparationCache;
             m_diagnostics.retainedSourceHighWater = std::max(
                 m_diagnostics.retainedSourceHighWater, m_continuous.size());
-            m_diagnostics.preparationSeconds += std::chrono::duration<double>(
-                std::chrono::steady_clock::now() - started).count();
-            return prepared;
+            m_preparation.submit(job);
+            m_ordered.push_back({ .window = std::move(job), .completion = completion });
+            ++m_windowsInFlight;
+            m_diagnostics.preparationsInFlightHighWater = std::max(
+                m_diagnostics.preparationsInFlightHighWater, m_windowsInFlight);
+            // Bound the look-ahead so prepared output cannot pile up unpublished.
+            while(m_windowsInFlight > 2 * std::max<std::size_t>(1, m_preparation.workers()))
+                if(!publishNext(true)) return false;
+            return publishReady();
         }
 
-        bool prepareThroughLongAnchor(const PreparedCommandId nextAnchor) {
-            auto prepared = prepareWindow(true);
+        bool completeWindow(GeometryPreparationJob &job, const WindowCompletion completion) {
+            m_diagnostics.preparationSeconds += job.seconds;
+            if(job.error) std::rethrow_exception(job.error);
+            auto &prepared = *job.result;
             if(!prepared) return failPreparation(prepared.error());
+            const auto retainWindow = [&] {
+                for(const auto &record : job.window)
+                    m_commandRecords.insert_or_assign(record.id, record);
+            };
+            retainWindow();
+            m_pendingChain = job.chain;
+
+            if(completion == WindowCompletion::ThroughLongAnchor) {
+                if(prepared->pieces.empty())
+                    throw std::runtime_error("incremental geometry window produced no finalized pieces");
+                const auto outgoing = prepared->pieces.size() - 1;
+                if(prepared->pieces.back().kind != PreparedPieceKind::JunctionBlend
+                   && prepared->pieces.back().kind != PreparedPieceKind::ClusterSpline)
+                    throw std::runtime_error("incremental geometry window has no outgoing replacement before its anchor");
+
+                for(std::size_t index = 0; index < outgoing; ++index)
+                    appendPending(std::move(prepared->pieces[index]));
+
+                if(m_pendingDuration >= m_policy.publishNominalDuration && !publishPending())
+                    return false;
+                appendPending(std::move(prepared->pieces[outgoing]));
+                // publishing pruned the records the outgoing piece still needs
+                retainWindow();
+                pruneCommandRecords();
+                return true;
+            }
+
+            for(auto &piece : prepared->pieces)
+                appendPending(std::move(piece));
+            if(!publishPending()) return false;
+            if(completion == WindowCompletion::EndChain) {
+                m_commandRecords.clear();
+                m_activatedCommands.clear();
+            } else {
+                pruneCommandRecords();
+            }
+            return true;
+        }
 
-            if(prepared->pieces.empty())
-                throw std::runtime_error("incremental geometry window produced no finalized pieces");
-            const auto outgoing = prepared->pieces.size() - 1;
-            if(prepared->pieces.back().kind != PreparedPieceKind::JunctionBlend
-               && prepared->pieces.back().kind != PreparedPieceKind::ClusterSpline)
-                throw std::runtime_error("incremental geometry window has no outgoing replacement before its anchor");
+        // Publishes the oldest ordered output, waiting for its window when
+        // wait is set. Returns false once publication has failed or stopped.
+        bool publishNext(const bool wait) {
+            auto &next = m_ordered.front();
+            if(next.window) {
+                if(!wait && !m_preparation.ready(*next.window)) return true;
+                m_preparation.wait(*next.window);
+            }
+            auto output = std::move(next);
+            m_ordered.pop_front();
+            if(output.message) return publish(std::move(*output.message));
+            --m_windowsInFlight;
+            try {
+                return completeWindow(*output.window, output.completion);
+            } catch(const std::exception &error) {
+                return failPreparation(error.what());
+            }
+        }
 
-            for(std::size_t index = 0; index < outgoing; ++index)
-                appendPending(std::move(prepared->pieces[index]));
+        bool publishReady() {
+            while(!m_ordered.empty()
+                  && (!m_ordered.front().window || m_preparation.ready(*m_ordered.front().window)))
+                if(!publishNext(false)) return false;
+            return true;
+        }
 
-            if(m_pendingDuration >= m_policy.publishNominalDuration && !publishPending())
-                return false;
-            appendPending(std::move(prepared->pieces[outgoing]));
+        bool publishAll() {
+            while(!m_ordered.empty())
+                if(!publishNext(true)) return false;
+            return true;
+        }
+
+        bool prepareThroughLongAnchor(const PreparedCommandId nextAnchor) {
+            if(!submitWindow(WindowCompletion::ThroughLongAnchor, true)) return false;
 
             const auto retainedAnchor = std::ranges::find(m_continuous,
                 nextAnchor, &PreparedCommandRecord::id);
@@ -243,20 +401,13 @@ namespace ngc {
             m_continuous.erase(m_continuous.begin(), retainedAnchor);
             m_haveLongAnchor = true;
             m_processedLongAnchor = true;
-            pruneCommandRecords();
             return true;
         }
 
         bool flushContinuous() {
             if(!m_continuous.empty()) {
-                auto prepared = prepareWindow();
-                if(!prepared) return failPreparation(prepared.error());
-                for(auto &piece : prepared->pieces)
-                    appendPending(std::move(piece));
-                if(!publishPending()) return false;
+                if(!submitWindow(WindowCompletion::EndChain)) return false;
                 m_continuous.clear();
-                m_commandRecords.clear();
-                m_activatedCommands.clear();
                 m_haveLongAnchor = false;
                 m_processedLongAnchor = false;
                 m_unpreparedExactStopDuration = 0.0;
@@ -265,16 +416,15 @@ namespace ngc {
             m_continuousScale.reset();
             m_continuousPresentation.reset();
             m_geometryPathMode.reset();
-            if(!publish(PreparedContinuousEnd{m_epoch, m_sequence++, m_chain})) return false;
-            ++m_diagnostics.continuousEndsPublished;
+            if(!emit(PreparedContinuousEnd{ .chain = m_chain })) return false;
             m_chain = 0;
-            m_commandRecords.clear();
-            m_activatedCommands.clear();
             m_unpreparedExactStopDuration = 0.0;
             return true;
         }
 
         bool waitForFeedback(const auto predicate) {
+            // the consumer answers only after it has seen the barrier
+            if(!publishAll()) return false;
             while(!m_cancelled.load(std::memory_order_acquire)) {
                 PreparedFeedbackMessage feedback;
                 if(!m_feedback.waitPop(feedback, [&] { return m_cancelled.load(std::memory_order_acquire); }))
@@ -313,13 +463,9 @@ namespace ngc {
 
         bool publishStandalone(PreparedCommandRecord record) {
             PreparedStandaloneCommand standalone;
-            standalone.epoch = m_epoch;
-            standalone.sequence = m_sequence++;
             standalone.command = std::move(record);
             standalone.displayGeometry = prepareDisplayCurve(standalone.command.command);
-            if(!publish(std::move(standalone))) return false;
-            ++m_diagnostics.standaloneCommandsPublished;
-            return true;
+            return emit(std::move(standalone));
         }
 
         bool processCommand(MachineCommand command) {
@@ -344,7 +490,6 @@ namespace ngc {
                 if(!m_geometryPathMode) m_geometryPathMode = pathMode;
                 if(pathMode == ExecutablePathMode::ExactStop) {
                     if(m_chain == 0) m_chain = m_nextChain++;
-                    m_commandRecords.insert_or_assign(record.id, record);
                     const auto duration = std::visit([&](const auto &value) {
                         using T = std::decay_t<decltype(value)>;
                         if constexpr(std::same_as<T, MoveLine>)
@@ -360,14 +505,9 @@ namespace ngc {
                     m_diagnostics.retainedSourceHighWater = std::max(
                         m_diagnostics.retainedSourceHighWater, m_continuous.size());
                     if(m_unpreparedExactStopDuration >= m_policy.publishNominalDuration) {
-                        auto prepared = prepareWindow();
-                        if(!prepared) return failPreparation(prepared.error());
-                        for(auto &piece : prepared->pieces)
-                            appendPending(std::move(piece));
-                        if(!publishPending()) return false;
+                        if(!submitWindow(WindowCompletion::Publish)) return false;
                         m_continuous.clear();
                         m_unpreparedExactStopDuration = 0.0;
-                        pruneCommandRecords();
                     }
                     return true;
                 }
@@ -390,13 +530,19 @@ namespace ngc {
                     m_continuousScale = scale;
                     m_continuousPresentation = record.presentation;
                 }
-                m_commandRecords.insert_or_assign(record.id, record);
+                if(m_continuous.empty())
+                    m_clusters = spline_detail::ShortEntityClusterDetector(
+                        scale, m_policy.maximumShortClusterEntities);
                 const auto commandId = record.id;
-                const auto longSource = isLongSource(record);
+                const auto boundary = m_clusters.push(sourceLength(record));
                 m_continuous.push_back(std::move(record));
                 m_diagnostics.retainedSourceHighWater = std::max(
                     m_diagnostics.retainedSourceHighWater, m_continuous.size());
-                if(longSource) {
+                if(boundary.protectedSplit) {
+                    ++m_diagnostics.protectedClusterSplits;
+                    return flushContinuous();
+                }
+                if(boundary.longEntity) {
                     if(!m_haveLongAnchor) m_haveLongAnchor = true;
                     else if(!prepareThroughLongAnchor(commandId)) return false;
                 }
@@ -414,7 +560,8 @@ namespace ngc {
                                std::atomic<bool> &cancelled,
                                GeometryStreamPolicy policy = {})
             : m_session(session), m_forward(forward), m_feedback(feedback),
-              m_cancelled(cancelled), m_policy(policy) { }
+              m_cancelled(cancelled), m_policy(policy),
+              m_preparation(m_policy.preparationWorkers) { }
 
         GeometryStreamProducer(const GeometryStreamProducer &) = delete;
         GeometryStreamProducer &operator=(const GeometryStreamProducer &) = delete;
@@ -432,12 +579,12 @@ namespace ngc {
                         else if(const auto found = std::ranges::find_if(m_activeBlocks,
                                 [&](const auto &block) { return block.id == lifecycle->block.id; });
                                 found != m_activeBlocks.end()) m_activeBlocks.erase(found);
-                        if(!publish(PreparedBlockLifecycleMessage{m_epoch, m_sequence++, *lifecycle})) return false;
+                        if(!emit(PreparedBlockLifecycleMessage{ .lifecycle = *lifecycle })) return false;
                     } else if(const auto *command = std::get_if<MachineCommand>(&event)) {
                         if(const auto *probe = std::get_if<ProbeMove>(command)) {
                             if(!flushContinuous()) return false;
                             if(!publishStandalone(makeRecord(*command))) return false;
-                            if(!publish(PreparedProbeFence{m_epoch, m_sequence++, probe->id()})) return false;
+                            if(!emit(PreparedProbeFence{ .commandId = probe->id() })) return false;
                             m_pendingProbe = *probe;
                             if(!waitForFeedback([&](const GeometryFeedback &feedback) {
                                 const auto *result = std::get_if<DeliverProbeResult>(&feedback);
@@ -450,7 +597,7 @@ namespace ngc {
                     } else if(std::holds_alternative<InterpreterWaitingForSynchronization>(event)) {
                         if(!flushContinuous()) return false;
                         const auto fence = m_nextFence++;
-                        if(!publish(PreparedSynchronizationFence{m_epoch, m_sequence++, fence})) return false;
+                        if(!emit(PreparedSynchronizationFence{ .fence = fence })) return false;
                         m_pendingSynchronization = fence;
                         if(!waitForFeedback([&](const GeometryFeedback &feedback) {
                             const auto *release = std::get_if<ReleaseSynchronization>(&feedback);
@@ -463,9 +610,7 @@ namespace ngc {
                             return false;
                         }
                         const auto pause = m_nextPause++;
-                        if (!publish(PreparedProgramPause {
-                                m_epoch, m_sequence++, pause
-                            })) {
+                        if (!emit(PreparedProgramPause { .pause = pause })) {
                             return false;
                         }
                         if (!waitForFeedback([&](const GeometryFeedback &feedback) {
@@ -479,9 +624,7 @@ namespace ngc {
                         m_session.provideProgramResume();
                     } else if (const auto *status =
                                    std::get_if<InterpreterStatusMessage>(&event)) {
-                        if (!publish(PreparedStatusMessage {
-                                m_epoch, m_sequence++, *status
-                            })) {
+                        if (!emit(PreparedStatusMessage { .status = *status })) {
                             return false;
                         }
                     } else if (std::holds_alternative<
@@ -489,29 +632,32 @@ namespace ngc {
                         if (!flushContinuous()) {
                             return false;
                         }
-                        if (!publish(PreparedPresentationUpdate {
-                                m_epoch, m_sequence++, capturePresentation()
+                        if (!emit(PreparedPresentationUpdate {
+                                .presentation = capturePresentation()
                             })) {
                             return false;
                         }
                     } else if(const auto *error = std::get_if<InterpreterError>(&event)) {
                         m_diagnostics.lastFailure = error->message;
-                        publish(PreparedFailure{m_epoch, m_sequence++, error->message});
+                        if(emit(PreparedFailure{ .error = error->message })) publishAll();
                         return false;
                     } else if(std::holds_alternative<InterpreterCompleted>(event)) {
                         if(!flushContinuous()) return false;
-                        if(!publish(PreparedProgramEnd{m_epoch, m_sequence++})) return false;
-                        return true;
+                        if(!emit(PreparedProgramEnd{})) return false;
+                        return publishAll();
                     } else if(const auto *waiting = std::get_if<InterpreterWaitingForProbe>(&event)) {
                         m_diagnostics.lastFailure = std::format(
                             "probe barrier {} was not preceded by its probe command", waiting->commandId);
-                        publish(PreparedFailure{m_epoch, m_sequence++, m_diagnostics.lastFailure});
+                        if(emit(PreparedFailure{ .error = m_diagnostics.lastFailure })) publishAll();
                         return false;
                     }
+                    if(!publishReady()) return false;
                 }
             } catch(const std::exception &error) {
+                // Window failures are reported where the window is published,
+                // so everything still ordered precedes this one and goes first.
                 m_diagnostics.lastFailure = error.what();
-                publish(PreparedFailure{m_epoch, m_sequence++, m_diagnostics.lastFailure});
+                if(emit(PreparedFailure{ .error = m_diagnostics.lastFailure })) publishAll();
                 return false;
             }
         }
@@ -1765,14 +1765,15 @@ private:
 
             const auto copyTimingSnapshot = [&] {
                 copyRuntimeTimingSnapshot();
-                m_snapshot.trajectoryPlanningActivity=m_machineSession.driver().planningActivity();
-                m_snapshot.trajectoryPlanningActivitySeconds=
-                    m_machineSession.driver().planningActivitySeconds();
-                m_snapshot.trajectoryDriverActivity=m_machineSession.driver().activity();
+                auto planning=m_machineSession.driver().planningObservation();
+                m_snapshot.trajectoryDriverActivity=m_machineSession.driver().activity(planning);
+                m_snapshot.trajectoryPlanning=planning.diagnostics;
+                m_snapshot.trajectoryPlanningActivity=std::move(planning.planningActivity);
+                m_snapshot.trajectoryPlanningActivitySeconds=planning.planningActivitySeconds;
                 m_snapshot.trajectoryContinuousPlanSummary=
-                    m_machineSession.driver().lastContinuousPlanSummary();
+                    std::move(planning.lastContinuousPlanSummary);
                 m_snapshot.trajectoryContinuousCorrectionHistory=
-                    m_machineSession.driver().lastContinuousCorrectionHistory();
+                    std::move(planning.lastContinuousCorrectionHistory);
             };
             auto nextPlanningRefresh=clock::now();
             m_machineSession.driver().setPlanningProgressCallback([&] {
@@ -1990,7 +1991,6 @@ private:
                 }
 
                 const auto filled = operation.pumped > 0;
-                m_snapshot.trajectoryPlanning = m_machineSession.driver().planningDiagnostics();
                 copyTimingSnapshot();
                 m_runtime.releaseRefillOpportunity();
                 m_runtime.setRollingSupplyActive(
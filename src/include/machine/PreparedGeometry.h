@@ -1,14 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <concepts>
+#include <cstddef>
 #include <expected>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -93,6 +98,10 @@ namespace ngc {
         // consumers still certify inverse queries against the curve.
         std::vector<double> parameters;
         std::vector<double> distances;
+        // Optional |q'| at each table parameter. With it every bracket holds a
+        // monotone cubic Hermite surrogate of parameter(distance) that seeds
+        // the certified inverse, usually leaving one Newton correction.
+        std::vector<double> speeds;
         double maximumSecondDerivative = 0.0;
     };
 
@@ -105,12 +114,53 @@ namespace ngc {
         bool geometricallyLinear = false;
     };
 
+    // Per-curve evaluation state indexed by the immutable curve it belongs to.
+    // Lookup cost is independent of how many curves a window evaluates; once
+    // the capacity is reached the least recently used curve's entry is evicted,
+    // so long-lived workspaces stay bounded. Entries are keyed by address: a
+    // curve must outlive its entry or the workspace must be cleared.
+    template<typename Entry>
+    class CurveEntryCache {
+        std::list<Entry> m_entries;
+        std::unordered_map<const PreparedCurve *,
+                           typename std::list<Entry>::iterator> m_index;
+        std::size_t m_capacity;
+
+    public:
+        explicit CurveEntryCache(const std::size_t capacity) : m_capacity(std::max<std::size_t>(1, capacity)) { }
+
+        Entry *find(const PreparedCurve &curve) {
+            // consecutive queries usually stay on one curve
+            if(!m_entries.empty() && m_entries.front().curve == &curve) return &m_entries.front();
+            const auto found = m_index.find(&curve);
+            if(found == m_index.end()) return nullptr;
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return &m_entries.front();
+        }
+
+        Entry &insert(Entry entry) {
+            if(m_entries.size() >= m_capacity) {
+                m_index.erase(m_entries.back().curve);
+                m_entries.pop_back();
+            }
+            m_entries.push_front(std::move(entry));
+            m_index.insert_or_assign(m_entries.front().curve, m_entries.begin());
+            return m_entries.front();
+        }
+
+        std::size_t size() const { return m_entries.size(); }
+        std::size_t capacity() const { return m_capacity; }
+        void clear() { m_entries.clear(); m_index.clear(); }
+    };
+
     struct CurveEvaluationWorkspace {
+        static constexpr std::size_t DEFAULT_MAX_CACHED_CURVES = 1024;
+
         struct ArcEntry {
             const PreparedCurve *curve = nullptr;
             std::unique_ptr<simulation_detail::ArcReference> reference;
         };
-        std::vector<ArcEntry> arcs;
+        CurveEntryCache<ArcEntry> arcs;
 
         struct SplineInverseCacheEntry {
             double distance = 0.0;
@@ -121,7 +171,17 @@ namespace ngc {
             const PreparedCurve *curve = nullptr;
             std::array<SplineInverseCacheEntry, 16> inverseCache{};
         };
-        std::vector<SplineEntry> splines;
+        CurveEntryCache<SplineEntry> splines;
+
+        struct SplineInverseDiagnostics {
+            std::size_t queries = 0;
+            std::size_t surrogateSeeds = 0;
+            std::size_t integralEvaluations = 0;
+        };
+        SplineInverseDiagnostics splineInverse;
+
+        explicit CurveEvaluationWorkspace(const std::size_t maxCachedCurves = DEFAULT_MAX_CACHED_CURVES)
+            : arcs(maxCachedCurves), splines(maxCachedCurves) { }
 
         void clear() { arcs.clear(); splines.clear(); }
     };
@@ -140,6 +200,24 @@ namespace ngc {
                                               std::size_t splineParameterSpan);
     double chordErrorBound(const PreparedCurve &curve, double fromDistance,
                            double toDistance, CurveEvaluationWorkspace &workspace);
+
+    // Destinations of evaluateAtDistances(). A non-empty span receives one
+    // value per requested distance; an empty span is not evaluated.
+    struct CurveEvaluationOutputs {
+        std::span<position_t> positions{};
+        std::span<position_t> tangents{};
+        std::span<position_t> curvatures{};
+        std::span<position_t> curvatureDerivatives{};
+    };
+
+    // Batched positionAtDistance() .. curvatureDerivativeAtDistance() with
+    // identical results. The curve is dispatched once, every distance is
+    // inverted once for all requested outputs, and spline length tables are
+    // walked forward while the distances do not decrease.
+    void evaluateAtDistances(const PreparedCurve &curve, std::span<const double> distances,
+                             const CurveEvaluationOutputs &outputs,
+                             CurveEvaluationWorkspace &workspace,
+                             std::optional<std::size_t> splineParameterSpan = std::nullopt);
     std::shared_ptr<const PreparedCurve> prepareDisplayCurve(const MachineCommand &command);
 
     struct PreparedGeometryBoundary {
@@ -163,6 +241,157 @@ namespace ngc {
         position_t curvatureDerivative{};
     };
 
+    // Read-only view of columnar geometric samples. Column 0 holds distances;
+    // columns 1-6, 7-12 and 13-18 hold the X..C components of tangent,
+    // curvature and curvature derivative. Each column is contiguous, so a
+    // reduction over one component streams a single array.
+    class PreparedGeometricSampleView {
+    public:
+        static constexpr std::size_t COLUMNS = 19;
+
+    private:
+        const double *m_values = nullptr;
+        std::size_t m_stride = 0;
+        std::size_t m_size = 0;
+
+        static position_t component(const double *values, const std::size_t stride,
+                                    const std::size_t firstColumn, const std::size_t index) {
+            const auto *column = values + firstColumn * stride + index;
+            return { column[0], column[stride], column[2 * stride],
+                     column[3 * stride], column[4 * stride], column[5 * stride] };
+        }
+
+        static PreparedGeometricSample sample(const double *values, const std::size_t stride,
+                                              const std::size_t index) {
+            return { values[index], component(values, stride, 1, index),
+                     component(values, stride, 7, index), component(values, stride, 13, index) };
+        }
+
+    public:
+        class iterator {
+            const double *m_values = nullptr;
+            std::size_t m_stride = 0;
+            std::size_t m_index = 0;
+
+        public:
+            using value_type = PreparedGeometricSample;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            iterator(const double *values, const std::size_t stride, const std::size_t index)
+                : m_values(values), m_stride(stride), m_index(index) { }
+
+            PreparedGeometricSample operator*() const { return sample(m_values, m_stride, m_index); }
+            iterator &operator++() { ++m_index; return *this; }
+            iterator operator++(int) { auto previous = *this; ++m_index; return previous; }
+            bool operator==(const iterator &other) const { return m_index == other.m_index; }
+        };
+
+        PreparedGeometricSampleView() = default;
+        PreparedGeometricSampleView(const double *values, const std::size_t stride, const std::size_t size)
+            : m_values(values), m_stride(stride), m_size(size) { }
+
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        PreparedGeometricSample operator[](const std::size_t index) const { return sample(m_values, m_stride, index); }
+        PreparedGeometricSample front() const { return (*this)[0]; }
+        PreparedGeometricSample back() const { return (*this)[m_size - 1]; }
+        iterator begin() const { return { m_values, m_stride, 0 }; }
+        iterator end() const { return { m_values, m_stride, m_size }; }
+
+        PreparedGeometricSampleView subview(const std::size_t offset, const std::size_t count) const {
+            return { m_values + offset, m_stride, count };
+        }
+
+        std::span<const double> distances() const { return { m_values, m_size }; }
+        std::span<const double> tangents(const std::size_t axis) const { return column(1 + axis); }
+        std::span<const double> curvatures(const std::size_t axis) const { return column(7 + axis); }
+        std::span<const double> curvatureDerivatives(const std::size_t axis) const { return column(13 + axis); }
+        std::span<const double> column(const std::size_t column) const {
+            return { m_values + column * m_stride, m_size };
+        }
+    };
+
+    // Owning columnar sample store of one prepared piece. All columns share a
+    // single allocation sized by the capacity.
+    class PreparedGeometricSamples {
+        std::vector<double> m_values;
+        std::size_t m_size = 0;
+        std::size_t m_capacity = 0;
+
+        void reallocate(const std::size_t capacity) {
+            std::vector<double> values(PreparedGeometricSampleView::COLUMNS * capacity);
+            for(std::size_t column = 0; column < PreparedGeometricSampleView::COLUMNS; ++column)
+                std::copy_n(m_values.data() + column * m_capacity, m_size,
+                            values.data() + column * capacity);
+            m_values = std::move(values);
+            m_capacity = capacity;
+        }
+
+        void store(const std::size_t index, const PreparedGeometricSample &sample) {
+            auto *values = m_values.data() + index;
+            values[0] = sample.distance;
+            const std::array components { &sample.tangent, &sample.curvature, &sample.curvatureDerivative };
+            for(std::size_t vector = 0; vector < components.size(); ++vector) {
+                auto *column = values + (1 + 6 * vector) * m_capacity;
+                const auto &value = *components[vector];
+                column[0] = value.x; column[m_capacity] = value.y; column[2 * m_capacity] = value.z;
+                column[3 * m_capacity] = value.a; column[4 * m_capacity] = value.b; column[5 * m_capacity] = value.c;
+            }
+        }
+
+    public:
+        PreparedGeometricSampleView view() const { return { m_values.data(), m_capacity, m_size }; }
+        operator PreparedGeometricSampleView() const { return view(); }
+
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        PreparedGeometricSample operator[](const std::size_t index) const { return view()[index]; }
+        PreparedGeometricSample front() const { return view().front(); }
+        PreparedGeometricSample back() const { return view().back(); }
+        PreparedGeometricSampleView::iterator begin() const { return view().begin(); }
+        PreparedGeometricSampleView::iterator end() const { return view().end(); }
+        PreparedGeometricSampleView subview(const std::size_t offset, const std::size_t count) const {
+            return view().subview(offset, count);
+        }
+
+        std::span<const double> distances() const { return view().distances(); }
+        std::span<double> distances() { return { m_values.data(), m_size }; }
+        std::span<const double> tangents(const std::size_t axis) const { return view().tangents(axis); }
+        std::span<const double> curvatures(const std::size_t axis) const { return view().curvatures(axis); }
+        std::span<const double> curvatureDerivatives(const std::size_t axis) const {
+            return view().curvatureDerivatives(axis);
+        }
+
+        void reserve(const std::size_t capacity) {
+            if(capacity > m_capacity) reallocate(capacity);
+        }
+
+        void push_back(const PreparedGeometricSample &sample) {
+            if(m_size == m_capacity) reallocate(std::max<std::size_t>(2, 2 * m_capacity));
+            store(m_size++, sample);
+        }
+
+        // Shrinking keeps the leading samples; growing appends default samples.
+        void resize(const std::size_t size) {
+            reserve(size);
+            for(auto index = m_size; index < size; ++index) store(index, {});
+            m_size = size;
+        }
+
+        void clear() { m_size = 0; }
+
+        // Drops the leading samples, keeping the rest in order.
+        void eraseFront(const std::size_t count) {
+            const auto removed = std::min(count, m_size);
+            for(std::size_t column = 0; column < PreparedGeometricSampleView::COLUMNS; ++column) {
+                auto *values = m_values.data() + column * m_capacity;
+                std::copy(values + removed, values + m_size, values);
+            }
+            m_size -= removed;
+        }
+    };
+
     // Sixteen subintervals balance curved-path constraint coverage with the
     // cost of PathTempo's sampled coupled-limit refinement.
     inline constexpr std::size_t PREPARED_CURVE_SAMPLE_INTERVALS=16;
@@ -215,7 +444,7 @@ namespace ngc {
         // cluster spline. Preview uses these immutable prepared curves to show
         // the replaced geometry without reconstructing it independently.
         std::vector<PreparedSourceInterval> replacedSourceIntervals;
-        std::vector<PreparedGeometricSample> geometricSamples;
+        PreparedGeometricSamples geometricSamples;
         // Continuous timing treats every spline knot interval as one timing
         // interval and requires its prepared samples and feed. For cluster
         // splines the piece-wide programmedFeed remains presentation metadata.
@@ -420,4 +649,62 @@ namespace ngc {
         std::span<const PreparedCommandRecord> commands,
         position_t expectedStart = {},
         const GeometryPreparationEffort &effort = {});
+
+    struct PreparedGeometryCacheDiagnostics {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        // Hits whose window started elsewhere, so the cached curves were translated.
+        std::uint64_t translatedHits = 0;
+        // Misses whose key matched a cached window with different source
+        // coordinates; the window is prepared again and the entry kept.
+        std::uint64_t mismatchedKeys = 0;
+    };
+
+    // Content-addressed prepareContinuousGeometry() results shared across runs.
+    // A window is keyed by its source commands relative to the expected start,
+    // the blend scale, the preparation effort and the open boundaries. Relative
+    // coordinates are keyed on a grid of a millionth of the blend scale so a
+    // decimal work offset still finds its window; a hit is then only served if
+    // the cached source commands translate onto the requested ones within
+    // half the planner's 1e-12 continuity tolerance. Every other value is
+    // compared exactly.
+    // Preparation is deterministic and translation
+    // invariant, so a hit translates the cached curves to the new start and
+    // renames the cached command IDs to the window's, in source order, instead
+    // of reconstructing splines. Samples and knot intervals are reused as is.
+    // Safe for concurrent use; the least recently used window is evicted once
+    // the capacity is reached. Failed preparations are not cached.
+    class PreparedGeometryCache {
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 256;
+
+        explicit PreparedGeometryCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+        PreparedGeometryCache(const PreparedGeometryCache &) = delete;
+        PreparedGeometryCache &operator=(const PreparedGeometryCache &) = delete;
+
+        std::expected<PreparedContinuousGeometry, std::string> prepareContinuous(
+            std::span<const PreparedCommandRecord> commands, double blendScale,
+            position_t expectedStart = {},
+            const GeometryPreparationEffort &effort = {},
+            const ContinuousGeometryBoundaries &boundaries = {});
+
+        PreparedGeometryCacheDiagnostics diagnostics() const;
+        std::size_t size() const;
+        void clear();
+
+    private:
+        struct Entry {
+            std::string key;
+            position_t origin{};
+            std::shared_ptr<const PreparedContinuousGeometry> prepared;
+        };
+
+        mutable std::mutex m_mutex;
+        std::list<Entry> m_entries;
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;
+        std::size_t m_capacity;
+        PreparedGeometryCacheDiagnostics m_diagnostics;
+    };
 }
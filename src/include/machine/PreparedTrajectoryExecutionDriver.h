@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <concepts>
+#include <deque>
 #include <format>
 #include <functional>
 #include <memory>
@@ -10,6 +11,7 @@
 #include <utility>
 
 #include "machine/TrajectoryPlanner.h"
+#include "machine/TrajectoryPlanningStage.h"
 #include "machine/GeometryStreamProducer.h"
 #include "machine/MotionBackend.h"
 #include "machine/ExecutorDemandController.h"
@@ -17,21 +19,28 @@
 namespace ngc {
     enum class PreparedDriverState { Running, ProgramPaused, Completed, Error };
 
-    // Planning owner for the split pipeline. It has no InterpreterSession
-    // reference: barrier results travel back through GeometryFeedbackChannel.
+    // Backend owner for the split pipeline. Planning runs in a
+    // TrajectoryPlanningStage, on its own NRT thread when pipelined, and the
+    // driver only publishes its batches and observes backend events. It has
+    // no InterpreterSession reference: barrier results travel back through
+    // GeometryFeedbackChannel.
     class PreparedTrajectoryExecutionDriver {
         MotionBackend &m_backend;
         ExecutorDemandController &m_demand;
         PreparedGeometryForwardChannel &m_forward;
         GeometryFeedbackChannel &m_feedback;
         std::atomic<bool> &m_cancelled;
-        TrajectoryPlanner m_planner;
         std::unique_ptr<PlannedExecution> m_pending;
         std::size_t m_pendingItem = 0;
-        std::optional<PreparedStreamMessage> m_deferredMessage;
         std::optional<TrajectoryCommandPresentation> m_presentationUpdate;
         std::optional<std::string> m_error;
         std::size_t m_outstandingChunks = 0;
+        // Normal-motion seconds of published items the backend has not
+        // retired, oldest first.
+        std::deque<std::pair<ChunkId, double>> m_queuedMotion;
+        double m_queuedMotionSeconds = 0.0;
+        bool m_rollingContinuation = false;
+        bool m_pipelinedPlanning = false;
         bool m_forwardComplete = false;
         bool m_probePending = false;
         std::optional<std::uint64_t> m_probeFence;
@@ -40,8 +49,9 @@ namespace ngc {
         bool m_waitingForHeld = false;
         bool m_exactStopHeld = false;
         GeometryEpoch m_epoch = 0;
-        GeometrySequence m_nextSequence = 1;
         bool m_backendReady = false;
+        // last, so its planning thread stops before the driver state it feeds
+        TrajectoryPlanningStage m_planning;
 
         void fail(std::string message) {
             if(m_error) return;
@@ -75,104 +85,65 @@ namespace ngc {
             }
         }
 
-        static TrajectoryPlannerInput inputFrom(const PreparedCommandRecord &record) {
-            return { record.command, record.metadata, record.presentation,
-                     record.presentationActivation, record.continuousScaleOverride };
+        static double normalMotionSeconds(const ExecutionItem &item) {
+            const auto *chunk = std::get_if<PlanChunk>(&item);
+            if(!chunk) return 0.0;
+            auto seconds = 0.0;
+            for(const auto &span : chunk->normalMotion) seconds += std::max(span.duration, 0.0);
+            return seconds;
         }
 
-        bool validateSequence(const PreparedStreamMessage &message) {
-            const auto [epoch, sequence] = std::visit([](const auto &value) {
-                return std::pair { value.epoch, value.sequence };
-            }, message);
-            if(epoch != m_epoch)
-                return (fail(std::format("prepared geometry message has stale epoch {} expected {}",
-                    epoch, m_epoch)), false);
-            if(sequence != m_nextSequence)
-                return (fail(std::format("prepared geometry sequence gap or duplicate: received {} expected {}",
-                    sequence, m_nextSequence)), false);
-            ++m_nextSequence;
-            return true;
+        void retire(const ChunkId chunk) {
+            const auto found = std::ranges::find(m_queuedMotion, chunk, &std::pair<ChunkId, double>::first);
+            if(found == m_queuedMotion.end()) return;
+            for(auto entry = m_queuedMotion.begin(); entry != std::next(found); ++entry)
+                m_queuedMotionSeconds -= entry->second;
+            m_queuedMotion.erase(m_queuedMotion.begin(), std::next(found));
+            if(m_queuedMotion.empty()) m_queuedMotionSeconds = 0.0;
         }
 
-        bool publishPlanned(std::unique_ptr<PlannedExecution> planned) {
-            if(!planned || planned->items.empty()) {
+        bool acceptPlanned(PlannedBatch planned) {
+            if(!planned.execution || planned.execution->items.empty()) {
                 fail("prepared trajectory planner produced an empty execution packet batch");
                 return false;
             }
-            m_pending = std::move(planned);
+            m_pending = std::move(planned.execution);
             m_pendingItem = 0;
+            m_rollingContinuation = planned.rollingContinuation;
             return true;
         }
 
-        bool planWindow(const bool allowTerminalStop = true) {
-            auto planned = m_planner.planWindow(allowTerminalStop);
-            if(!planned) {
-                fail(planned.error());
-                return false;
-            }
-            if(*planned) return publishPlanned(std::move(*planned));
-            return true;
-        }
-
-        bool appendSlice(const PreparedGeometrySlice &slice) {
-            if(!m_planner.enqueuePrepared(slice)) {
-                fail("prepared trajectory planner rejected a geometry slice: "
-                    +m_planner.lastPreparedEnqueueError());
+        bool processPlanned(PlanningStageMessage message,
+                            auto &&observeLifecycle, auto &&observeStatus) {
+            if(auto *planned = std::get_if<PlannedBatch>(&message))
+                return acceptPlanned(std::move(*planned));
+            if(auto *failure = std::get_if<PlanningStageFailure>(&message)) {
+                fail(std::move(failure->error));
                 return false;
             }
-            if(m_planner.shouldPlanRollingPrefix()) return planWindow(false);
-            return true;
+            return processMessage(std::move(std::get<PreparedStreamMessage>(message)),
+                std::forward<decltype(observeLifecycle)>(observeLifecycle),
+                std::forward<decltype(observeStatus)>(observeStatus));
         }
 
+        // Messages the planning stage forwarded at their ordered boundary;
+        // every batch planned before them has already been published.
         bool processMessage(PreparedStreamMessage message,
-                            auto &&observeLifecycle, auto &&observeStatus,
-                            const bool sequenceAlreadyValidated = false) {
-            if(!sequenceAlreadyValidated && !validateSequence(message)) return false;
+                            auto &&observeLifecycle, auto &&observeStatus) {
             return std::visit([&](auto &&value) -> bool {
                 using T = std::decay_t<decltype(value)>;
-                if constexpr(std::same_as<T, PreparedGeometrySlice>) {
-                    if(m_planner.windowSize()!=0&&m_planner.preparedChainEnded()) {
-                        m_deferredMessage=std::move(message);
-                        return planWindow();
-                    }
-                    if(!appendSlice(value)) {
-                        m_deferredMessage = std::move(message);
-                        return planWindow();
-                    }
-                    return true;
-                } else if constexpr(std::same_as<T, PreparedStandaloneCommand>) {
-                    if(m_planner.windowSize() != 0) {
-                        m_deferredMessage = std::move(message);
-                        return planWindow();
-                    }
-                    auto input = inputFrom(value.command);
-                    if(!m_planner.enqueue(std::move(input))) {
-                        fail("bounded prepared lookahead rejected a standalone command");
-                        return false;
-                    }
-                    return planWindow();
-                } else if constexpr(std::same_as<T, PreparedContinuousEnd>) {
-                    if(!m_planner.endPreparedChain(value.chain)) {
-                        fail("prepared trajectory planner received an end for the wrong geometry chain");
-                        return false;
-                    }
-                    return planWindow();
-                } else if constexpr(std::same_as<T, PreparedBlockLifecycleMessage>) {
+                if constexpr(std::same_as<T, PreparedBlockLifecycleMessage>) {
                     if constexpr(!std::same_as<std::remove_cvref_t<decltype(observeLifecycle)>,
                                                std::nullptr_t>)
                         observeLifecycle(value.lifecycle);
                     return true;
                 } else if constexpr(std::same_as<T, PreparedSynchronizationFence>) {
-                    if(m_planner.windowSize() != 0 && !planWindow()) return false;
                     m_synchronizationFence = value.fence;
                     return releaseSynchronizationIfHeld();
                 } else if constexpr(std::same_as<T, PreparedProbeFence>) {
                     m_probeFence = value.commandId;
                     return true;
                 } else if constexpr (std::same_as<T, PreparedProgramPause>) {
-                    if (m_planner.windowSize() != 0 && !planWindow()) {
-                        return false;
-                    }
                     m_programPause = value.pause;
                     return true;
                 } else if constexpr(std::same_as<T, PreparedStatusMessage>) {
@@ -181,8 +152,7 @@ namespace ngc {
                         observeStatus(value.status);
                     return true;
                 } else if constexpr (std::same_as<T, PreparedPresentationUpdate>) {
-                    if (m_pending || m_planner.windowSize() != 0
-                        || m_synchronizationFence || m_probePending) {
+                    if (m_pending || m_synchronizationFence || m_probePending) {
                         fail("tool-change modal presentation was restored before its ordered boundary");
                         return false;
                     }
@@ -193,19 +163,20 @@ namespace ngc {
                     m_presentationUpdate = std::move(value.presentation);
                     return true;
                 } else if constexpr(std::same_as<T, PreparedProgramEnd>) {
-                    if(m_planner.windowSize() != 0 && !planWindow()) return false;
                     m_forwardComplete = true;
                     return true;
                 } else if constexpr(std::same_as<T, PreparedFailure>) {
                     fail(value.error);
                     return false;
+                } else {
+                    fail("trajectory planning stage forwarded a geometry message");
+                    return false;
                 }
             }, std::move(message));
         }
 
         bool releaseSynchronizationIfHeld() {
-            if(!m_synchronizationFence || m_pending || m_outstandingChunks != 0
-               || m_planner.windowSize() != 0) return true;
+            if(!m_synchronizationFence || m_pending || m_outstandingChunks != 0) return true;
             if(!m_feedback.tryPush(std::make_unique<const GeometryFeedback>(
                     ReleaseSynchronization{m_epoch, *m_synchronizationFence}))) {
                 fail("geometry feedback queue is full while releasing synchronization");
@@ -223,16 +194,19 @@ namespace ngc {
                                           std::atomic<bool> &cancelled,
                                           TrajectoryLimits limits = {})
             : m_backend(backend), m_demand(demand), m_forward(forward), m_feedback(feedback),
-              m_cancelled(cancelled), m_planner(limits) { }
+              m_cancelled(cancelled), m_planning(forward, cancelled, limits) { }
 
         bool begin(const GeometryEpoch epoch = 1, const position_t &position = {}) {
             m_backend.discardPendingOutput();
+            m_planning.stop();
             m_pending.reset();
             m_pendingItem = 0;
-            m_deferredMessage.reset();
             m_presentationUpdate.reset();
             m_error.reset();
             m_outstandingChunks = 0;
+            m_queuedMotion.clear();
+            m_queuedMotionSeconds = 0.0;
+            m_rollingContinuation = false;
             m_forwardComplete = false;
             m_probePending = false;
             m_probeFence.reset();
@@ -242,31 +216,42 @@ namespace ngc {
             m_exactStopHeld = false;
             m_backendReady = false;
             m_epoch = epoch;
-            m_nextSequence = 1;
-            m_planner.clearDiagnostics();
-            m_planner.reset(epoch, position);
             m_backendReady = m_demand.request(
                 epoch, ExecutorDemandMode::Run);
+            if(m_backendReady) m_planning.begin(epoch, position, m_pipelinedPlanning);
 
             return m_backendReady;
         }
 
-        void setLimits(const TrajectoryLimits &limits) { m_planner.setLimits(limits); }
+        // Stops the planning thread; called once the geometry producer is
+        // joined and before the forward channel is drained.
+        void finish() { m_planning.stop(); }
+
+        // Plan on a dedicated NRT thread from the next begin(). Without it
+        // pumpOne() plans inline, so a long horizon compile delays refill.
+        void setPipelinedPlanning(const bool enabled) { m_pipelinedPlanning = enabled; }
+        bool pipelinedPlanning() const { return m_pipelinedPlanning; }
+
+        void setLimits(const TrajectoryLimits &limits) { m_planning.setLimits(limits); }
         void setContinuousPlanningEffort(const ContinuousPlanningEffort &effort) {
-            m_planner.setContinuousPlanningEffort(effort);
+            m_planning.setContinuousPlanningEffort(effort);
         }
         void setContinuousDiagnosticCallback(std::function<void(
                 const ContinuousTrajectoryPlan &,
                 std::span<const TrajectoryPlannerInput>)> callback) {
-            m_planner.setContinuousDiagnosticCallback(std::move(callback));
+            m_planning.setContinuousDiagnosticCallback(std::move(callback));
         }
+        // Invoked during inline planning only; a pipelined driver stays
+        // responsive and its observers poll instead.
         void setPlanningProgressCallback(std::function<void()> callback) {
-            m_planner.setProgressCallback(std::move(callback));
+            m_planning.setProgressCallback(std::move(callback));
+        }
+        void setRollingProbeWorkers(const std::size_t workers) {
+            m_planning.setRollingProbeWorkers(workers);
         }
 
         std::optional<TrajectoryCommandPresentation> takePresentationUpdate() {
-            if (m_outstandingChunks != 0 || m_pending
-                || m_planner.windowSize() != 0 || m_synchronizationFence
+            if (m_outstandingChunks != 0 || m_pending || m_synchronizationFence
                 || m_probePending) {
                 return std::nullopt;
             }
@@ -306,6 +291,11 @@ namespace ngc {
                     return false;
                 }
                 observePlanned(*m_pending, m_pendingItem, std::forward<Observe>(observe));
+                const auto &published = m_pending->items[m_pendingItem];
+                const auto seconds = normalMotionSeconds(published);
+                m_queuedMotion.emplace_back(
+                    std::visit([](const auto &item) { return item.id; }, published), seconds);
+                m_queuedMotionSeconds += seconds;
                 auto activation=std::ranges::lower_bound(
                     m_pending->activations,m_pendingItem,{},&TimedCommandActivation::chunk);
                 for(;activation!=m_pending->activations.end()
@@ -331,29 +321,14 @@ namespace ngc {
                 return true;
             }
 
-            if(m_deferredMessage) {
-                auto deferred = std::move(*m_deferredMessage);
-                m_deferredMessage.reset();
-                if(m_planner.windowSize() != 0) {
-                    m_deferredMessage = std::move(deferred);
-                    return planWindow();
-                }
-                if(!processMessage(std::move(deferred), std::forward<ObserveLifecycle>(observeLifecycle),
-                                    std::forward<ObserveStatus>(observeStatus), true)) return false;
-                return true;
-            }
-
-            if(m_planner.shouldPlanImmediately()) return planWindow();
-
-            PreparedForwardMessage message;
-            if(!m_forward.tryPop(message)) return false;
-            if(!message) {
-                fail("prepared geometry forward channel contained a null message");
-                return false;
+            PlanningStageMessage message;
+            auto planned = false;
+            if(!m_planning.tryTake(message)) {
+                planned = m_planning.pumpOne();
+                if(!m_planning.tryTake(message)) return planned;
             }
-            if(!processMessage(std::move(*message), std::forward<ObserveLifecycle>(observeLifecycle),
-                               std::forward<ObserveStatus>(observeStatus))) return false;
-            return true;
+            return processPlanned(std::move(message), std::forward<ObserveLifecycle>(observeLifecycle),
+                                  std::forward<ObserveStatus>(observeStatus));
         }
 
         void serviceBackend() { serviceBackend([](const ExecutionEvent &) { }); }
@@ -365,11 +340,9 @@ namespace ngc {
                 observe(event);
                 if(const auto *move = std::get_if<TriggeredMoveCompleted>(&event)) {
                     if(move->epoch == m_epoch && m_probePending) {
-                        if (!m_planner.reconcileHeldPosition(
-                                move->stoppedState.position)) {
-                            fail("probe completed while the trajectory planner retained geometry");
-                            return;
-                        }
+                        // Posted before the result so that the planner adopts
+                        // the stopped position ahead of the program's reply.
+                        m_planning.reconcileHeldPosition(move->stoppedState.position);
                         const auto status = [&] {
                             switch(move->status) {
                                 case TriggeredMoveStatus::Triggered: return ProbeStatus::Triggered;
@@ -387,6 +360,7 @@ namespace ngc {
                     }
                 } else if(const auto *retired = std::get_if<ChunkRetired>(&event)) {
                     if(retired->epoch == m_epoch && m_outstandingChunks > 0) --m_outstandingChunks;
+                    if(retired->epoch == m_epoch) retire(retired->chunk);
                     (void)releaseSynchronizationIfHeld();
                 } else if(const auto *fault = std::get_if<BackendFault>(&event)) {
                     fail("motion backend fault " + std::to_string(fault->code));
@@ -404,7 +378,7 @@ namespace ngc {
                             continue;
                         }
                         (void)releaseSynchronizationIfHeld();
-                        if(m_planner.hasRollingContinuation()) {
+                        if(m_rollingContinuation) {
                             fail("motion stopped on a rolling-horizon packet branch with retained prepared geometry");
                         } else {
                             m_exactStopHeld = true;
@@ -416,14 +390,12 @@ namespace ngc {
 
         PreparedDriverState state() const {
             if(m_error) return PreparedDriverState::Error;
-            if (m_programPause && !m_pending && !m_deferredMessage
-                && m_planner.windowSize() == 0 && m_outstandingChunks == 0
+            if (m_programPause && !m_pending && m_outstandingChunks == 0
                 && !m_probePending && !m_synchronizationFence
                 && !m_presentationUpdate) {
                 return PreparedDriverState::ProgramPaused;
             }
-            if(m_forwardComplete && !m_pending && !m_deferredMessage
-               &&m_planner.windowSize() == 0 && m_outstandingChunks == 0
+            if(m_forwardComplete && !m_pending && m_outstandingChunks == 0
                &&!m_probePending && !m_synchronizationFence
                && !m_presentationUpdate)
                 return PreparedDriverState::Completed;
@@ -431,20 +403,25 @@ namespace ngc {
         }
 
         const std::optional<std::string> &error() const { return m_error; }
-        const TrajectoryPlanningDiagnostics &planningDiagnostics() const { return m_planner.diagnostics(); }
-        const std::string &planningActivity() const { return m_planner.planningActivity(); }
-        double planningActivitySeconds() const { return m_planner.planningActivitySeconds(); }
-        const std::string &lastContinuousPlanSummary() const {
-            return m_planner.lastContinuousPlanSummary();
-        }
-        const std::string &lastContinuousCorrectionHistory() const {
-            return m_planner.lastContinuousCorrectionHistory();
-        }
+        // One copy of the planning stage's observed state; a pipelined stage
+        // refreshes it at most every few milliseconds and at each planned
+        // batch. Take one per report and read every field from it.
+        PlanningStageObservation planningObservation() const { return m_planning.observation(); }
         bool hasPendingPublication() const { return m_pending!=nullptr; }
         bool hasUnpublishedRollingContinuation() const {
-            return m_planner.hasRollingContinuation();
+            return m_rollingContinuation || m_planning.rollingContinuation();
+        }
+        // Normal-motion seconds planned ahead of the backend: published but
+        // not yet retired, plus the unpublished rest of the pending batch.
+        double queuedMotionSeconds() const {
+            auto seconds = m_queuedMotionSeconds;
+            if(m_pending)
+                for(auto item = m_pendingItem; item < m_pending->items.size(); ++item)
+                    seconds += normalMotionSeconds(m_pending->items[item]);
+            return seconds;
         }
-        std::string activity() const {
+        std::string activity() const { return activity(m_planning.observation()); }
+        std::string activity(const PlanningStageObservation &planning) const {
             if(m_error) return "error: "+*m_error;
             if(!m_backendReady) return "waiting for backend start acknowledgement";
             if (state() == PreparedDriverState::ProgramPaused) {
@@ -453,32 +430,34 @@ namespace ngc {
             if(m_waitingForHeld) return std::format(
                 "waiting for backend held event: outstanding={} retained_commands={} "
                 "retained_pieces={} retained_nominal={:.3f}s rolling_continuation={}",
-                m_outstandingChunks,m_planner.windowSize(),m_planner.preparedPieceCount(),
-                m_planner.preparedNominalDuration(),m_planner.hasRollingContinuation());
+                m_outstandingChunks,planning.windowSize,planning.preparedPieceCount,
+                planning.preparedNominalDuration,m_rollingContinuation);
             if(m_pending) return std::format(
-                "publishing planned packet batch: packet={}/{} outstanding={} forward_queue={}",
-                m_pendingItem+1,m_pending->items.size(),m_outstandingChunks,m_forward.size());
-            if(m_planner.windowSize()!=0) return std::format(
+                "publishing planned packet batch: packet={}/{} outstanding={} queued={:.3f}s "
+                "planned_queue={} forward_queue={}",
+                m_pendingItem+1,m_pending->items.size(),m_outstandingChunks,queuedMotionSeconds(),
+                m_planning.queuedMessages(),m_forward.size());
+            if(planning.windowSize!=0) return std::format(
                 "retaining prepared work: commands={} pieces={} nominal={:.3f}s "
                 "chain_ended={} rolling_ready={} rolling_continuation={} "
                 "rolling_candidates={} suffix_failures={} prefix_failures={} "
-                "outstanding={} forward_queue={} last_rolling_failure='{}'",
-                m_planner.windowSize(),m_planner.preparedPieceCount(),
-                m_planner.preparedNominalDuration(),m_planner.preparedChainEnded(),
-                m_planner.shouldPlanRollingPrefix(),m_planner.hasRollingContinuation(),
-                m_planner.diagnostics().rollingBoundaryCandidates,
-                m_planner.diagnostics().rollingSuffixProbeFailures,
-                m_planner.diagnostics().rollingPrefixProbeFailures,
-                m_outstandingChunks,m_forward.size(),
-                m_planner.lastRollingFailure());
+                "outstanding={} queued={:.3f}s forward_queue={} last_rolling_failure='{}'",
+                planning.windowSize,planning.preparedPieceCount,
+                planning.preparedNominalDuration,planning.preparedChainEnded,
+                planning.rollingReady,planning.rollingContinuation,
+                planning.diagnostics.rollingBoundaryCandidates,
+                planning.diagnostics.rollingSuffixProbeFailures,
+                planning.diagnostics.rollingPrefixProbeFailures,
+                m_outstandingChunks,queuedMotionSeconds(),m_forward.size(),
+                planning.lastRollingFailure);
             if(m_forwardComplete) return std::format(
                 "forward stream complete; outstanding={} probe_pending={} synchronization={}",
                 m_outstandingChunks,m_probePending,m_synchronizationFence.has_value());
             return std::format(
-                "waiting for prepared stream: forward_queue={} outstanding={} deferred={} "
-                "probe_pending={} synchronization={}",
-                m_forward.size(),m_outstandingChunks,m_deferredMessage.has_value(),
-                m_probePending,m_synchronizationFence.has_value());
+                "waiting for prepared stream: forward_queue={} planned_queue={} outstanding={} "
+                "queued={:.3f}s probe_pending={} synchronization={}",
+                m_forward.size(),m_planning.queuedMessages(),m_outstandingChunks,
+                queuedMotionSeconds(),m_probePending,m_synchronizationFence.has_value());
         }
     };
 }
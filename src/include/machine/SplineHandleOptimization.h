@@ -30,24 +30,66 @@ namespace ngc::spline_detail {
         std::size_t right=0;
     };
 
+    struct ShortEntityClusterBoundary {
+        // The entity is longer than 6P and anchors the clusters on either side.
+        bool longEntity=false;
+        // Closed by this entity: the short run between the previous long entity and it.
+        std::optional<ShortEntitySplineCluster> cluster;
+        // The short run reached its maximum length at this entity. The caller ends
+        // the geometry region after it; the detector has already restarted at index 0.
+        bool protectedSplit=false;
+    };
+
+    // Streaming form of detectShortEntitySplineClusters. Entity lengths are pushed in
+    // source order and each cluster is reported as soon as the long entity closing it
+    // arrives, so a caller only has to retain the source since the last long entity.
+    // An all-short region has no such boundary; maximumShortEntities bounds it by
+    // requesting a protected split instead. Zero leaves the region unbounded.
+    class ShortEntityClusterDetector {
+    public:
+        explicit ShortEntityClusterDetector(const double programmedScale=0.0,
+                                            const std::size_t maximumShortEntities=0)
+            : m_threshold(6.0*programmedScale),m_maximumShortEntities(maximumShortEntities) {}
+
+        ShortEntityClusterBoundary push(const double length) {
+            ShortEntityClusterBoundary result;
+            const auto index=m_count++;
+            if(!std::isfinite(m_threshold)||m_threshold<=0.0) return result;
+            if(length>m_threshold) {
+                result.longEntity=true;
+                if(m_haveAnchor&&index>m_anchor+1) result.cluster=ShortEntitySplineCluster{m_anchor,index};
+                m_haveAnchor=true;
+                m_anchor=index;
+                m_shortRun=0;
+                return result;
+            }
+            if(m_maximumShortEntities!=0&&++m_shortRun>=m_maximumShortEntities) {
+                result.protectedSplit=true;
+                m_count=0;
+                m_shortRun=0;
+                m_haveAnchor=false;
+            }
+            return result;
+        }
+
+    private:
+        double m_threshold=0.0;
+        std::size_t m_maximumShortEntities=0;
+        std::size_t m_count=0;
+        std::size_t m_shortRun=0;
+        std::size_t m_anchor=0;
+        bool m_haveAnchor=false;
+    };
+
     inline std::vector<ShortEntitySplineCluster> detectShortEntitySplineClusters(
             const std::span<const double> lengths,const double programmedScale) {
         std::vector<ShortEntitySplineCluster> result;
         if(!std::isfinite(programmedScale)||programmedScale<=0.0||lengths.size()<3)
             return result;
-        const auto threshold=6.0*programmedScale;
-        for(std::size_t left=0;left+2<lengths.size();) {
-            if(lengths[left]<=threshold) {
-                ++left;
-                continue;
-            }
-            auto right=left+1;
-            while(right<lengths.size()&&lengths[right]<=threshold) ++right;
-            if(right>left+1&&right<lengths.size()&&lengths[right]>threshold) {
-                result.push_back({left,right});
-                left=right;
-            } else ++left;
-        }
+        ShortEntityClusterDetector detector(programmedScale);
+        for(const auto length:lengths)
+            if(auto boundary=detector.push(length);boundary.cluster)
+                result.push_back(*boundary.cluster);
         return result;
     }
 
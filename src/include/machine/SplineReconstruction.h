@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <expected>
 #include <functional>
@@ -58,6 +59,20 @@ namespace ngc::spline_detail {
         std::vector<position_t> controls;
     };
 
+    // Control weights of the order-th derivative of an open B-spline at its first
+    // parameter, or at its last when end is set.
+    std::vector<double> endpointDerivativeCoefficients(std::span<const double> knots,
+        std::size_t degree, std::size_t controlCount, std::size_t order, bool end);
+
+    // One row of the lower band of a symmetric matrix with half bandwidth 3: entry
+    // [d] of row i is (i,i-d). factorBandLdlt() refactors the band in place as LDLt,
+    // leaving D(i) in the diagonal slot and L(i,i-d) in the others, and fails unless
+    // the band is numerically positive definite.
+    using SymmetricBandRow=std::array<double,4>;
+    bool factorBandLdlt(std::span<SymmetricBandRow> band);
+    // Solves a factored band for all six axes of values in place.
+    void solveBandLdlt(std::span<const SymmetricBandRow> factors, std::span<position_t> values);
+
     std::expected<ReconstructedSpline,std::string> reconstructSpline(
         std::span<const position_t> cubicControls,
         const SplineReconstructionSource &source,
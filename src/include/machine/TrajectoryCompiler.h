@@ -7,11 +7,14 @@
 #include <expected>
 #include <functional>
 #include <limits>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "machine/MotionBackend.h"
@@ -110,6 +113,21 @@ namespace ngc {
         double accelerationExcursionRatio(const AxisPolynomialSpan &span,
             double servoPeriod, const TrajectoryLimits &limits);
 
+        // Exact extrema of all six axes of one span at once. The axes are
+        // lanes of fixed-width arrays, so stationary-point isolation runs
+        // branch-free across them instead of once per axis.
+        struct AxisSpanExtrema {
+            position_t maximumVelocity{};
+            position_t maximumAcceleration{};
+            position_t maximumJerk{};
+        };
+        AxisSpanExtrema axisSpanExtrema(const AxisPolynomialSpan &span);
+        struct AxisPositionRanges {
+            position_t minimum{};
+            position_t maximum{};
+        };
+        AxisPositionRanges axisPositionRanges(const AxisPolynomialSpan &span);
+
         inline bool servoAwareJerkAccepted(const double duration,
                 const double maximumJerkRatio,
                 const double accelerationExcursionRatio,
@@ -250,7 +268,8 @@ namespace ngc {
     };
 
     // NRT-only cost evidence for exact-stop calls into PathTempo's scalar
-    // transition solver.
+    // transition solver. Cache hits are answered by ScalarTransitionCache
+    // without a solver call.
     struct TimeLawCallDiagnostics {
         std::size_t calls = 0;
         std::size_t successes = 0;
@@ -555,6 +574,15 @@ namespace ngc {
         ContinuousQuinticMaterializationDiagnostics quintic;
         double candidateConversionSeconds = 0.0;
         double correctionCollectionSeconds = 0.0;
+        // Boundary states whose tangent and curvature came from prepared
+        // samples, and the scalar curve evaluations saved by those and by
+        // batched evaluation of the remaining boundary states.
+        std::size_t preparedSampleBoundaryStates = 0;
+        std::size_t geometricEvaluationsAvoided = 0;
+        // Timing pieces whose accepted quintics came from an earlier pass or
+        // from the compiler's materialization memo instead of new proofs.
+        std::size_t reusedPieces = 0;
+        std::size_t reusedQuinticSpans = 0;
     };
 
     struct ContinuousTrajectoryPlan {
@@ -596,6 +624,56 @@ namespace ngc {
         double lookaheadDuration = 2.0;
     };
 
+    // Bounded least-recently-used memo of the scalar transition solves of
+    // exact-stop compiles. Continuous timing runs inside PathTempo's
+    // PathPlanner and never consults it. The key is the bit pattern of the
+    // boundary states and limits, so a hit returns exactly what the solver
+    // would; failures are remembered as well. Copies of a compiler share one
+    // cache, and a copy may compile on another NRT thread, as the rolling
+    // prefix probes do, so access is locked.
+    class ScalarTransitionCache {
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+        struct Key {
+            std::array<std::uint64_t, 8> bits{};
+
+            bool operator==(const Key &) const = default;
+        };
+
+        // Defined next to the solver.
+        struct Result;
+
+        explicit ScalarTransitionCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+        std::shared_ptr<const Result> find(const Key &key);
+        void insert(const Key &key, std::shared_ptr<const Result> result);
+        std::size_t size() const;
+        void clear();
+
+    private:
+        struct KeyHash {
+            std::size_t operator()(const Key &key) const;
+        };
+
+        struct Entry {
+            Key key;
+            std::shared_ptr<const Result> result;
+        };
+
+        std::size_t m_capacity;
+        mutable std::mutex m_mutex;
+        std::list<Entry> m_entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+    };
+
+    // Accepted quintic materializations of the timing pieces of the last
+    // verified continuous compile, keyed by curve interval and exact scalar
+    // time law. Immutable once published, so copies of a compiler and probes
+    // derived from it can share one without affecting each other's results.
+    // Defined next to continuous materialization.
+    struct ContinuousMaterializationMemo;
+
     class TrajectoryCompiler {
         TrajectoryLimits m_limits;
         ContinuousPlanningEffort m_continuousPlanningEffort;
@@ -606,7 +684,11 @@ namespace ngc {
         BranchSequence m_previousBranch = 0;
         position_t m_position{};
         std::function<void()> m_progressCallback;
+        std::function<bool()> m_cancellationCheck;
         TimeLawDiagnostics m_lastTimeLawDiagnostics;
+        std::shared_ptr<ScalarTransitionCache> m_scalarTransitionCache =
+            std::make_shared<ScalarTransitionCache>();
+        std::shared_ptr<const ContinuousMaterializationMemo> m_continuousMaterializationMemo;
 
     public:
         explicit TrajectoryCompiler(TrajectoryLimits limits = {});
@@ -624,12 +706,37 @@ namespace ngc {
             m_progressCallback=std::move(callback);
         }
         const std::function<void()> &progressCallback() const { return m_progressCallback; }
+        // Polled by compileContinuous() between timing passes and pieces; once
+        // it returns true the compile gives up with an error. Called from the
+        // compiling thread.
+        void setCancellationCheck(std::function<bool()> check) {
+            m_cancellationCheck=std::move(check);
+        }
+        // Null disables memoization.
+        void setScalarTransitionCache(std::shared_ptr<ScalarTransitionCache> cache) {
+            m_scalarTransitionCache=std::move(cache);
+        }
+        const std::shared_ptr<ScalarTransitionCache> &scalarTransitionCache() const {
+            return m_scalarTransitionCache;
+        }
+        // A memo recorded under different limits or servo period is ignored.
+        void setContinuousMaterializationMemo(
+                std::shared_ptr<const ContinuousMaterializationMemo> memo) {
+            m_continuousMaterializationMemo=std::move(memo);
+        }
+        const std::shared_ptr<const ContinuousMaterializationMemo> &
+        continuousMaterializationMemo() const {
+            return m_continuousMaterializationMemo;
+        }
         const TimeLawDiagnostics &lastTimeLawDiagnostics() const {
             return m_lastTimeLawDiagnostics;
         }
         void reportProgress() const {
             if(m_progressCallback) m_progressCallback();
         }
+        bool cancellationRequested() const {
+            return m_cancellationCheck && m_cancellationCheck();
+        }
         const position_t &plannedPosition() const { return m_position; }
         void reconcileHeldPosition(const position_t &position) { m_position = position; }
 
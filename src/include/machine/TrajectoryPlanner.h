@@ -2,10 +2,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <deque>
+#include <exception>
 #include <expected>
 #include <format>
 #include <memory>
@@ -21,6 +23,7 @@
 #include "machine/TrajectoryCompiler.h"
 #include "machine/ArcInterpolation.h"
 #include "machine/PreparedGeometry.h"
+#include "machine/WorkerPool.h"
 #include "evaluator/InterpreterSession.h"
 
 namespace ngc {
@@ -107,7 +110,18 @@ namespace ngc {
         std::uint64_t rollingSuffixProbeFailures = 0;
         std::uint64_t rollingPrefixProbeFailures = 0;
         std::size_t maximumRollingSuffixProbePieces = 0;
+        // Boundary attempts submitted ahead of the in-order search and never
+        // folded because an earlier attempt won; cancelled ones had not
+        // finished when the winner was selected.
+        std::uint64_t rollingSpeculativeProbes = 0;
+        std::uint64_t rollingCancelledProbes = 0;
         double rollingSearchSeconds = 0.0;
+        // Scalar curve evaluations continuous timing took from prepared
+        // samples or batched, across published plans and suffix probes.
+        std::uint64_t geometricEvaluationsAvoided = 0;
+        // Timing pieces whose quintic materialization was reused from an
+        // earlier correction pass or rolling horizon, counted the same way.
+        std::uint64_t reusedMaterializationPieces = 0;
         // All attempted scalar Ruckig solves, including failed rolling probes.
         TimeLawDiagnostics timeLaw;
         TimeLawDiagnostics publishedTimeLaw;
@@ -115,6 +129,71 @@ namespace ngc {
         TimeLawDiagnostics rollingSuffixProbeTimeLaw;
     };
 
+    // One rolling-boundary attempt: the suffix stop-feasibility probe and, when
+    // it proves, the prefix compile into the proposed boundary. Geometry is
+    // shared and immutable; results are read by the planning owner only after
+    // the pool publishes done. A cancelled attempt that has not started skips
+    // both compiles; one already compiling gives up at the compiler's next
+    // cancellation check and frees its worker.
+    struct RollingBoundaryProbe {
+        struct Geometry {
+            PreparedContinuousGeometry prefix;
+            PreparedContinuousGeometry suffixProof;
+        };
+
+        std::shared_ptr<const Geometry> geometry;
+        TrajectoryCompiler prefixPlanner;
+        MotionState start{};
+        MotionState boundary{};
+        double blendScale = 0.0;
+        std::atomic<bool> cancelled = false;
+        TimeLawDiagnostics suffixTimeLaw;
+        TimeLawDiagnostics prefixTimeLaw;
+        std::uint64_t suffixEvaluationsAvoided = 0;
+        std::uint64_t suffixReusedPieces = 0;
+        std::shared_ptr<const ContinuousMaterializationMemo> suffixMemo;
+        bool suffixProved = false;
+        std::string suffixError;
+        std::expected<std::unique_ptr<ContinuousTrajectoryPlan>, std::string> prefix =
+            std::unexpected(std::string{});
+        std::exception_ptr exception;
+        bool done = false;
+
+        void run() {
+            if(cancelled.load(std::memory_order_relaxed)) return;
+            try {
+                const auto cancellation=[this] { return cancelled.load(std::memory_order_relaxed); };
+                prefixPlanner.setCancellationCheck(cancellation);
+                TrajectoryCompiler suffixProbe(prefixPlanner.limits());
+                suffixProbe.setContinuousPlanningEffort(prefixPlanner.continuousPlanningEffort());
+                suffixProbe.setProgressCallback(prefixPlanner.progressCallback());
+                suffixProbe.setCancellationCheck(cancellation);
+                suffixProbe.setContinuousMaterializationMemo(
+                    prefixPlanner.continuousMaterializationMemo());
+                suffixProbe.reset(1,boundary.position);
+                auto suffix=suffixProbe.compileContinuous(
+                    geometry->suffixProof,blendScale,boundary,std::nullopt);
+                suffixTimeLaw=suffixProbe.lastTimeLawDiagnostics();
+                if(!suffix) {
+                    suffixError=std::move(suffix.error());
+                    return;
+                }
+                suffixProved=true;
+                suffixEvaluationsAvoided=(*suffix)->materialization.geometricEvaluationsAvoided;
+                suffixReusedPieces=(*suffix)->materialization.reusedPieces;
+                suffixMemo=suffixProbe.continuousMaterializationMemo();
+                if(cancelled.load(std::memory_order_relaxed)) return;
+                prefix=prefixPlanner.compileContinuous(
+                    geometry->prefix,blendScale,start,boundary);
+                prefixTimeLaw=prefixPlanner.lastTimeLawDiagnostics();
+            } catch(...) {
+                exception=std::current_exception();
+            }
+        }
+    };
+
+    using RollingBoundaryProbePool = WorkerPool<RollingBoundaryProbe>;
+
     // NRT-only compatible command horizon. RT capacity is imposed later while
     // the verified polynomial stream is packetized into PlanChunk values; it is
     // deliberately not expressed as an arbitrary G-code command count.
@@ -136,6 +215,10 @@ namespace ngc {
         std::chrono::steady_clock::time_point m_planningActivityStarted{};
         std::function<void(const ContinuousTrajectoryPlan &,
             std::span<const TrajectoryPlannerInput>)> m_continuousDiagnosticCallback;
+        std::size_t m_rollingProbeWorkers = 2;
+        // Created on the first rolling search; shared by copies, whose
+        // searches only ever wait on their own attempts.
+        std::shared_ptr<RollingBoundaryProbePool> m_rollingProbes;
 
         static constexpr std::array AXIS_COMPONENTS {
             &position_t::x, &position_t::y, &position_t::z,
@@ -209,27 +292,26 @@ namespace ngc {
             CurveEvaluationWorkspace workspace;
             const auto distance=piece.curveFrom
                 +std::clamp(localDistance,0.0,piece.length());
-            return {
-                positionAtDistance(*piece.curve,distance,workspace),
-                tangentAtDistance(*piece.curve,distance,workspace),
-                curvatureAtDistance(*piece.curve,distance,workspace),
-                curvatureDerivativeAtDistance(*piece.curve,distance,workspace),
-            };
+            PreparedGeometryBoundary boundary;
+            evaluateAtDistances(*piece.curve,{&distance,1},
+                {.positions={&boundary.position,1},.tangents={&boundary.tangent,1},
+                 .curvatures={&boundary.curvature,1},
+                 .curvatureDerivatives={&boundary.curvatureDerivative,1}},workspace);
+            return boundary;
         }
 
         static void resamplePreparedPiece(PreparedPathPiece &piece) {
             CurveEvaluationWorkspace workspace;
+            const std::array<double,2> distances{piece.curveFrom,piece.curveFrom+piece.length()};
+            std::array<position_t,2> tangents,curvatures,derivatives;
+            evaluateAtDistances(*piece.curve,distances,
+                {.tangents=tangents,.curvatures=curvatures,.curvatureDerivatives=derivatives},
+                workspace);
             piece.geometricSamples.clear();
             piece.geometricSamples.reserve(2);
-            for(unsigned index=0;index<=1;++index) {
-                const auto local=piece.length()*index;
-                const auto distance=piece.curveFrom+local;
-                const auto tangent=tangentAtDistance(*piece.curve,distance,workspace);
-                const auto curvature=curvatureAtDistance(*piece.curve,distance,workspace);
-                const auto derivative=curvatureDerivativeAtDistance(
-                    *piece.curve,distance,workspace);
-                piece.geometricSamples.push_back({local,tangent,curvature,derivative});
-            }
+            for(unsigned index=0;index<=1;++index)
+                piece.geometricSamples.push_back({piece.length()*index,tangents[index],
+                    curvatures[index],derivatives[index]});
         }
 
         static double preparedNominalDuration(const PreparedPathPiece &piece) {
@@ -368,12 +450,9 @@ namespace ngc {
                     suffixPiece.splineKnotIntervals.begin()
                         +static_cast<std::ptrdiff_t>(suffixInterval));
                 prefixPiece.geometricSamples.resize(firstSuffixSample);
-                suffixPiece.geometricSamples.assign(
-                    piece.geometricSamples.begin()
-                        +static_cast<std::ptrdiff_t>(firstSuffixSample),
-                    piece.geometricSamples.end());
-                for(auto &sample:suffixPiece.geometricSamples)
-                    sample.distance-=localDistance;
+                suffixPiece.geometricSamples.eraseFront(firstSuffixSample);
+                for(auto &distance:suffixPiece.geometricSamples.distances())
+                    distance-=localDistance;
                 for(auto &interval:suffixPiece.splineKnotIntervals)
                     interval.firstGeometricSample-=firstSuffixSample;
                 const auto &prefixTimingInterval =
@@ -515,15 +594,13 @@ namespace ngc {
                    || discontinuity(start.velocity, previous.velocity)
                    || discontinuity(start.acceleration, previous.acceleration))
                     return std::unexpected("planned stop branch is discontinuous at a span boundary");
+                const auto extrema = trajectory_detail::axisSpanExtrema(span);
                 for(const auto component : AXIS_COMPONENTS) {
-                    if(exceedsVelocityLimit(
-                           trajectory_detail::maximumAxisVelocity(span, component),
+                    if(exceedsVelocityLimit(extrema.maximumVelocity.*component,
                                limits.axisVelocity.*component)
-                       || exceedsDynamicLimit(
-                          trajectory_detail::maximumAxisAcceleration(span, component),
+                       || exceedsDynamicLimit(extrema.maximumAcceleration.*component,
                                   limits.axisAcceleration.*component)
-                       || exceedsDynamicLimit(
-                          trajectory_detail::maximumAxisJerk(span, component),
+                       || exceedsDynamicLimit(extrema.maximumJerk.*component,
                                   limits.axisJerk.*component))
                         return std::unexpected("planned stop branch exceeds a configured axis limit");
                 }
@@ -597,17 +674,16 @@ namespace ngc {
                 auto maximumJerkRatio =
                     trajectory_detail::maximumPathJerk(span)
                     / limits.pathJerk;
+                const auto extrema = trajectory_detail::axisSpanExtrema(span);
                 for (const auto component : AXIS_COMPONENTS) {
-                    if (exceedsVelocityLimit(
-                            trajectory_detail::maximumAxisVelocity(span, component),
+                    if (exceedsVelocityLimit(extrema.maximumVelocity.*component,
                                 limits.axisVelocity.*component)
-                        || exceedsDynamicLimit(
-                           trajectory_detail::maximumAxisAcceleration(span, component),
+                        || exceedsDynamicLimit(extrema.maximumAcceleration.*component,
                                    limits.axisAcceleration.*component)) {
                         return std::unexpected("continuous plan exceeds a configured axis limit");
                     }
                     maximumJerkRatio = std::max(maximumJerkRatio,
-                        trajectory_detail::maximumAxisJerk(span, component)
+                        extrema.maximumJerk.*component
                             / (limits.axisJerk.*component));
                 }
                 if (exceedsDynamicLimit(
@@ -759,6 +835,13 @@ namespace ngc {
         void setProgressCallback(std::function<void()> callback) {
             m_compiler.setProgressCallback(std::move(callback));
         }
+        // Zero probes rolling boundaries inline on the planning thread.
+        void setRollingProbeWorkers(const std::size_t workers) {
+            if(workers==m_rollingProbeWorkers) return;
+            m_rollingProbeWorkers=workers;
+            m_rollingProbes.reset();
+        }
+        std::size_t rollingProbeWorkers() const { return m_rollingProbeWorkers; }
         const TrajectoryLimits &limits() const { return m_compiler.limits(); }
         const TrajectoryPlanningDiagnostics &diagnostics() const { return m_diagnostics; }
         const std::string &planningActivity() const { return m_planningActivity; }
@@ -1028,6 +1111,10 @@ namespace ngc {
                 for(auto &chunk:continuous->chunks) items.emplace_back(std::move(chunk));
                 const auto activeInputs=continuous->activations.size();
                 m_diagnostics.publishedTimeLaw+=continuous->timeLaw;
+                m_diagnostics.geometricEvaluationsAvoided+=
+                    continuous->materialization.geometricEvaluationsAvoided;
+                m_diagnostics.reusedMaterializationPieces+=
+                    continuous->materialization.reusedPieces;
                 if(m_continuousDiagnosticCallback)
                     m_continuousDiagnosticCallback(*continuous,inputs);
                 const auto actualDuration=std::accumulate(
@@ -1163,76 +1250,171 @@ namespace ngc {
                     precedingDuration+=duration;
                 }
 
-                for(const auto &candidate:candidates) {
-                    auto split=splitPreparedGeometry(
-                        *m_preparedWindow,candidate.piece,candidate.distance);
-                    if(!split) continue;
-                    const auto suffixProof=suffixStopFeasibilityPrefix(split->suffix);
-                    m_diagnostics.maximumRollingSuffixProbePieces=std::max(
-                        m_diagnostics.maximumRollingSuffixProbePieces,
-                        preparedTimingPieceCount(suffixProof));
-                    const auto initialVelocityFraction=m_lastRollingVelocityFraction
-                        ?std::min(1.0,2.0**m_lastRollingVelocityFraction):1.0;
-                    for(unsigned attempt=0;attempt<6;++attempt) {
-                        const auto velocityFraction=initialVelocityFraction*std::pow(0.5,attempt);
-                        const auto velocity=split->velocityLimit*velocityFraction;
-                        if(velocity<split->velocityLimit*0.01) break;
-                        ++m_diagnostics.rollingBoundaryCandidates;
-                        MotionState boundary{
-                            split->unitBoundary.position,
-                            scalePosition(split->unitBoundary.velocity,velocity),
-                            scalePosition(split->unitBoundary.acceleration,velocity*velocity),
-                        };
-                        setPlanningActivity(std::format(
-                            "proving prepared G64 suffix: candidate_piece={} attempt={} "
-                            "commands={} pieces={} nominal={:.3f}s retained_nominal={:.3f}s",
-                            candidate.piece,attempt,suffixProof.commands.size(),
-                            suffixProof.pieces.size(),suffixProof.diagnostics.nominalDuration,
-                            split->suffix.diagnostics.nominalDuration));
-                        TrajectoryCompiler suffixProbe(m_compiler.limits());
-                        suffixProbe.setContinuousPlanningEffort(
-                            m_compiler.continuousPlanningEffort());
-                        suffixProbe.setProgressCallback(m_compiler.progressCallback());
-                        suffixProbe.reset(1,boundary.position);
-                        auto suffix=suffixProbe.compileContinuous(
-                            suffixProof,blendScale,boundary,std::nullopt);
-                        m_diagnostics.timeLaw+=suffixProbe.lastTimeLawDiagnostics();
-                        m_diagnostics.rollingSuffixProbeTimeLaw+=
-                            suffixProbe.lastTimeLawDiagnostics();
-                        if(!suffix) {
-                            ++m_diagnostics.rollingSuffixProbeFailures;
-                            m_lastRollingFailure = "suffix: " + suffix.error();
-                            continue;
+                // Attempts are enumerated in the sequential order (candidate,
+                // then halving velocity) and run on the probe pool up to a
+                // bounded depth ahead of the head. Results are folded strictly
+                // in that order, so the chosen boundary and every folded
+                // diagnostic match a serial search; attempts behind the
+                // winner are cancelled and never observed.
+                if(!m_rollingProbes)
+                    m_rollingProbes=std::make_shared<RollingBoundaryProbePool>(
+                        m_rollingProbeWorkers);
+                auto &probes=*m_rollingProbes;
+                const auto speculationDepth=2*probes.workers();
+                const auto initialVelocityFraction=m_lastRollingVelocityFraction
+                    ?std::min(1.0,2.0**m_lastRollingVelocityFraction):1.0;
+                struct RollingAttempt {
+                    std::size_t candidate = 0;
+                    unsigned attempt = 0;
+                    double velocityFraction = 0.0;
+                    // Set on a candidate's first entry, which is emitted even
+                    // when the candidate has no admissible velocity.
+                    std::optional<std::size_t> suffixProbePieces;
+                    std::shared_ptr<RollingBoundaryProbe> probe;
+                };
+                std::vector<std::optional<PreparedContinuousGeometry>> suffixes(candidates.size());
+                std::shared_ptr<const RollingBoundaryProbe::Geometry> candidateGeometry;
+                PreparedRollingSplit candidateSplit;
+                std::size_t nextCandidate=0;
+                unsigned nextAttempt=0;
+                const auto enumerate=[&]() -> std::optional<RollingAttempt> {
+                    while(nextCandidate<candidates.size()) {
+                        RollingAttempt result;
+                        result.candidate=nextCandidate;
+                        result.attempt=nextAttempt;
+                        if(nextAttempt==0) {
+                            const auto &candidate=candidates[nextCandidate];
+                            auto split=splitPreparedGeometry(
+                                *m_preparedWindow,candidate.piece,candidate.distance);
+                            if(!split) {
+                                ++nextCandidate;
+                                continue;
+                            }
+                            auto suffixProof=suffixStopFeasibilityPrefix(split->suffix);
+                            result.suffixProbePieces=preparedTimingPieceCount(suffixProof);
+                            suffixes[nextCandidate]=std::move(split->suffix);
+                            candidateGeometry=std::make_shared<const RollingBoundaryProbe::Geometry>(
+                                RollingBoundaryProbe::Geometry{
+                                    std::move(split->prefix),std::move(suffixProof)});
+                            candidateSplit=std::move(*split);
                         }
-                        auto prefixPlanner=m_compiler;
-                        setPlanningActivity(std::format(
-                            "compiling prepared G64 prefix: candidate_piece={} attempt={} "
-                            "commands={} pieces={} nominal={:.3f}s",
-                            candidate.piece,attempt,split->prefix.commands.size(),
-                            split->prefix.pieces.size(),
-                            split->prefix.diagnostics.nominalDuration));
-                        auto prefix=prefixPlanner.compileContinuous(
-                            split->prefix,blendScale,m_continuousBoundary,boundary);
-                        m_diagnostics.timeLaw+=prefixPlanner.lastTimeLawDiagnostics();
-                        m_diagnostics.rollingPrefixProbeTimeLaw+=
-                            prefixPlanner.lastTimeLawDiagnostics();
-                        if(!prefix) {
-                            ++m_diagnostics.rollingPrefixProbeFailures;
-                            m_lastRollingFailure = "prefix: " + prefix.error();
+                        result.velocityFraction=initialVelocityFraction*std::pow(0.5,nextAttempt);
+                        const auto velocity=candidateSplit.velocityLimit*result.velocityFraction;
+                        if(velocity<candidateSplit.velocityLimit*0.01) {
+                            ++nextCandidate;
+                            nextAttempt=0;
+                            if(result.suffixProbePieces) return result;
                             continue;
                         }
+                        if(++nextAttempt==6) {
+                            ++nextCandidate;
+                            nextAttempt=0;
+                        }
+                        auto probe=std::make_shared<RollingBoundaryProbe>();
+                        probe->geometry=candidateGeometry;
+                        probe->prefixPlanner=m_compiler;
+                        // Worker threads must not call into the owner's progress
+                        // reporting; the owner reports while it waits instead.
+                        if(probes.workers()!=0) probe->prefixPlanner.setProgressCallback({});
+                        probe->start=m_continuousBoundary;
+                        probe->boundary={
+                            candidateSplit.unitBoundary.position,
+                            scalePosition(candidateSplit.unitBoundary.velocity,velocity),
+                            scalePosition(candidateSplit.unitBoundary.acceleration,
+                                velocity*velocity),
+                        };
+                        probe->blendScale=blendScale;
+                        result.probe=std::move(probe);
+                        return result;
+                    }
+                    return std::nullopt;
+                };
+                std::deque<RollingAttempt> pending;
+                const auto submitAhead=[&] {
+                    while(pending.size()<std::max<std::size_t>(1,speculationDepth)) {
+                        auto next=enumerate();
+                        if(!next) return;
+                        if(next->probe) probes.submit(next->probe);
+                        pending.push_back(std::move(*next));
+                    }
+                };
+                const auto cancelPending=[&] {
+                    for(const auto &attempt:pending) {
+                        if(!attempt.probe) continue;
+                        attempt.probe->cancelled.store(true,std::memory_order_relaxed);
+                        ++m_diagnostics.rollingSpeculativeProbes;
+                        if(!probes.ready(*attempt.probe)) ++m_diagnostics.rollingCancelledProbes;
+                    }
+                    pending.clear();
+                };
 
-                        auto inputs=preparedInputs(split->prefix);
-                        m_compiler=std::move(prefixPlanner);
-                        m_continuousBoundary=boundary;
-                        m_lastRollingVelocityFraction=velocityFraction;
-                        m_preparedWindow=std::move(split->suffix);
-                        m_lastRollingFailure.clear();
-                        retainPreparedInputs(*m_preparedWindow);
-                        auto finalized=finalize(std::move(*prefix),std::move(inputs));
-                        if(finalized) m_planningActivity.clear();
-                        return finalized;
+                for(;;) {
+                    submitAhead();
+                    if(pending.empty()) break;
+                    auto head=std::move(pending.front());
+                    pending.pop_front();
+                    // Inline, the next attempt would run before this one is
+                    // folded and might be wasted.
+                    if(speculationDepth!=0) submitAhead();
+                    if(head.suffixProbePieces)
+                        m_diagnostics.maximumRollingSuffixProbePieces=std::max(
+                            m_diagnostics.maximumRollingSuffixProbePieces,
+                            *head.suffixProbePieces);
+                    if(!head.probe) continue;
+                    auto &probe=*head.probe;
+                    const auto &candidate=candidates[head.candidate];
+                    ++m_diagnostics.rollingBoundaryCandidates;
+                    setPlanningActivity(std::format(
+                        "proving prepared G64 suffix and prefix: candidate_piece={} attempt={} "
+                        "commands={} pieces={} nominal={:.3f}s retained_nominal={:.3f}s "
+                        "prefix_commands={} prefix_pieces={} prefix_nominal={:.3f}s",
+                        candidate.piece,head.attempt,probe.geometry->suffixProof.commands.size(),
+                        probe.geometry->suffixProof.pieces.size(),
+                        probe.geometry->suffixProof.diagnostics.nominalDuration,
+                        suffixes[head.candidate]->diagnostics.nominalDuration,
+                        probe.geometry->prefix.commands.size(),
+                        probe.geometry->prefix.pieces.size(),
+                        probe.geometry->prefix.diagnostics.nominalDuration));
+                    while(!probes.waitFor(probe,std::chrono::milliseconds(16)))
+                        m_compiler.reportProgress();
+                    if(probe.exception) {
+                        cancelPending();
+                        std::rethrow_exception(probe.exception);
                     }
+                    m_diagnostics.timeLaw+=probe.suffixTimeLaw;
+                    m_diagnostics.rollingSuffixProbeTimeLaw+=probe.suffixTimeLaw;
+                    if(!probe.suffixProved) {
+                        ++m_diagnostics.rollingSuffixProbeFailures;
+                        m_lastRollingFailure = "suffix: " + probe.suffixError;
+                        continue;
+                    }
+                    m_diagnostics.geometricEvaluationsAvoided+=probe.suffixEvaluationsAvoided;
+                    m_diagnostics.reusedMaterializationPieces+=probe.suffixReusedPieces;
+                    m_diagnostics.timeLaw+=probe.prefixTimeLaw;
+                    m_diagnostics.rollingPrefixProbeTimeLaw+=probe.prefixTimeLaw;
+                    if(!probe.prefix) {
+                        ++m_diagnostics.rollingPrefixProbeFailures;
+                        m_lastRollingFailure = "prefix: " + probe.prefix.error();
+                        continue;
+                    }
+
+                    cancelPending();
+                    auto inputs=preparedInputs(probe.geometry->prefix);
+                    auto progress=m_compiler.progressCallback();
+                    m_compiler=std::move(probe.prefixPlanner);
+                    m_compiler.setProgressCallback(std::move(progress));
+                    m_compiler.setCancellationCheck({});
+                    // The next horizon starts at this boundary, so the suffix
+                    // proof timed the pieces it is most likely to repeat.
+                    m_compiler.setContinuousMaterializationMemo(std::move(probe.suffixMemo));
+                    m_continuousBoundary=probe.boundary;
+                    m_lastRollingVelocityFraction=head.velocityFraction;
+                    m_preparedWindow=std::move(*suffixes[head.candidate]);
+                    m_lastRollingFailure.clear();
+                    retainPreparedInputs(*m_preparedWindow);
+                    auto finalized=finalize(std::move(*probe.prefix),std::move(inputs));
+                    if(finalized) m_planningActivity.clear();
+                    return finalized;
                 }
 
                 if(!allowTerminalStop) {
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+
+#include "machine/GeometryStreamProducer.h"
+#include "machine/OwningSpscChannel.h"
+#include "machine/TrajectoryPlanner.h"
+
+namespace ngc {
+    // One planned packet batch. rollingContinuation records whether the
+    // planner still retained geometry past the batch's final boundary.
+    struct PlannedBatch {
+        std::unique_ptr<PlannedExecution> execution;
+        bool rollingContinuation = false;
+    };
+
+    struct PlanningStageFailure {
+        std::string error;
+    };
+
+    // Planning output in prepared-stream order: batches interleaved with the
+    // prepared messages the driver acts on at their ordered boundary.
+    // Slices, standalone commands and chain ends are consumed by planning.
+    using PlanningStageMessage =
+        std::variant<PlannedBatch, PreparedStreamMessage, PlanningStageFailure>;
+
+    inline constexpr std::size_t PLANNED_EXECUTION_QUEUE_CAPACITY = 4;
+    using PlannedExecutionChannel =
+        OwningSpscChannel<PlanningStageMessage, PLANNED_EXECUTION_QUEUE_CAPACITY>;
+
+    // Copy of the planner state the driver reports. The planning thread
+    // refreshes it after every planning step and, while a horizon is being
+    // compiled, from the planner's progress callback.
+    struct PlanningStageObservation {
+        TrajectoryPlanningDiagnostics diagnostics;
+        std::string planningActivity;
+        double planningActivitySeconds = 0.0;
+        std::chrono::steady_clock::time_point observed{};
+        std::string lastContinuousPlanSummary;
+        std::string lastContinuousCorrectionHistory;
+        std::string lastRollingFailure;
+        std::size_t windowSize = 0;
+        std::size_t preparedPieceCount = 0;
+        double preparedNominalDuration = 0.0;
+        bool preparedChainEnded = false;
+        bool rollingReady = false;
+        bool rollingContinuation = false;
+    };
+
+    // NRT planning stage between the prepared geometry stream and the
+    // trajectory driver. It owns the TrajectoryPlanner, consumes the forward
+    // channel and publishes PlanningStageMessage values to an owning SPSC
+    // channel. With a planning thread a long horizon compile no longer blocks
+    // backend publication; without one the driver steps it inline.
+    class TrajectoryPlanningStage {
+        PreparedGeometryForwardChannel &m_forward;
+        std::atomic<bool> &m_cancelled;
+        TrajectoryPlanner m_planner;
+        PlannedExecutionChannel m_output;
+        std::optional<PreparedStreamMessage> m_deferredMessage;
+        GeometryEpoch m_epoch = 0;
+        GeometrySequence m_nextSequence = 1;
+        bool m_failed = false;
+        bool m_threaded = false;
+        // Used only without a planning thread, where planning blocks the
+        // caller that would otherwise refresh its own observers.
+        std::function<void()> m_progressCallback;
+        std::mutex m_heldPositionMutex;
+        std::optional<position_t> m_heldPosition;
+        std::atomic<bool> m_heldPositionPending = false;
+        mutable std::mutex m_observationMutex;
+        PlanningStageObservation m_observation;
+        std::chrono::steady_clock::time_point m_nextObservation{};
+        std::stop_token m_stop;
+        // last, so the thread is joined before the planner goes away
+        std::jthread m_thread;
+
+        bool stopped() const {
+            return m_stop.stop_requested() || m_cancelled.load(std::memory_order_acquire);
+        }
+
+        void observe(const bool force = true) {
+            const auto now = std::chrono::steady_clock::now();
+            if(!force && now < m_nextObservation) return;
+            m_nextObservation = now + std::chrono::milliseconds(16);
+            std::scoped_lock lock(m_observationMutex);
+            m_observation.diagnostics = m_planner.diagnostics();
+            m_observation.planningActivity = m_planner.planningActivity();
+            m_observation.planningActivitySeconds = m_planner.planningActivitySeconds();
+            m_observation.observed = now;
+            m_observation.lastContinuousPlanSummary = m_planner.lastContinuousPlanSummary();
+            m_observation.lastContinuousCorrectionHistory =
+                m_planner.lastContinuousCorrectionHistory();
+            m_observation.lastRollingFailure = m_planner.lastRollingFailure();
+            m_observation.windowSize = m_planner.windowSize();
+            m_observation.preparedPieceCount = m_planner.preparedPieceCount();
+            m_observation.preparedNominalDuration = m_planner.preparedNominalDuration();
+            m_observation.preparedChainEnded = m_planner.preparedChainEnded();
+            m_observation.rollingReady = m_planner.shouldPlanRollingPrefix();
+            m_observation.rollingContinuation = m_planner.hasRollingContinuation();
+        }
+
+        void progress() {
+            observe(false);
+            if(!m_threaded && m_progressCallback) m_progressCallback();
+        }
+
+        // The driver drains the channel before stepping an inline stage, and
+        // one step emits at most two messages, so only a threaded stage can
+        // find it full; it then waits for the driver or cancellation.
+        bool emit(PlanningStageMessage message) {
+            return m_output.waitPush(std::move(message), [&] { return stopped(); });
+        }
+
+        bool fail(std::string message) {
+            if(m_failed) return false;
+            m_failed = true;
+            (void)emit(PlanningStageFailure{std::move(message)});
+            return false;
+        }
+
+        static TrajectoryPlannerInput inputFrom(const PreparedCommandRecord &record) {
+            return { record.command, record.metadata, record.presentation,
+                     record.presentationActivation, record.continuousScaleOverride };
+        }
+
+        bool validateSequence(const PreparedStreamMessage &message) {
+            const auto [epoch, sequence] = std::visit([](const auto &value) {
+                return std::pair { value.epoch, value.sequence };
+            }, message);
+            if(epoch != m_epoch)
+                return fail(std::format("prepared geometry message has stale epoch {} expected {}",
+                    epoch, m_epoch));
+            if(sequence != m_nextSequence)
+                return fail(std::format("prepared geometry sequence gap or duplicate: received {} expected {}",
+                    sequence, m_nextSequence));
+            ++m_nextSequence;
+            return true;
+        }
+
+        bool applyHeldPosition() {
+            if(!m_heldPositionPending.load(std::memory_order_acquire)) return true;
+            std::optional<position_t> position;
+            {
+                std::scoped_lock lock(m_heldPositionMutex);
+                position = std::exchange(m_heldPosition, std::nullopt);
+                m_heldPositionPending.store(false, std::memory_order_release);
+            }
+            if(position && !m_planner.reconcileHeldPosition(*position))
+                return fail("probe completed while the trajectory planner retained geometry");
+            return true;
+        }
+
+        bool planWindow(const bool allowTerminalStop = true) {
+            auto planned = m_planner.planWindow(allowTerminalStop);
+            observe();
+            if(!planned) return fail(planned.error());
+            if(!*planned) return true;
+            if((*planned)->items.empty())
+                return fail("prepared trajectory planner produced an empty execution packet batch");
+            return emit(PlannedBatch{std::move(*planned), m_planner.hasRollingContinuation()});
+        }
+
+        bool appendSlice(const PreparedGeometrySlice &slice) {
+            if(!m_planner.enqueuePrepared(slice))
+                return fail("prepared trajectory planner rejected a geometry slice: "
+                    + m_planner.lastPreparedEnqueueError());
+            if(m_planner.shouldPlanRollingPrefix()) return planWindow(false);
+            return true;
+        }
+
+        // Messages ordered after retained work flush the window first.
+        bool flushThenForward(PreparedStreamMessage message) {
+            if(m_planner.windowSize() != 0 && !planWindow()) return false;
+            return emit(std::move(message));
+        }
+
+        bool processMessage(PreparedStreamMessage message,
+                            const bool sequenceAlreadyValidated = false) {
+            if(!sequenceAlreadyValidated && !validateSequence(message)) return false;
+            return std::visit([&](auto &&value) -> bool {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr(std::same_as<T, PreparedGeometrySlice>) {
+                    if(m_planner.windowSize() != 0 && m_planner.preparedChainEnded()) {
+                        m_deferredMessage = std::move(message);
+                        return planWindow();
+                    }
+                    return appendSlice(value);
+                } else if constexpr(std::same_as<T, PreparedStandaloneCommand>) {
+                    if(m_planner.windowSize() != 0) {
+                        m_deferredMessage = std::move(message);
+                        return planWindow();
+                    }
+                    if(!m_planner.enqueue(inputFrom(value.command)))
+                        return fail("bounded prepared lookahead rejected a standalone command");
+                    return planWindow();
+                } else if constexpr(std::same_as<T, PreparedContinuousEnd>) {
+                    if(!m_planner.endPreparedChain(value.chain))
+                        return fail("prepared trajectory planner received an end for the wrong geometry chain");
+                    return planWindow();
+                } else if constexpr(std::same_as<T, PreparedSynchronizationFence>
+                                    || std::same_as<T, PreparedProgramPause>
+                                    || std::same_as<T, PreparedProgramEnd>) {
+                    return flushThenForward(std::move(message));
+                } else if constexpr(std::same_as<T, PreparedPresentationUpdate>) {
+                    if(m_planner.windowSize() != 0)
+                        return fail("tool-change modal presentation was restored before its ordered boundary");
+                    return emit(std::move(message));
+                } else if constexpr(std::same_as<T, PreparedFailure>) {
+                    m_failed = true;
+                    (void)emit(std::move(message));
+                    return false;
+                } else {
+                    return emit(std::move(message));
+                }
+            }, std::move(message));
+        }
+
+        bool workPending() const {
+            return m_deferredMessage || m_planner.shouldPlanImmediately()
+                || m_heldPositionPending.load(std::memory_order_acquire);
+        }
+
+        bool stepPending() {
+            if(!applyHeldPosition()) return false;
+            if(m_deferredMessage) {
+                auto deferred = std::move(*m_deferredMessage);
+                m_deferredMessage.reset();
+                if(m_planner.windowSize() != 0) {
+                    m_deferredMessage = std::move(deferred);
+                    return planWindow();
+                }
+                return processMessage(std::move(deferred), true);
+            }
+            if(m_planner.shouldPlanImmediately()) return planWindow();
+            return true;
+        }
+
+        bool step(PreparedForwardMessage message) {
+            // A probe result reaches the interpreter only after the driver
+            // posted the held position, so it is applied before any message
+            // the interpreter produced in response.
+            if(!applyHeldPosition()) return false;
+            if(!message) return fail("prepared geometry forward channel contained a null message");
+            const auto processed = processMessage(std::move(*message));
+            observe(false);
+            return processed;
+        }
+
+        void run(const std::stop_token stop) {
+            m_stop = stop;
+            while(!m_failed && !stopped()) {
+                if(workPending()) {
+                    (void)stepPending();
+                    continue;
+                }
+                PreparedForwardMessage message;
+                if(!m_forward.waitPop(message, [&] {
+                        return stopped() || m_heldPositionPending.load(std::memory_order_acquire);
+                    })) {
+                    if(stopped()) return;
+                    continue;
+                }
+                (void)step(std::move(message));
+            }
+        }
+
+    public:
+        TrajectoryPlanningStage(PreparedGeometryForwardChannel &forward,
+                                std::atomic<bool> &cancelled,
+                                TrajectoryLimits limits = {})
+            : m_forward(forward), m_cancelled(cancelled), m_planner(limits) {
+            m_planner.setProgressCallback([this] { progress(); });
+        }
+
+        TrajectoryPlanningStage(const TrajectoryPlanningStage &) = delete;
+        TrajectoryPlanningStage &operator=(const TrajectoryPlanningStage &) = delete;
+
+        ~TrajectoryPlanningStage() { stop(); }
+
+        // Discards unconsumed output, so the driver must not be holding a
+        // message it still expects to be ordered after it.
+        void begin(const GeometryEpoch epoch, const position_t &position, const bool threaded) {
+            stop();
+            PlanningStageMessage discarded;
+            while(m_output.tryPop(discarded)) { }
+            m_deferredMessage.reset();
+            m_epoch = epoch;
+            m_nextSequence = 1;
+            m_failed = false;
+            m_threaded = threaded;
+            {
+                std::scoped_lock lock(m_heldPositionMutex);
+                m_heldPosition.reset();
+                m_heldPositionPending.store(false, std::memory_order_release);
+            }
+            m_planner.clearDiagnostics();
+            m_planner.reset(epoch, position);
+            m_stop = {};
+            observe();
+            if(m_threaded)
+                m_thread = std::jthread([this](const std::stop_token stop) { run(stop); });
+        }
+
+        void stop() {
+            if(!m_thread.joinable()) return;
+            m_thread.request_stop();
+            m_forward.notifyAll();
+            m_output.notifyAll();
+            m_thread.join();
+            m_thread = {};
+        }
+
+        // Inline stepping for a stage without a planning thread.
+        bool pumpOne() {
+            if(m_threaded || m_failed) return false;
+            if(workPending()) {
+                const auto stepped = stepPending();
+                observe(false);
+                return stepped;
+            }
+            PreparedForwardMessage message;
+            if(!m_forward.tryPop(message)) return false;
+            return step(std::move(message));
+        }
+
+        bool tryTake(PlanningStageMessage &message) { return m_output.tryPop(message); }
+        std::size_t queuedMessages() const { return m_output.size(); }
+        bool threaded() const { return m_threaded; }
+
+        void reconcileHeldPosition(const position_t &position) {
+            {
+                std::scoped_lock lock(m_heldPositionMutex);
+                m_heldPosition = position;
+                m_heldPositionPending.store(true, std::memory_order_release);
+            }
+            m_forward.notifyAll();
+        }
+
+        // Configuration changes only while no planning thread is running.
+        void setLimits(const TrajectoryLimits &limits) { m_planner.setLimits(limits); }
+        void setContinuousPlanningEffort(const ContinuousPlanningEffort &effort) {
+            m_planner.setContinuousPlanningEffort(effort);
+        }
+        void setContinuousDiagnosticCallback(std::function<void(
+                const ContinuousTrajectoryPlan &,
+                std::span<const TrajectoryPlannerInput>)> callback) {
+            m_planner.setContinuousDiagnosticCallback(std::move(callback));
+        }
+        void setProgressCallback(std::function<void()> callback) {
+            m_progressCallback = std::move(callback);
+        }
+        void setRollingProbeWorkers(const std::size_t workers) {
+            m_planner.setRollingProbeWorkers(workers);
+        }
+
+        PlanningStageObservation observation() const {
+            std::scoped_lock lock(m_observationMutex);
+            auto result = m_observation;
+            if(!result.planningActivity.empty())
+                result.planningActivitySeconds += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - result.observed).count();
+            return result;
+        }
+        bool rollingContinuation() const {
+            std::scoped_lock lock(m_observationMutex);
+            return m_observation.rollingContinuation;
+        }
+    };
+}
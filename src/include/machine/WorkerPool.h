@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ngc {
+    // NRT jobs run by a fixed set of threads in submission order. Job::run()
+    // must be callable from any thread and touch only the job; the pool sets
+    // Job::done under its lock, so ready() and wait() observe every result
+    // the job wrote. Without workers submit() runs the job inline.
+    template<typename Job>
+    class WorkerPool {
+        std::mutex m_mutex;
+        std::condition_variable_any m_changed;
+        std::deque<std::shared_ptr<Job>> m_queue;
+        // last, so the workers are stopped and joined before the queue goes away
+        std::vector<std::jthread> m_workers;
+
+        void work(const std::stop_token stop) {
+            for(;;) {
+                std::shared_ptr<Job> job;
+                {
+                    std::unique_lock lock(m_mutex);
+                    if(!m_changed.wait(lock, stop, [&] { return !m_queue.empty(); })
+                       || stop.stop_requested()) return;
+                    job = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+                job->run();
+                {
+                    std::scoped_lock lock(m_mutex);
+                    job->done = true;
+                }
+                m_changed.notify_all();
+            }
+        }
+
+    public:
+        explicit WorkerPool(const std::size_t workers) {
+            m_workers.reserve(workers);
+            for(std::size_t index = 0; index < workers; ++index)
+                m_workers.emplace_back([this](const std::stop_token stop) { work(stop); });
+        }
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        void submit(std::shared_ptr<Job> job) {
+            if(m_workers.empty()) {
+                job->run();
+                job->done = true;
+                return;
+            }
+            {
+                std::scoped_lock lock(m_mutex);
+                m_queue.push_back(std::move(job));
+            }
+            m_changed.notify_all();
+        }
+
+        bool ready(const Job &job) {
+            std::scoped_lock lock(m_mutex);
+            return job.done;
+        }
+
+        void wait(const Job &job) {
+            std::unique_lock lock(m_mutex);
+            m_changed.wait(lock, [&] { return job.done; });
+        }
+
+        template<typename Rep, typename Period>
+        bool waitFor(const Job &job, const std::chrono::duration<Rep, Period> timeout) {
+            std::unique_lock lock(m_mutex);
+            return m_changed.wait_for(lock, timeout, [&] { return job.done; });
+        }
+
+        std::size_t workers() const { return m_workers.size(); }
+    };
+}
@@ -3,12 +3,12 @@
 #include <expected>
 
 #include <algorithm>
+#include <array>
 #include <compare>
 #include <cstddef>
 #include <cstdint>
 #include <cmath>
 #include <vector>
-#include <unordered_map>
 #include <format>
 #include <utility>
 #include <stdexcept>
@@ -22,7 +22,8 @@ namespace ngc
     class Memory {
         std::vector<MemoryCell> m_data;
         std::vector<double> m_stack;
-        std::unordered_map<Var, uint32_t> m_globals;
+        // address of every Var indexed by varIndex(), 0 while the Var is not part of the layout
+        std::array<uint32_t, VAR_COUNT> m_globals {};
         std::vector<uint32_t> m_addrs;
         std::size_t m_programStorageBegin = 0;
 
@@ -48,7 +49,7 @@ namespace ngc
 
         void init(const std::span<const vars_t> specs) {
             m_data.clear();
-            m_globals.clear();
+            m_globals.fill(0);
             m_stack.clear();
             m_addrs.clear();
 
@@ -63,7 +64,7 @@ namespace ngc
 
                 auto _addr = addData(MemoryCell(flags, value));
 
-                m_globals.emplace(var, _addr);
+                m_globals[varIndex(var)] = _addr;
                 m_addrs.emplace_back(_addr);
             }
 
@@ -76,11 +77,13 @@ namespace ngc
         }
 
         size_t deref(const Var var) const {
-            if(!m_globals.contains(var)) {
+            const auto addr = varIndex(var) < VAR_COUNT ? m_globals[varIndex(var)] : 0;
+
+            if(addr == 0) {
                 throw std::logic_error(std::format("Memory::read() unknown Var::{}", std::to_underlying(var)));
             }
 
-            return m_globals.at(var);
+            return addr;
         }
 
         double read(const Var var, const bool ignoreFlags = true) const {
@@ -95,15 +98,31 @@ namespace ngc
         }
 
         void write(const Var var, const double value, const bool ignoreFlags = true) {
-            if(!m_globals.contains(var)) {
+            const auto addr = varIndex(var) < VAR_COUNT ? m_globals[varIndex(var)] : 0;
+
+            if(addr == 0) {
                 throw std::logic_error(std::format("Memory::write() unknown Var::{}", std::to_underlying(var)));
             }
 
-            if(!writeData(m_globals.at(var), value, ignoreFlags)) {
+            if(!writeData(addr, value, ignoreFlags)) {
                 throw std::logic_error(std::format("Memory::writeData failed for Var::{}", std::to_underlying(var)));
             }
         }
 
+        // Typed access to a global known at compile time. Ignores the cell flags like read(Var)/write(Var) do
+        // by default, and only pays for the check that init() placed the Var.
+        template<Var var>
+        [[nodiscard]] double read() const {
+            static_assert(varIndex(var) < VAR_COUNT);
+            return m_data[global<var>("read")].read();
+        }
+
+        template<Var var>
+        void write(const double value) {
+            static_assert(varIndex(var) < VAR_COUNT);
+            m_data[global<var>("write")].write(value);
+        }
+
         uint32_t addData(const MemoryCell mc) {
             const auto addr = m_data.size();
             m_data.emplace_back(mc);
@@ -201,6 +220,17 @@ namespace ngc
         }
 
     private:
+        template<Var var>
+        [[nodiscard]] uint32_t global(const char *operation) const {
+            const auto addr = m_globals[varIndex(var)];
+
+            if(addr == 0) [[unlikely]] {
+                throw std::logic_error(std::format("Memory::{}() unknown Var::{}", operation, std::to_underlying(var)));
+            }
+
+            return addr;
+        }
+
         std::expected<double, Error> readData(const size_t index, const bool ignoreFlags) const {
             if(index >= m_data.size()) {
                 return std::unexpected(Error::INVALID_DATA_ADDRESS);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <string_view>
 #include <tuple>
 
@@ -109,6 +110,23 @@ namespace ngc {
         #undef ITEM
     };
 
+    inline constexpr std::size_t VAR_COUNT = gVars.size();
+
+    // Var values are dense and follow gVars, so a Var can index flat per-var tables directly
+    inline constexpr std::size_t varIndex(const Var var) {
+        return static_cast<std::size_t>(var);
+    }
+
+    static_assert([] {
+        for(std::size_t i = 0; i < VAR_COUNT; ++i) {
+            if(varIndex(std::get<0>(gVars[i])) != i) {
+                return false;
+            }
+        }
+
+        return true;
+    }());
+
     inline constexpr std::string_view name(const Var var) {
         switch(var) {
             #define CASE(var, name, addr, flags, value) case Var::var: return #var;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ngc {
+    // Bump allocator that owns every node of a parsed Program. Nodes are never destroyed individually, only
+    // released together with the arena, so anything placed in it must be trivially destructible.
+    class AstArena {
+        static constexpr std::size_t MIN_BLOCK_SIZE = 16 * 1024;
+        static constexpr std::size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+        struct block_t {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size;
+        };
+
+        std::vector<block_t> m_blocks;
+        std::size_t m_used = 0;
+        std::size_t m_bytes = 0;
+
+    public:
+        AstArena() = default;
+        AstArena(const AstArena &) = delete;
+        AstArena(AstArena &&) noexcept = default;
+        AstArena &operator=(const AstArena &) = delete;
+        AstArena &operator=(AstArena &&) noexcept = default;
+
+        template<typename T, typename ...Args>
+        [[nodiscard]] T *make(Args &&...args) requires std::is_trivially_destructible_v<T> {
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+            return std::construct_at(static_cast<T *>(allocate(sizeof(T), alignof(T))), std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        [[nodiscard]] std::span<T> array(const std::size_t count) requires std::is_trivially_destructible_v<T> {
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+            if(count == 0) {
+                return {};
+            }
+
+            const auto data = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+            std::uninitialized_value_construct_n(data, count);
+            return { data, count };
+        }
+
+        void clear() {
+            m_blocks.clear();
+            m_used = 0;
+            m_bytes = 0;
+        }
+
+        // bytes handed out to nodes, excluding alignment padding and unused block tails
+        [[nodiscard]] std::size_t bytes() const { return m_bytes; }
+        [[nodiscard]] std::size_t blocks() const { return m_blocks.size(); }
+
+    private:
+        [[nodiscard]] void *allocate(const std::size_t size, const std::size_t alignment) {
+            if(!m_blocks.empty()) {
+                const auto offset = (m_used + alignment - 1) & ~(alignment - 1);
+
+                if(offset + size <= m_blocks.back().size) {
+                    m_used = offset + size;
+                    m_bytes += size;
+                    return m_blocks.back().data.get() + offset;
+                }
+            }
+
+            // grow geometrically so small programs stay small and huge ones need few blocks
+            const auto previous = m_blocks.empty() ? MIN_BLOCK_SIZE / 2 : m_blocks.back().size;
+            const auto blockSize = std::max(std::min(previous * 2, MAX_BLOCK_SIZE), size);
+            m_blocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(blockSize), blockSize });
+            m_used = size;
+            m_bytes += size;
+            return m_blocks.back().data.get();
+        }
+    };
+}
@@ -1,8 +1,7 @@
 #pragma once
 
-#include <utility>
-#include <vector>
-#include <memory>
+#include <span>
+#include <string>
 #include <utility>
 
 #include "parser/Token.h"
@@ -10,12 +9,15 @@
 
 namespace ngc
 {
-    class Expression { 
+    // Expressions live in the Program's AstArena and are never deleted individually.
+    class Expression {
         Token m_token;
 
+    protected:
+        ~Expression() = default;
+
     public:
         explicit Expression(Token  token) : m_token(std::move(token)) { }
-        virtual ~Expression() = default;
 
         const Token &token() const { return m_token; }
 
@@ -52,7 +54,7 @@ namespace ngc
     };
 
     template<typename Expr>
-    inline std::string join(const std::vector<std::unique_ptr<Expr>> &expressions, const std::string_view sep) {
+    inline std::string join(const std::span<const Expr * const> expressions, const std::string_view sep) {
         std::string result;
 
         for(const auto &expr : expressions) {
@@ -70,7 +72,6 @@ namespace ngc
     public:
         using Expression::is;
         explicit CommentExpression(Token token) : Expression(std::move(token)) { }
-        ~CommentExpression() override = default;
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return token(); }
@@ -99,16 +100,15 @@ namespace ngc
     };
 
     class WordExpression final : public Expression {
-        std::unique_ptr<RealExpression> m_realExpression;
+        const RealExpression *m_realExpression;
 
     public:
-        WordExpression(Token token, std::unique_ptr<RealExpression> real): Expression(std::move(token)), m_realExpression(std::move(real)) { }
-        ~WordExpression() override = default;
+        WordExpression(Token token, const RealExpression *real): Expression(std::move(token)), m_realExpression(real) { }
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return m_realExpression->endToken(); }
         std::string text() const override { return std::format("{}{}", token().text(), m_realExpression->text()); }
-        const RealExpression *real() const { return m_realExpression.get(); }
+        const RealExpression *real() const { return m_realExpression; }
 
         bool isImpl(const WordExpression *) const override { return true; }
 
@@ -118,16 +118,16 @@ namespace ngc
     };
 
     class LiteralExpression final : public RealExpression {
-    public:
-        explicit LiteralExpression(Token token) : RealExpression(std::move(token)) { }
-        ~LiteralExpression() override = default;
+        double m_value;
 
-        static std::unique_ptr<LiteralExpression> fromDouble(const double d) { return std::make_unique<LiteralExpression>(Token::fromDouble(d)); }
+    public:
+        explicit LiteralExpression(Token token) : RealExpression(token), m_value(token.as_double()) { }
+        LiteralExpression(Token token, const double value) : RealExpression(token), m_value(value) { }
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return token(); }
-        std::string text() const override { return std::string(token().text()); }
-        double value() const { return token().as_double(); }
+        std::string text() const override { return token().source() ? std::string(token().text()) : toChars(m_value); }
+        double value() const { return m_value; }
 
         using RealExpression::isImpl;
         bool isImpl(const LiteralExpression *) const override { return true; }
@@ -140,7 +140,6 @@ namespace ngc
     class StringExpression final : public ScalarExpression {
     public:
         explicit StringExpression(Token token) : ScalarExpression(std::move(token)) { }
-        ~StringExpression() override = default;
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return token(); }
@@ -164,16 +163,15 @@ namespace ngc
     };
 
     class NumericVariableExpression final : public VariableExpression {
-        std::unique_ptr<RealExpression> m_realExpression;
+        const RealExpression *m_realExpression;
 
     public:
-        explicit NumericVariableExpression(Token token, std::unique_ptr<RealExpression> realExpression) : VariableExpression(std::move(token)), m_realExpression(std::move(realExpression)) { }
-        ~NumericVariableExpression() override = default;
+        explicit NumericVariableExpression(Token token, const RealExpression *realExpression) : VariableExpression(std::move(token)), m_realExpression(realExpression) { }
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return m_realExpression->endToken(); }
         std::string text() const override { return std::format("{}{}", token().text(), m_realExpression->text()); }
-        const RealExpression *real() const { return m_realExpression.get(); }
+        const RealExpression *real() const { return m_realExpression; }
 
         using VariableExpression::isImpl;
         bool isImpl(const NumericVariableExpression *) const override { return true; }
@@ -186,11 +184,6 @@ namespace ngc
     class NamedVariableExpression final : public VariableExpression {
     public:
         explicit NamedVariableExpression(Token token) : VariableExpression(std::move(token)) { }
-        ~NamedVariableExpression() override = default;
-
-        static std::unique_ptr<NamedVariableExpression> fromName(std::string name) {
-            return std::make_unique<NamedVariableExpression>(Token::fromString(Token::Kind::NAMED_VARIABLE, std::format("#{}", name)));
-        }
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return token(); }
@@ -207,7 +200,7 @@ namespace ngc
     };
 
     class UnaryExpression final : public RealExpression {
-        std::unique_ptr<RealExpression> m_realExpression;
+        const RealExpression *m_realExpression;
 
     public:
         enum class Op {
@@ -216,13 +209,12 @@ namespace ngc
             POSITIVE
         };
 
-        explicit UnaryExpression(Token token, std::unique_ptr<RealExpression> realExpression) : RealExpression(std::move(token)), m_realExpression(std::move(realExpression)) { }
-        ~UnaryExpression() override = default;
+        explicit UnaryExpression(Token token, const RealExpression *realExpression) : RealExpression(std::move(token)), m_realExpression(realExpression) { }
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return m_realExpression->endToken(); }
         std::string text() const override { return std::format("{}{}", token().text(), m_realExpression->text()); }
-        const RealExpression *real() const { return m_realExpression.get(); }
+        const RealExpression *real() const { return m_realExpression; }
 
         using RealExpression::isImpl;
         bool isImpl(const UnaryExpression *) const override { return true; }
@@ -242,8 +234,8 @@ namespace ngc
     };
 
     class BinaryExpression final : public RealExpression {
-        std::unique_ptr<RealExpression> m_left;
-        std::unique_ptr<RealExpression> m_right;
+        const RealExpression *m_left;
+        const RealExpression *m_right;
 
     public:
         enum class Op {
@@ -254,8 +246,7 @@ namespace ngc
             MUL, DIV, MOD,
         };
 
-        explicit BinaryExpression(Token token, std::unique_ptr<RealExpression> left, std::unique_ptr<RealExpression> right) : RealExpression(std::move(token)), m_left(std::move(left)), m_right(std::move(right)) { }
-        ~BinaryExpression() override = default;
+        explicit BinaryExpression(Token token, const RealExpression *left, const RealExpression *right) : RealExpression(std::move(token)), m_left(left), m_right(right) { }
 
         const Token &startToken() const override { return m_left->startToken(); }
         const Token &endToken() const override { return m_right->endToken(); }
@@ -268,8 +259,8 @@ namespace ngc
         constexpr const char *className() const override { return staticClassName(); }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
 
-        const RealExpression *left() const { return m_left.get(); }
-        const RealExpression *right() const { return m_right.get(); }
+        const RealExpression *left() const { return m_left; }
+        const RealExpression *right() const { return m_right; }
 
         Op op() const {
             switch (token().kind()) {
@@ -295,11 +286,10 @@ namespace ngc
 
     class CallExpression final : public RealExpression {
         Token m_endToken;
-        std::vector<std::unique_ptr<ScalarExpression>> m_args;
+        std::span<const ScalarExpression * const> m_args;
 
     public:
-        explicit CallExpression(Token token, Token endToken, std::vector<std::unique_ptr<ScalarExpression>> args) : RealExpression(std::move(token)), m_endToken(std::move(endToken)), m_args(std::move(args)) { }
-        ~CallExpression() override = default;
+        explicit CallExpression(Token token, Token endToken, const std::span<const ScalarExpression * const> args) : RealExpression(std::move(token)), m_endToken(std::move(endToken)), m_args(args) { }
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return m_endToken; }
@@ -312,23 +302,22 @@ namespace ngc
         constexpr const char *className() const override { return staticClassName(); }
 
         std::string_view name() const { return token().value(); }
-        const std::vector<std::unique_ptr<ScalarExpression>> &args() const { return m_args; }
+        std::span<const ScalarExpression * const> args() const { return m_args; }
 
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 
     class GroupingExpression final : public RealExpression {
         Token m_endToken;
-        std::unique_ptr<RealExpression> m_realExpression;
+        const RealExpression *m_realExpression;
 
     public:
-        explicit GroupingExpression(Token token, Token endToken, std::unique_ptr<RealExpression> expression) : RealExpression(std::move(token)), m_endToken(std::move(endToken)), m_realExpression(std::move(expression)) { }
-        ~GroupingExpression() override = default;
+        explicit GroupingExpression(Token token, Token endToken, const RealExpression *expression) : RealExpression(std::move(token)), m_endToken(std::move(endToken)), m_realExpression(expression) { }
 
         const Token &startToken() const override { return token(); }
         const Token &endToken() const override { return m_endToken; }
         std::string text() const override { return std::format("[{}]", m_realExpression->text()); }
-        const RealExpression *real() const { return m_realExpression.get(); }
+        const RealExpression *real() const { return m_realExpression; }
 
         using RealExpression::isImpl;
         bool isImpl(const GroupingExpression *) const override { return true; }
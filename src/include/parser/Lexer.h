@@ -1,13 +1,16 @@
 #pragma once
 
+#include <array>
 #include <expected>
-#include <memory>
 #include <cctype>
+#include <cstdint>
 #include <format>
+#include <optional>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "parser/LexerSource.h"
-#include "parser/StringViewTokenSource.h"
 #include "parser/Token.h"
 
 namespace ngc
@@ -19,6 +22,74 @@ namespace ngc
             END
         };
 
+        enum class CharClass : std::uint8_t {
+            OTHER,
+            BLANK,
+            NEWLINE,
+            DIGIT,
+            DOT,
+            SIGN,
+            SLASH,
+            LPAREN,
+            LETTER,
+            ALPHA
+        };
+
+        struct scan_t {
+            size_t index;
+            int line;
+            int col;
+        };
+
+        // O words stay on the general path along with everything else that is not a plain literal word
+        static constexpr std::string_view PLAIN_LETTERS = "ABCDFGHIJKLMNPQRSTXYZ";
+
+        static constexpr auto CHAR_CLASSES = [] {
+            std::array<CharClass, 256> classes {};
+
+            for(const auto c : std::string_view(" \t\r\v\f")) {
+                classes[static_cast<unsigned char>(c)] = CharClass::BLANK;
+            }
+
+            for(char c = '0'; c <= '9'; c++) {
+                classes[static_cast<unsigned char>(c)] = CharClass::DIGIT;
+            }
+
+            for(char c = 'A'; c <= 'Z'; c++) {
+                classes[static_cast<unsigned char>(c)] = CharClass::ALPHA;
+                classes[static_cast<unsigned char>(c - 'A' + 'a')] = CharClass::ALPHA;
+            }
+
+            for(const auto c : PLAIN_LETTERS) {
+                classes[static_cast<unsigned char>(c)] = CharClass::LETTER;
+                classes[static_cast<unsigned char>(c - 'A' + 'a')] = CharClass::LETTER;
+            }
+
+            classes['\n'] = CharClass::NEWLINE;
+            classes['.'] = CharClass::DOT;
+            classes['+'] = CharClass::SIGN;
+            classes['-'] = CharClass::SIGN;
+            classes['/'] = CharClass::SLASH;
+            classes['('] = CharClass::LPAREN;
+            return classes;
+        }();
+
+        static constexpr auto WORD_KINDS = [] {
+            using enum Token::Kind;
+            constexpr std::array letters = { A, B, C, D, F, G, H, I, J, K, L, M, N, P, Q, R, S, T, X, Y, Z };
+            static_assert(letters.size() == PLAIN_LETTERS.size());
+
+            std::array<Token::Kind, 256> kinds {};
+            kinds.fill(NONE);
+
+            for(size_t i = 0; i < letters.size(); i++) {
+                kinds[static_cast<unsigned char>(PLAIN_LETTERS[i])] = letters[i];
+                kinds[static_cast<unsigned char>(PLAIN_LETTERS[i] - 'A' + 'a')] = letters[i];
+            }
+
+            return kinds;
+        }();
+
         State m_state = State::BEGIN;
         LexerSource &m_source;
         size_t m_index = 0;
@@ -44,6 +115,14 @@ namespace ngc
             }
         };
 
+        // A word of a block made of literal words only, such as `X-1.5` in `G1 X-1.5 F100`.
+        struct PlainWord {
+            Token letter;
+            std::optional<Token> sign;
+            Token number;
+            double value;
+        };
+
         explicit Lexer(LexerSource &source): m_source(source) { }
 
         void pushState() {
@@ -180,7 +259,183 @@ namespace ngc
             return std::unexpected(Error(std::format("unhandled character: '{}'", c), m_source.name(), m_line, m_col));
         }
 
+        // Scans the next statement directly off the source text if it is a block of nothing but literal words and
+        // comments, the shape almost every line of CAM output has. On success the block and its newline are
+        // consumed; otherwise nothing is, and the caller falls back to nextToken() and the general grammar.
+        [[nodiscard]] bool scanPlainBlock(std::optional<Token> &blockDelete, std::vector<PlainWord> &words) {
+            const auto text = m_source.text();
+            auto scan = scan_t { m_source.index(), m_source.line(), m_source.col() };
+
+            // statements may be preceded by any number of empty and comment-only lines
+            for(;;) {
+                if(!skipBlank(text, scan)) {
+                    return false;
+                }
+
+                if(scan.index >= text.size()) {
+                    return false;
+                }
+
+                if(charClass(text[scan.index]) != CharClass::NEWLINE) {
+                    break;
+                }
+
+                scan.index++;
+                scan.line++;
+                scan.col = 1;
+            }
+
+            if(charClass(text[scan.index]) == CharClass::SLASH) {
+                blockDelete.emplace(Token::Kind::SLASH, m_source, scan.index, scan.index + 1, scan.line, scan.col);
+                scan.index++;
+                scan.col++;
+            }
+
+            for(;;) {
+                if(!skipBlank(text, scan)) {
+                    return false;
+                }
+
+                if(scan.index >= text.size()) {
+                    break;
+                }
+
+                if(charClass(text[scan.index]) == CharClass::NEWLINE) {
+                    scan.index++;
+                    scan.line++;
+                    scan.col = 1;
+                    break;
+                }
+
+                if(!scanPlainWord(text, scan, words.emplace_back())) {
+                    return false;
+                }
+            }
+
+            m_source.seek(scan.index, scan.line, scan.col);
+            m_state = State::PARSING;
+            return true;
+        }
+
     private:
+        [[nodiscard]] static CharClass charClass(const char c) {
+            return CHAR_CLASSES[static_cast<unsigned char>(c)];
+        }
+
+        [[nodiscard]] static bool isAlpha(const char c) {
+            return charClass(c) == CharClass::LETTER || charClass(c) == CharClass::ALPHA;
+        }
+
+        // skips blanks and comments up to the next token on the same line; false if a comment runs past the line
+        [[nodiscard]] static bool skipBlank(const std::string_view text, scan_t &scan) {
+            while(scan.index < text.size()) {
+                const auto c = charClass(text[scan.index]);
+
+                if(c == CharClass::BLANK) {
+                    scan.index++;
+                    scan.col++;
+                    continue;
+                }
+
+                if(c != CharClass::LPAREN) {
+                    break;
+                }
+
+                const auto close = text.find(')', scan.index);
+
+                if(close == std::string_view::npos || text.substr(scan.index, close - scan.index).contains('\n')) {
+                    return false;
+                }
+
+                scan.col += static_cast<int>(close + 1 - scan.index);
+                scan.index = close + 1;
+            }
+
+            return true;
+        }
+
+        [[nodiscard]] bool scanPlainWord(const std::string_view text, scan_t &scan, PlainWord &word) const {
+            const auto kind = WORD_KINDS[static_cast<unsigned char>(text[scan.index])];
+
+            // a letter followed by another one starts an identifier or keyword
+            if(kind == Token::Kind::NONE || (scan.index + 1 < text.size() && isAlpha(text[scan.index + 1]))) {
+                return false;
+            }
+
+            word.letter = Token(kind, m_source, scan.index, scan.index + 1, scan.line, scan.col);
+            scan.index++;
+            scan.col++;
+
+            if(!skipBlank(text, scan) || scan.index >= text.size()) {
+                return false;
+            }
+
+            if(charClass(text[scan.index]) == CharClass::SIGN) {
+                word.sign.emplace(text[scan.index] == '-' ? Token::Kind::MINUS : Token::Kind::PLUS, m_source, scan.index, scan.index + 1, scan.line, scan.col);
+                scan.index++;
+                scan.col++;
+
+                if(!skipBlank(text, scan) || scan.index >= text.size()) {
+                    return false;
+                }
+            }
+
+            const auto start = scan.index;
+            std::uint64_t mantissa = 0;
+            int digits = 0;
+            int fraction = 0;
+
+            const auto consumeDigits = [&](int &count) {
+                while(scan.index < text.size() && charClass(text[scan.index]) == CharClass::DIGIT) {
+                    mantissa = mantissa * 10 + static_cast<std::uint64_t>(text[scan.index] - '0');
+                    digits++;
+                    count++;
+                    scan.index++;
+                }
+            };
+
+            int integral = 0;
+            consumeDigits(integral);
+
+            if(scan.index < text.size() && charClass(text[scan.index]) == CharClass::DOT) {
+                scan.index++;
+                consumeDigits(fraction);
+            }
+
+            // matches number(): digits with an optional fraction, or a dot that is followed by at least one digit
+            if(digits == 0) {
+                return false;
+            }
+
+            // anything but the next word, a comment or the end of the line makes this an expression
+            if(scan.index < text.size()) {
+                const auto c = charClass(text[scan.index]);
+
+                if(c != CharClass::BLANK && c != CharClass::NEWLINE && c != CharClass::LPAREN && c != CharClass::LETTER) {
+                    return false;
+                }
+            }
+
+            word.number = Token(Token::Kind::NUMBER, m_source, start, scan.index, scan.line, scan.col);
+            scan.col += static_cast<int>(scan.index - start);
+
+            // below 2^53 both operands are exact, so the division rounds exactly like from_chars would
+            if(digits <= 15) {
+                static constexpr std::array<double, 16> POWERS = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+                word.value = static_cast<double>(mantissa) / POWERS[fraction];
+                return true;
+            }
+
+            const auto value = fromChars(word.number.text());
+
+            if(!value) {
+                return false;
+            }
+
+            word.value = *value;
+            return true;
+        }
+
         [[nodiscard]] std::expected<Token, Error> string() {
             while(!match('"') && !end()) {
                 if(match('\'')) {
@@ -260,7 +515,7 @@ namespace ngc
         }
 
         [[nodiscard]] Token makeToken(const Token::Kind kind) const {
-            return { kind, std::make_unique<StringViewTokenSource>(m_source.text(), m_source.name(), m_index, index(), m_line, m_col) };
+            return { kind, m_source, m_index, index(), m_line, m_col };
         }
 
         [[nodiscard]] bool match(const char c) {
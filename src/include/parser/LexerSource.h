@@ -1,11 +1,17 @@
 #pragma once
 
+#include <expected>
+#include <filesystem>
+#include <ios>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <stack>
 #include <print>
 
+#include "parser/MappedFile.h"
+
 namespace ngc
 {
     class LexerSource {
@@ -15,7 +21,10 @@ namespace ngc
             int col;
         };
 
-        std::string m_text;
+        // the text is either owned or a read-only file mapping; m_text views whichever one is in use
+        std::string m_storage;
+        MappedFile m_mapping;
+        std::string_view m_text;
         std::string m_name;
         std::stack<state_t> m_state;
 
@@ -24,11 +33,23 @@ namespace ngc
 
     public:
         LexerSource(const LexerSource &) = delete;
-        LexerSource(LexerSource &&)  noexcept = default;
+        LexerSource(LexerSource &&) = delete;
         LexerSource &operator=(const LexerSource &) = delete;
-        LexerSource &operator=(LexerSource &&) = default;
+        LexerSource &operator=(LexerSource &&) = delete;
+
+        LexerSource(std::string text, std::string name) : m_storage(std::move(text)), m_text(m_storage), m_name(std::move(name)), m_state(std::initializer_list<state_t> {{ 0, 1, 1 }}) { }
+        LexerSource(MappedFile mapping, std::string name) : m_mapping(std::move(mapping)), m_text(m_mapping.text()), m_name(std::move(name)), m_state(std::initializer_list<state_t> {{ 0, 1, 1 }}) { }
+
+        // maps the file instead of reading it, so tokens and AST nodes view the page cache directly
+        static std::expected<std::unique_ptr<LexerSource>, std::ios_base::failure> open(const std::filesystem::path &path) {
+            auto mapping = MappedFile::open(path);
+
+            if(!mapping) {
+                return std::unexpected(std::move(mapping.error()));
+            }
 
-        LexerSource(std::string text, std::string name) : m_text(std::move(text)), m_name(std::move(name)), m_state(std::initializer_list<state_t> {{ 0, 1, 1 }}) { }
+            return std::make_unique<LexerSource>(std::move(*mapping), path.string());
+        }
 
         void reset() {
             while(!m_state.empty()) {
@@ -90,12 +111,17 @@ namespace ngc
             return state().index >= m_text.size();
         }
 
+        // moves to a position the caller has scanned to itself, so line and col must already account for the skipped text
+        void seek(const size_t index, const int line, const int col) {
+            state() = { index, line, col };
+        }
+
         [[nodiscard]] std::string_view text() const {
             return m_text;
         }
 
         [[nodiscard]] std::string_view text(const size_t start, const size_t end) const {
-            return std::string_view(m_text).substr(start, end - start);
+            return m_text.substr(start, end - start);
         }
 
     private:
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <ios>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace ngc {
+    // Read-only view of a whole file mapped into memory. The file must not be truncated while mapped.
+    class MappedFile {
+        const char *m_data = nullptr;
+        std::size_t m_size = 0;
+
+        MappedFile(const char *data, const std::size_t size) : m_data(data), m_size(size) { }
+
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) { }
+
+        MappedFile &operator=(MappedFile &&other) noexcept {
+            if(this != &other) {
+                unmap();
+                m_data = std::exchange(other.m_data, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+            }
+
+            return *this;
+        }
+
+        ~MappedFile() {
+            unmap();
+        }
+
+        [[nodiscard]] std::string_view text() const { return { m_data, m_size }; }
+        [[nodiscard]] std::size_t size() const { return m_size; }
+
+        static std::expected<MappedFile, std::ios_base::failure> open(const std::filesystem::path &path) {
+#ifdef _WIN32
+            const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+            if(file == INVALID_HANDLE_VALUE) {
+                return std::unexpected(std::ios_base::failure(std::format("failed to open '{}'", path.string())));
+            }
+
+            LARGE_INTEGER fileSize;
+
+            if(!GetFileSizeEx(file, &fileSize)) {
+                CloseHandle(file);
+                return std::unexpected(std::ios_base::failure(std::format("failed to determine size of '{}'", path.string())));
+            }
+
+            if(fileSize.QuadPart == 0) {
+                CloseHandle(file);
+                return MappedFile();
+            }
+
+            const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+
+            if(!mapping) {
+                return std::unexpected(std::ios_base::failure(std::format("failed to map '{}'", path.string())));
+            }
+
+            const auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+
+            if(!data) {
+                return std::unexpected(std::ios_base::failure(std::format("failed to map '{}'", path.string())));
+            }
+
+            return MappedFile(static_cast<const char *>(data), static_cast<std::size_t>(fileSize.QuadPart));
+#else
+            const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if(fd < 0) {
+                return std::unexpected(std::ios_base::failure(std::format("failed to open '{}'", path.string())));
+            }
+
+            struct stat status {};
+
+            if(fstat(fd, &status) != 0 || status.st_size < 0) {
+                ::close(fd);
+                return std::unexpected(std::ios_base::failure(std::format("failed to determine size of '{}'", path.string())));
+            }
+
+            if(static_cast<std::uintmax_t>(status.st_size) > std::numeric_limits<std::size_t>::max()) {
+                ::close(fd);
+                return std::unexpected(std::ios_base::failure(std::format("'{}' is too large to map", path.string())));
+            }
+
+            const auto size = static_cast<std::size_t>(status.st_size);
+
+            if(size == 0) {
+                ::close(fd);
+                return MappedFile();
+            }
+
+            const auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+
+            if(data == MAP_FAILED) {
+                return std::unexpected(std::ios_base::failure(std::format("failed to map '{}'", path.string())));
+            }
+
+            // the lexer walks the file front to back exactly once
+            madvise(data, size, MADV_SEQUENTIAL);
+            return MappedFile(static_cast<const char *>(data), size);
+#endif
+        }
+
+    private:
+        void unmap() {
+            if(!m_data) {
+                return;
+            }
+
+#ifdef _WIN32
+            UnmapViewOfFile(m_data);
+#else
+            munmap(const_cast<char *>(m_data), m_size);
+#endif
+            m_data = nullptr;
+            m_size = 0;
+        }
+    };
+}
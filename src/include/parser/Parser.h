@@ -1,12 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <print>
+#include <span>
 #include <stdexcept>
 #include <vector>
-#include <memory>
 #include <tuple>
 #include <stack>
 
+#include "parser/AstArena.h"
 #include "parser/Lexer.h"
 #include "parser/Expression.h"
 #include "parser/Statement.h"
@@ -15,6 +17,11 @@ namespace ngc
 {
     class Parser final {
         Lexer &m_lexer;
+        AstArena &m_arena;
+        // children of the nodes currently being parsed; each node moves its own tail into the arena when complete
+        std::vector<const void *> m_scratch;
+        std::vector<Lexer::PlainWord> m_plainWords;
+        bool m_started = false;
         bool m_percentFirst = false;
         bool m_finished = false;
         std::stack<bool> m_skipNewlines;
@@ -30,7 +37,7 @@ namespace ngc
         };
 
     public:
-        explicit Parser(Lexer &lexer): m_lexer(lexer), m_skipNewlines({true}) { }
+        Parser(Lexer &lexer, AstArena &arena): m_lexer(lexer), m_arena(arena), m_skipNewlines({true}) { }
 
         class Error final : public std::logic_error {
             std::optional<Token> m_token;
@@ -57,39 +64,66 @@ namespace ngc
             }
         };
 
-        std::expected<std::vector<std::unique_ptr<Statement>>, Error> parse() {
-            std::vector<std::unique_ptr<Statement>> statements;
-
+        std::expected<std::span<const Statement * const>, Error> parse() {
             try {
-                if(match(Token::Kind::PERCENT)) {
-                    m_percentFirst = true;
-                }
+                const auto mark = m_scratch.size();
+                start();
 
                 while(auto statement = parseStatement()) {
-                    statements.emplace_back(std::move(statement));
+                    m_scratch.emplace_back(statement);
                 }
+
+                return collect<Statement>(mark);
             } catch(Error &err) {
                 return std::unexpected(std::move(err));
             }
+        }
 
-            return { std::move(statements) };
+        // parses a single top-level statement, nullptr once the input is exhausted
+        std::expected<const Statement *, Error> next() {
+            try {
+                start();
+                return parseStatement();
+            } catch(Error &err) {
+                return std::unexpected(std::move(err));
+            }
         }
 
     private:
-        std::unique_ptr<CompoundStatement> parseCompoundStatement() {
+        void start() {
+            if(m_started) {
+                return;
+            }
+
+            m_started = true;
+
+            if(match(Token::Kind::PERCENT)) {
+                m_percentFirst = true;
+            }
+        }
+
+        const CompoundStatement *parseCompoundStatement() {
             auto startToken = expect(Token::Kind::LBRACE);
-            std::vector<std::unique_ptr<Statement>> statements;
+            const auto mark = m_scratch.size();
 
             while(auto statement = parseStatement()) {
-                statements.emplace_back(std::move(statement));
+                m_scratch.emplace_back(statement);
             }
 
             Token endToken = expect(Token::Kind::RBRACE);
-            return std::make_unique<CompoundStatement>(std::move(startToken), std::move(endToken), std::move(statements));
+            return m_arena.make<CompoundStatement>(startToken, endToken, collect<Statement>(mark));
         }
 
-        [[nodiscard]] std::unique_ptr<Statement> parseStatement() {
-            if(m_finished || match(Token::Kind::NONE)) {
+        [[nodiscard]] const Statement *parseStatement() {
+            if(m_finished) {
+                return nullptr;
+            }
+
+            if(const auto block = parsePlainBlockStatement()) {
+                return block;
+            }
+
+            if(match(Token::Kind::NONE)) {
                 return nullptr;
             }
 
@@ -125,15 +159,15 @@ namespace ngc
             }
 
             if(match(token, Token::Kind::BREAK)) {
-                return std::make_unique<BreakStatement>(token);
+                return m_arena.make<BreakStatement>(token);
             }
 
             if(match(token, Token::Kind::CONTINUE)) {
-                return std::make_unique<ContinueStatement>(token);
+                return m_arena.make<ContinueStatement>(token);
             }
 
             if(match(token, Token::Kind::RETURN)) {
-                return std::make_unique<ReturnStatement>(token, expect<RealExpression>(parseExpression()));
+                return m_arena.make<ReturnStatement>(token, expect<RealExpression>(parseExpression()));
             }
 
             if(check(Token::Kind::ALIAS)) {
@@ -150,10 +184,34 @@ namespace ngc
                 return parseBlockStatement();
             }
 
-            return std::make_unique<ExpressionStatement>(parseExpression());
+            return m_arena.make<ExpressionStatement>(parseExpression());
         }
 
-        [[nodiscard]] std::unique_ptr<BlockStatement> parseBlockStatement() {
+        // builds a block of literal words straight from the lexer's scan, skipping the expression grammar
+        [[nodiscard]] const BlockStatement *parsePlainBlockStatement() {
+            std::optional<Token> blockDelete = std::nullopt;
+            m_plainWords.clear();
+
+            if(!skipNewlines() || !m_lexer.scanPlainBlock(blockDelete, m_plainWords)) {
+                return nullptr;
+            }
+
+            const auto words = m_arena.array<const WordExpression *>(m_plainWords.size());
+
+            for(size_t i = 0; const auto &word : m_plainWords) {
+                const RealExpression *real = m_arena.make<LiteralExpression>(word.number, word.value);
+
+                if(word.sign) {
+                    real = m_arena.make<UnaryExpression>(*word.sign, real);
+                }
+
+                words[i++] = m_arena.make<WordExpression>(word.letter, real);
+            }
+
+            return m_arena.make<BlockStatement>(blockDelete, words);
+        }
+
+        [[nodiscard]] const BlockStatement *parseBlockStatement() {
             Token token;
             std::optional<Token> blockDelete = std::nullopt;
 
@@ -168,186 +226,186 @@ namespace ngc
                 blockDelete.emplace(token);
             }
 
-            std::vector<std::unique_ptr<WordExpression>> expressions;
+            const auto mark = m_scratch.size();
 
             for(;;) {
                 if(match(Token::Kind::NEWLINE, Token::Kind::NONE)) {
-                    auto block = std::make_unique<BlockStatement>(std::move(blockDelete), std::move(expressions));
-                    return block;
+                    return m_arena.make<BlockStatement>(blockDelete, collect<WordExpression>(mark));
                 }
 
-                expressions.emplace_back(expect<WordExpression>(parsePrimaryExpression()));
+                m_scratch.emplace_back(expect<WordExpression>(parsePrimaryExpression()));
             }
         }
 
-        [[nodiscard]] std::unique_ptr<SubStatement> parseSubStatement() {
+        [[nodiscard]] const SubStatement *parseSubStatement() {
             auto startToken = expect(Token::Kind::SUB);
             auto identifier = expect(Token::Kind::IDENTIFIER);
             std::ignore = expect(Token::Kind::LBRACKET);
 
-            auto params = std::vector<std::unique_ptr<NamedVariableExpression>>();
+            const auto mark = m_scratch.size();
 
             if(!check(Token::Kind::RBRACKET)) {
                 do {
-                    params.emplace_back(expect<NamedVariableExpression>(parseExpression()));
+                    m_scratch.emplace_back(expect<NamedVariableExpression>(parseExpression()));
                 } while(match(Token::Kind::COMMA));
             }
 
             std::ignore = expect(Token::Kind::RBRACKET);
-            return std::make_unique<SubStatement>(startToken, identifier, std::move(params), parseCompoundStatement());
+            const auto params = collect<NamedVariableExpression>(mark);
+            return m_arena.make<SubStatement>(startToken, identifier, params, parseCompoundStatement());
         }
 
-        [[nodiscard]] std::unique_ptr<IfStatement> parseIfStatement() {
+        [[nodiscard]] const IfStatement *parseIfStatement() {
             auto startToken = expect(Token::Kind::IF);
             auto condition = expect<RealExpression>(parseExpression());
             auto statements = parseCompoundStatement();
 
-            std::unique_ptr<CompoundStatement> elseStatements;
+            const CompoundStatement *elseStatements = nullptr;
 
             if(match(Token::Kind::ELSE)) {
                 elseStatements = parseCompoundStatement();
             }
 
-            return std::make_unique<IfStatement>(startToken, std::move(condition), std::move(statements), std::move(elseStatements));
+            return m_arena.make<IfStatement>(startToken, condition, statements, elseStatements);
         }
 
-        [[nodiscard]] std::unique_ptr<WhileStatement> parseWhileStatement() {
+        [[nodiscard]] const WhileStatement *parseWhileStatement() {
             auto startToken = expect(Token::Kind::WHILE);
             auto condition = expect<RealExpression>(parseExpression());
             auto statements = parseCompoundStatement();
-            return std::make_unique<WhileStatement>(startToken, std::move(condition), std::move(statements));
+            return m_arena.make<WhileStatement>(startToken, condition, statements);
         }
 
-        [[nodiscard]] std::unique_ptr<AliasStatement> parseAliasStatement() {
+        [[nodiscard]] const AliasStatement *parseAliasStatement() {
             auto startToken = expect(Token::Kind::ALIAS);
             auto namedVariable = expect<NamedVariableExpression>(parsePrimaryExpression());
             std::ignore = expect(Token::Kind::ASSIGN);
-            return std::make_unique<AliasStatement>(startToken, std::move(namedVariable), expect<RealExpression>(parseExpression()));
+            return m_arena.make<AliasStatement>(startToken, namedVariable, expect<RealExpression>(parseExpression()));
         }
 
-        [[nodiscard]] std::unique_ptr<LetStatement> parseLetStatement() {
+        [[nodiscard]] const LetStatement *parseLetStatement() {
             auto startToken = expect(Token::Kind::LET);
             auto namedVariable = expect<NamedVariableExpression>(parsePrimaryExpression());
-            std::unique_ptr<RealExpression> realExpression;
+            const RealExpression *realExpression = nullptr;
 
             if(match(Token::Kind::ASSIGN)) {
                 realExpression = expect<RealExpression>(parseExpression());
             }
 
-            return std::make_unique<LetStatement>(startToken, std::move(namedVariable), std::move(realExpression));
+            return m_arena.make<LetStatement>(startToken, namedVariable, realExpression);
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseExpression() {
+        [[nodiscard]] const Expression *parseExpression() {
             auto expr = parseAssignmentExpression();
             return expr;
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseAssignmentExpression() {
+        [[nodiscard]] const Expression *parseAssignmentExpression() {
             auto expression = parseOrXorExpression();
 
             if(Token token; match(token, Token::Kind::ASSIGN)) {
-                auto left = expect<VariableExpression>(std::move(expression));
+                auto left = expect<VariableExpression>(expression);
                 auto right = expect<RealExpression>(parseAssignmentExpression());
-                return std::make_unique<BinaryExpression>(token, std::move(left), std::move(right));
+                return m_arena.make<BinaryExpression>(token, left, right);
             }
 
             return expression;
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseOrXorExpression() {
+        [[nodiscard]] const Expression *parseOrXorExpression() {
             auto expression = parseAndExpression();
             Token token;
 
             while(match(token, Token::Kind::OR, Token::Kind::XOR)) {
-                auto left = expect<RealExpression>(std::move(expression));
+                auto left = expect<RealExpression>(expression);
                 auto right = expect<RealExpression>(parseAndExpression());
-                expression = std::make_unique<BinaryExpression>(token, std::move(left), std::move(right));
+                expression = m_arena.make<BinaryExpression>(token, left, right);
             }
 
             return expression;
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseAndExpression() {
+        [[nodiscard]] const Expression *parseAndExpression() {
             auto expression = parseComparisonExpression();
             Token token;
 
             while(match(token, Token::Kind::AND)) {
-                auto left = expect<RealExpression>(std::move(expression));
+                auto left = expect<RealExpression>(expression);
                 auto right = expect<RealExpression>(parseComparisonExpression());
-                expression = std::make_unique<BinaryExpression>(token, std::move(left), std::move(right));
+                expression = m_arena.make<BinaryExpression>(token, left, right);
             }
 
             return expression;
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseComparisonExpression() {
+        [[nodiscard]] const Expression *parseComparisonExpression() {
             auto expression = parseAddSubExpression();
             Token token;
 
             while(match(token, Token::Kind::EQ, Token::Kind::NE, Token::Kind::LT, Token::Kind::LE, Token::Kind::GT, Token::Kind::GE)) {
-                auto left = expect<RealExpression>(std::move(expression));
+                auto left = expect<RealExpression>(expression);
                 auto right = expect<RealExpression>(parseAddSubExpression());
-                expression = std::make_unique<BinaryExpression>(token, std::move(left), std::move(right));
+                expression = m_arena.make<BinaryExpression>(token, left, right);
             }
 
             return expression;
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseAddSubExpression() {
+        [[nodiscard]] const Expression *parseAddSubExpression() {
             auto expression = parseMulDivModExpression();
             Token token;
 
             while(match(token, Token::Kind::PLUS, Token::Kind::MINUS)) {
-                auto left = expect<RealExpression>(std::move(expression));
+                auto left = expect<RealExpression>(expression);
                 auto right = expect<RealExpression>(parseMulDivModExpression());
-                expression = std::make_unique<BinaryExpression>(token, std::move(left), std::move(right));
+                expression = m_arena.make<BinaryExpression>(token, left, right);
             }
 
             return expression;
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseMulDivModExpression() {
+        [[nodiscard]] const Expression *parseMulDivModExpression() {
             auto expression = parseUnaryExpression();
             Token token;
 
             while(match(token, Token::Kind::MUL, Token::Kind::SLASH, Token::Kind::MOD)) {
-                auto left = expect<RealExpression>(std::move(expression));
+                auto left = expect<RealExpression>(expression);
                 auto right = expect<RealExpression>(parseUnaryExpression());
-                expression = std::make_unique<BinaryExpression>(token, std::move(left), std::move(right));
+                expression = m_arena.make<BinaryExpression>(token, left, right);
             }
 
             return expression;
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parseUnaryExpression() {
+        [[nodiscard]] const Expression *parseUnaryExpression() {
             if(Token token; match(token, Token::Kind::PLUS, Token::Kind::MINUS)) {
-                return std::make_unique<UnaryExpression>(token, expect<RealExpression>(parseUnaryExpression()));
+                return m_arena.make<UnaryExpression>(token, expect<RealExpression>(parseUnaryExpression()));
             }
 
             return parsePrimaryExpression();
         }
 
-        [[nodiscard]] std::unique_ptr<Expression> parsePrimaryExpression() {
+        [[nodiscard]] const Expression *parsePrimaryExpression() {
             const auto token = nextToken();
 
             if(token.is(Token::Kind::COMMENT)) {
-                return std::make_unique<CommentExpression>(token);
+                return m_arena.make<CommentExpression>(token);
             }
 
             if(token.isLetter()) {
-                return std::make_unique<WordExpression>(token, expect<RealExpression>(parseExpression()));
+                return m_arena.make<WordExpression>(token, expect<RealExpression>(parseExpression()));
             }
 
             if(token.is(Token::Kind::NUMBER)) {
-                return std::make_unique<LiteralExpression>(token);
+                return m_arena.make<LiteralExpression>(token);
             }
 
             if(token.is(Token::Kind::POUND)) {
-                return std::make_unique<NumericVariableExpression>(token, expect<RealExpression>(parsePrimaryExpression()));
+                return m_arena.make<NumericVariableExpression>(token, expect<RealExpression>(parsePrimaryExpression()));
             }
 
             if(token.is(Token::Kind::NAMED_VARIABLE)) {
-                return std::make_unique<NamedVariableExpression>(token);
+                return m_arena.make<NamedVariableExpression>(token);
             }
 
             if(token.is(Token::Kind::IDENTIFIER)) {
@@ -359,42 +417,51 @@ namespace ngc
             if(token.is(Token::Kind::LBRACKET)) {
                 auto expression = expect<RealExpression>(parseExpression());
                 auto endToken = expect(Token::Kind::RBRACKET);
-                return std::make_unique<GroupingExpression>(token, endToken, std::move(expression));
+                return m_arena.make<GroupingExpression>(token, endToken, expression);
             }
 
             if(token.is(Token::Kind::AMPERSAND)) {
-                return std::make_unique<UnaryExpression>(token, expect<VariableExpression>(parseExpression()));
+                return m_arena.make<UnaryExpression>(token, expect<VariableExpression>(parseExpression()));
             }
 
             if(token.is(Token::Kind::STRING)) {
-                return std::make_unique<StringExpression>(token);
+                return m_arena.make<StringExpression>(token);
             }
 
             error("unexpected token", token);
         }
 
-        [[nodiscard]] std::unique_ptr<CallExpression> parseCallExpression(const Token &token) {
+        [[nodiscard]] const CallExpression *parseCallExpression(const Token &token) {
             std::ignore = expect(Token::Kind::LBRACKET);
-            auto args = std::vector<std::unique_ptr<ScalarExpression>>();
+            const auto mark = m_scratch.size();
 
             if(!check(Token::Kind::RBRACKET)) {
                 do {
-                    args.emplace_back(expect<ScalarExpression>(parseExpression()));
+                    m_scratch.emplace_back(expect<ScalarExpression>(parseExpression()));
                 } while(match(Token::Kind::COMMA));
             }
 
             auto endToken = expect(Token::Kind::RBRACKET);
-            return std::make_unique<CallExpression>(token, endToken, std::move(args));
+            return m_arena.make<CallExpression>(token, endToken, collect<ScalarExpression>(mark));
+        }
+
+        template<typename T>
+        [[nodiscard]] std::span<const T * const> collect(const std::size_t mark) {
+            const auto items = std::span(m_scratch).subspan(mark);
+            const auto result = m_arena.array<const T *>(items.size());
+            std::ranges::transform(items, result.begin(), [](const void *item) { return static_cast<const T *>(item); });
+            m_scratch.resize(mark);
+            return result;
         }
 
         template<typename T>
-        [[nodiscard]] std::unique_ptr<T> expect(std::unique_ptr<Expression> expression) {
+        [[nodiscard]] const T *expect(const Expression *expression) {
             if(!expression->is<T>()) {
                 auto message = std::format("expected {}, but found '{}'", T::staticClassName(), expression->text());
-                error(message, std::move(expression->token()));
+                error(message, expression->token());
             }
 
-            return std::unique_ptr<T>(static_cast<T *>(expression.release()));
+            return static_cast<const T *>(expression);
         }
 
         [[nodiscard]] Token expect(const Token::Kind kind) {
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <expected>
+#include <filesystem>
+#include <ios>
 #include <memory>
 #include <print>
+#include <span>
 #include <utility>
+#include <vector>
 
+#include "parser/AstArena.h"
 #include "parser/LexerSource.h"
 #include "parser/Lexer.h"
 #include "parser/Parser.h"
@@ -11,9 +18,23 @@
 
 namespace ngc {
     class Program {
-        LexerSource m_source;
-        std::vector<std::unique_ptr<Statement>> m_statements;
-        std::vector<const Statement *> m_ptrStatements;
+        // state of a parse that hands out statements one at a time; heap-held because the parser refers to its
+        // lexer and arena, and the Program may be moved between calls to next()
+        struct stream_t {
+            AstArena arena;
+            Lexer lexer;
+            Parser parser;
+            std::vector<const Statement *> statements;
+
+            explicit stream_t(LexerSource &source) : lexer(source), parser(lexer, arena) { }
+        };
+
+        // tokens point at the source, so it lives behind a stable address while the Program itself moves
+        std::unique_ptr<LexerSource> m_source;
+        // owns every node reachable from m_statements; replaced wholesale by each successful compile
+        AstArena m_arena;
+        std::span<const Statement * const> m_statements;
+        std::unique_ptr<stream_t> m_stream;
         bool m_compiled = false;
 
     public:
@@ -21,33 +42,86 @@ namespace ngc {
         Program(Program &&) = default;
         Program &operator=(const Program &) = delete;
         Program &operator=(Program &&) = default;
-        Program(std::string text, std::string name) : m_source(std::move(text), std::move(name)) { }
+        Program(std::string text, std::string name) : m_source(std::make_unique<LexerSource>(std::move(text), std::move(name))) { }
+        explicit Program(std::unique_ptr<LexerSource> source) : m_source(std::move(source)) { }
+
+        static std::expected<Program, std::ios_base::failure> open(const std::filesystem::path &path) {
+            auto source = LexerSource::open(path);
+
+            if(!source) {
+                return std::unexpected(std::move(source.error()));
+            }
+
+            return Program(std::move(*source));
+        }
 
         bool compiled() const { return m_compiled; }
 
         std::expected<std::span<const Statement * const>, Parser::Error> compile() {
-            m_source.reset();
+            m_stream.reset();
+            m_source->reset();
 
-            auto lexer = Lexer(m_source);
-            auto parser = Parser(lexer);
+            auto arena = AstArena();
+            auto lexer = Lexer(*m_source);
+            auto parser = Parser(lexer, arena);
             auto result = parser.parse();
 
             if(!result) {
                 return std::unexpected(std::move(result.error()));
             }
 
-            m_statements = std::move(*result);
-            m_ptrStatements.clear();
+            m_arena = std::move(arena);
+            m_statements = *result;
+            m_compiled = true;
+            return m_statements;
+        }
+
+        // installs statements that were built without the parser, e.g. read back from a ProgramCache; they must
+        // be allocated in the arena and their tokens must refer to this Program's source
+        void assign(AstArena arena, const std::span<const Statement * const> statements) {
+            m_stream.reset();
+            m_arena = std::move(arena);
+            m_statements = statements;
+            m_compiled = true;
+        }
+
+        // drops any parse in progress; the following next() starts again from the first statement
+        void restart() {
+            m_stream.reset();
+        }
+
+        // parses only as far as the next top-level statement, so execution can begin before the rest of a large
+        // program has been read. Returns nullptr at the end, at which point the Program is compiled as if by
+        // compile(). Statements returned earlier stay valid until the next restart() or compile().
+        std::expected<const Statement *, Parser::Error> next() {
+            if(!m_stream) {
+                m_source->reset();
+                m_stream = std::make_unique<stream_t>(*m_source);
+            }
+
+            auto result = m_stream->parser.next();
+
+            if(!result) {
+                m_stream.reset();
+                return std::unexpected(std::move(result.error()));
+            }
 
-            for(const auto &statement : m_statements) {
-                m_ptrStatements.emplace_back(statement.get());
+            if(*result) {
+                m_stream->statements.push_back(*result);
+                return *result;
             }
 
+            auto statements = m_stream->arena.array<const Statement *>(m_stream->statements.size());
+            std::ranges::copy(m_stream->statements, statements.begin());
+            m_arena = std::move(m_stream->arena);
+            m_statements = statements;
             m_compiled = true;
-            return m_ptrStatements;
+            m_stream.reset();
+            return nullptr;
         }
 
-        [[nodiscard]] std::span<const Statement * const> statements() const { return m_ptrStatements; }
-        [[nodiscard]] const LexerSource &source() const { return m_source; }
+        [[nodiscard]] std::span<const Statement * const> statements() const { return m_statements; }
+        [[nodiscard]] const LexerSource &source() const { return *m_source; }
+        [[nodiscard]] const AstArena &arena() const { return m_arena; }
     };
 }
@@ -0,0 +1,741 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parser/AstArena.h"
+#include "parser/Expression.h"
+#include "parser/MappedFile.h"
+#include "parser/Program.h"
+#include "parser/Statement.h"
+#include "parser/Visitor.h"
+
+namespace ngc {
+    // Parsed programs kept on disk between runs of the application. An entry is the AST of one source text,
+    // flattened into a file named after the hash of that text; tokens are stored as positions, so an entry can
+    // only be used with a source of the same hash and size. Missing, outdated or damaged entries are ignored
+    // and the program is parsed as usual.
+    class ProgramCache {
+        // bump whenever the AST or the layout below changes
+        static constexpr std::uint32_t FORMAT_VERSION = 1;
+        static constexpr std::array<char, 8> MAGIC { 'N', 'G', 'C', 'A', 'S', 'T', '\r', '\n' };
+
+        struct header_t {
+            std::array<char, 8> magic;
+            std::uint32_t version;
+            std::uint32_t reserved;
+            std::uint64_t sourceSize;
+            std::uint64_t sourceHash;
+            std::uint64_t statements;
+            // hash of everything after the header, so that a damaged entry is not mistaken for a different tree
+            std::uint64_t payloadHash;
+        };
+
+        static_assert(std::is_trivially_copyable_v<header_t> && sizeof(header_t) == 48);
+
+        // set in the kind byte of a token that refers to the source
+        static constexpr std::uint8_t TOKEN_HAS_SOURCE = 0x80;
+
+        enum class Node : std::uint8_t {
+            None, Array,
+            Comment, Word, Literal, String, NumericVariable, NamedVariable, Unary, Binary, Call, Grouping,
+            ExpressionStatement, Compound, Block, Sub, If, While, Return, Break, Continue, Alias, Let,
+        };
+
+        // Writes the tree in post-order: every record follows the records of its children, which the reader takes
+        // back off a stack. A missing optional child is written as a None record, and the elements of an array are
+        // followed by an Array record with their count. Token positions are varints relative to the previous
+        // token, which keeps an entry within a few times the size of its source.
+        class Writer final : public Visitor {
+            std::string m_data;
+            std::int64_t m_offset = 0;
+            std::int64_t m_line = 0;
+
+        public:
+            explicit Writer(const std::size_t sourceSize) {
+                m_data.reserve(sizeof(header_t) + sourceSize * 2);
+                m_data.resize(sizeof(header_t));
+            }
+
+            std::string finish(const Program &program, const std::uint64_t sourceHash) {
+                nodes(program.statements());
+
+                const auto payload = std::string_view(m_data).substr(sizeof(header_t));
+                const header_t header { MAGIC, FORMAT_VERSION, 0, program.source().text().size(), sourceHash, program.statements().size(), hash(payload) };
+                std::memcpy(m_data.data(), &header, sizeof(header));
+                return std::move(m_data);
+            }
+
+            void visit(const ExpressionStatement *stmt, VisitorContext *) override {
+                node(stmt->expression());
+                put(Node::ExpressionStatement);
+            }
+
+            void visit(const CompoundStatement *stmt, VisitorContext *) override {
+                nodes(stmt->statements());
+                put(Node::Compound);
+                put(stmt->startToken());
+                put(stmt->endToken());
+            }
+
+            void visit(const BlockStatement *stmt, VisitorContext *) override {
+                nodes(stmt->expressions());
+                put(Node::Block);
+                put(static_cast<std::uint8_t>(stmt->blockDelete().has_value()));
+
+                if(stmt->blockDelete()) {
+                    put(*stmt->blockDelete());
+                }
+            }
+
+            void visit(const SubStatement *stmt, VisitorContext *) override {
+                nodes(stmt->params());
+                node(stmt->body());
+                put(Node::Sub);
+                put(stmt->startToken());
+                put(stmt->identifier());
+            }
+
+            void visit(const IfStatement *stmt, VisitorContext *) override {
+                node(stmt->condition());
+                node(stmt->body());
+                node(stmt->elseBody());
+                put(Node::If);
+                put(stmt->startToken());
+            }
+
+            void visit(const WhileStatement *stmt, VisitorContext *) override {
+                node(stmt->condition());
+                node(stmt->body());
+                put(Node::While);
+                put(stmt->startToken());
+            }
+
+            void visit(const ReturnStatement *stmt, VisitorContext *) override {
+                node(stmt->real());
+                put(Node::Return);
+                put(stmt->startToken());
+            }
+
+            void visit(const BreakStatement *stmt, VisitorContext *) override {
+                put(Node::Break);
+                put(stmt->startToken());
+            }
+
+            void visit(const ContinueStatement *stmt, VisitorContext *) override {
+                put(Node::Continue);
+                put(stmt->startToken());
+            }
+
+            void visit(const AliasStatement *stmt, VisitorContext *) override {
+                node(stmt->variable());
+                node(stmt->address());
+                put(Node::Alias);
+                put(stmt->startToken());
+            }
+
+            void visit(const LetStatement *stmt, VisitorContext *) override {
+                node(stmt->variable());
+                node(stmt->value());
+                put(Node::Let);
+                put(stmt->startToken());
+            }
+
+            void visit(const CommentExpression *expr, VisitorContext *) override {
+                put(Node::Comment);
+                put(expr->token());
+            }
+
+            void visit(const WordExpression *expr, VisitorContext *) override {
+                node(expr->real());
+                put(Node::Word);
+                put(expr->token());
+            }
+
+            void visit(const LiteralExpression *expr, VisitorContext *) override {
+                put(Node::Literal);
+                put(expr->token());
+                put(expr->value());
+            }
+
+            void visit(const StringExpression *expr, VisitorContext *) override {
+                put(Node::String);
+                put(expr->token());
+            }
+
+            void visit(const NumericVariableExpression *expr, VisitorContext *) override {
+                node(expr->real());
+                put(Node::NumericVariable);
+                put(expr->token());
+            }
+
+            void visit(const NamedVariableExpression *expr, VisitorContext *) override {
+                put(Node::NamedVariable);
+                put(expr->token());
+            }
+
+            void visit(const UnaryExpression *expr, VisitorContext *) override {
+                node(expr->real());
+                put(Node::Unary);
+                put(expr->token());
+            }
+
+            void visit(const BinaryExpression *expr, VisitorContext *) override {
+                node(expr->left());
+                node(expr->right());
+                put(Node::Binary);
+                put(expr->token());
+            }
+
+            void visit(const CallExpression *expr, VisitorContext *) override {
+                nodes(expr->args());
+                put(Node::Call);
+                put(expr->token());
+                put(expr->endToken());
+            }
+
+            void visit(const GroupingExpression *expr, VisitorContext *) override {
+                node(expr->real());
+                put(Node::Grouping);
+                put(expr->token());
+                put(expr->endToken());
+            }
+
+        private:
+            template<typename T>
+            void node(const T *node) {
+                if(node) {
+                    node->accept(*this, nullptr);
+                } else {
+                    put(Node::None);
+                }
+            }
+
+            template<typename T>
+            void nodes(const std::span<const T * const> nodes) {
+                for(const auto child : nodes) {
+                    node(child);
+                }
+
+                put(Node::Array);
+                varint(nodes.size());
+            }
+
+            template<typename T>
+            void put(const T &value) requires std::is_trivially_copyable_v<T> && (!std::same_as<T, Token>) {
+                m_data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+            }
+
+            void put(const Token &token) {
+                if(!token.source()) {
+                    put(static_cast<std::uint8_t>(token.kind()));
+                    return;
+                }
+
+                const auto offset = static_cast<std::int64_t>(token.offset());
+                put(static_cast<std::uint8_t>(std::to_underlying(token.kind()) | TOKEN_HAS_SOURCE));
+                varint(zigzag(offset - m_offset));
+                varint(token.length());
+                varint(zigzag(token.line() - m_line));
+                varint(static_cast<std::uint32_t>(token.col()));
+                m_offset = offset;
+                m_line = token.line();
+            }
+
+            static std::uint64_t zigzag(const std::int64_t value) {
+                return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+            }
+
+            void varint(std::uint64_t value) {
+                while(value >= 0x80) {
+                    m_data.push_back(static_cast<char>(value | 0x80));
+                    value >>= 7;
+                }
+
+                m_data.push_back(static_cast<char>(value));
+            }
+        };
+
+        // Rebuilds the nodes into the arena, checking every record, so a damaged entry fails instead of producing
+        // a tree that points outside the source or the arena
+        class Reader {
+            struct node_t {
+                union {
+                    const Expression *expression;
+                    const Statement *statement;
+                    std::uint32_t count;
+                };
+                Node kind;
+            };
+
+            std::string_view m_data;
+            std::size_t m_position = 0;
+            const LexerSource &m_source;
+            AstArena &m_arena;
+            std::vector<node_t> m_stack;
+            Node m_kind = Node::None;
+            std::int64_t m_offset = 0;
+            std::int64_t m_line = 0;
+
+        public:
+            Reader(const std::string_view data, const LexerSource &source, AstArena &arena) : m_data(data), m_position(sizeof(header_t)), m_source(source), m_arena(arena) { }
+
+            std::span<const Statement * const> read(const header_t &header) {
+                while(m_position < m_data.size()) {
+                    readNode();
+                }
+
+                const auto statements = array<Statement>();
+
+                if(!m_stack.empty() || statements.size() != header.statements) {
+                    fail();
+                }
+
+                return statements;
+            }
+
+        private:
+            [[noreturn]] static void fail() {
+                throw std::runtime_error("damaged program cache entry");
+            }
+
+            template<typename T>
+            T get() requires std::is_trivially_copyable_v<T> {
+                if(m_data.size() - m_position < sizeof(T)) {
+                    fail();
+                }
+
+                T value;
+                std::memcpy(&value, m_data.data() + m_position, sizeof(T));
+                m_position += sizeof(T);
+                return value;
+            }
+
+            std::uint64_t varint() {
+                std::uint64_t value = 0;
+
+                for(int shift = 0; shift < 64; shift += 7) {
+                    const auto byte = get<std::uint8_t>();
+                    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+                    if(!(byte & 0x80)) {
+                        return value;
+                    }
+                }
+
+                fail();
+            }
+
+            std::int64_t zigzag() {
+                const auto value = varint();
+                return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+            }
+
+            Token token() {
+                const auto byte = get<std::uint8_t>();
+                const auto kind = static_cast<std::uint8_t>(byte & ~TOKEN_HAS_SOURCE);
+
+                if(kind > std::to_underlying(Token::Kind::LET)) {
+                    fail();
+                }
+
+                if(!(byte & TOKEN_HAS_SOURCE)) {
+                    return Token(static_cast<Token::Kind>(kind));
+                }
+
+                const auto size = m_source.text().size();
+                const auto offset = m_offset + zigzag();
+                const auto length = varint();
+                const auto line = m_line + zigzag();
+                const auto col = varint();
+
+                if(offset < 0 || static_cast<std::uint64_t>(offset) > size || length > size - static_cast<std::uint64_t>(offset)
+                   || line < 0 || line > std::numeric_limits<int>::max() || col > std::numeric_limits<int>::max()) {
+                    fail();
+                }
+
+                m_offset = offset;
+                m_line = line;
+                return Token(static_cast<Token::Kind>(kind), m_source, offset, offset + length, static_cast<int>(line), static_cast<int>(col));
+            }
+
+            // whether a node of the given kind may be referred to as a T; decided from the recorded kind, which is
+            // cheaper than asking the node itself
+            template<typename T>
+            static constexpr bool accepts(const Node kind) {
+                if constexpr(std::same_as<T, Expression>) {
+                    return kind >= Node::Comment && kind < Node::ExpressionStatement;
+                } else if constexpr(std::same_as<T, ScalarExpression>) {
+                    return kind == Node::String || accepts<RealExpression>(kind);
+                } else if constexpr(std::same_as<T, RealExpression>) {
+                    switch(kind) {
+                        case Node::Literal: case Node::NumericVariable: case Node::NamedVariable: case Node::Unary:
+                        case Node::Binary: case Node::Call: case Node::Grouping:
+                            return true;
+                        default:
+                            return false;
+                    }
+                } else if constexpr(std::same_as<T, WordExpression>) {
+                    return kind == Node::Word;
+                } else if constexpr(std::same_as<T, NamedVariableExpression>) {
+                    return kind == Node::NamedVariable;
+                } else if constexpr(std::same_as<T, Statement>) {
+                    return kind >= Node::ExpressionStatement;
+                } else {
+                    static_assert(std::same_as<T, CompoundStatement>);
+                    return kind == Node::Compound;
+                }
+            }
+
+            template<typename T>
+            const T *optionalNode() {
+                if(m_stack.empty()) {
+                    fail();
+                }
+
+                const auto node = m_stack.back();
+                m_stack.pop_back();
+
+                if(node.kind == Node::None) {
+                    return nullptr;
+                }
+
+                if(!accepts<T>(node.kind)) {
+                    fail();
+                }
+
+                if constexpr(std::derived_from<T, Expression>) {
+                    return static_cast<const T *>(node.expression);
+                } else {
+                    return static_cast<const T *>(node.statement);
+                }
+            }
+
+            template<typename T>
+            const T *node() {
+                const auto result = optionalNode<T>();
+
+                if(!result) {
+                    fail();
+                }
+
+                return result;
+            }
+
+            // takes the elements of an array off the stack, below the entry that carries their count
+            template<typename T>
+            std::span<const T * const> array() {
+                if(m_stack.empty() || m_stack.back().kind != Node::Array) {
+                    fail();
+                }
+
+                const auto count = static_cast<std::size_t>(m_stack.back().count);
+                m_stack.pop_back();
+
+                if(count > m_stack.size()) {
+                    fail();
+                }
+
+                auto result = m_arena.array<const T *>(count);
+
+                for(auto it = result.rbegin(); it != result.rend(); ++it) {
+                    *it = node<T>();
+                }
+
+                return result;
+            }
+
+            template<typename T, typename ...Args>
+            void make(Args &&...args) {
+                const auto node = m_arena.make<T>(std::forward<Args>(args)...);
+                auto &entry = m_stack.emplace_back();
+                entry.kind = m_kind;
+
+                if constexpr(std::derived_from<T, Expression>) {
+                    entry.expression = node;
+                } else {
+                    entry.statement = node;
+                }
+            }
+
+            void readNode() {
+                m_kind = get<Node>();
+
+                switch(m_kind) {
+                    case Node::None: {
+                        m_stack.emplace_back().kind = Node::None;
+                        return;
+                    }
+                    case Node::Array: {
+                        const auto count = varint();
+
+                        if(count > std::numeric_limits<std::uint32_t>::max()) {
+                            fail();
+                        }
+
+                        auto &entry = m_stack.emplace_back();
+                        entry.kind = Node::Array;
+                        entry.count = static_cast<std::uint32_t>(count);
+                        return;
+                    }
+                    case Node::Comment: {
+                        return make<CommentExpression>(token());
+                    }
+                    case Node::Word: {
+                        const auto real = node<RealExpression>();
+                        return make<WordExpression>(token(), real);
+                    }
+                    case Node::Literal: {
+                        const auto token = this->token();
+                        return make<LiteralExpression>(token, get<double>());
+                    }
+                    case Node::String: {
+                        return make<StringExpression>(token());
+                    }
+                    case Node::NumericVariable: {
+                        const auto real = node<RealExpression>();
+                        return make<NumericVariableExpression>(token(), real);
+                    }
+                    case Node::NamedVariable: {
+                        return make<NamedVariableExpression>(token());
+                    }
+                    case Node::Unary: {
+                        const auto real = node<RealExpression>();
+                        return make<UnaryExpression>(token(), real);
+                    }
+                    case Node::Binary: {
+                        const auto right = node<RealExpression>();
+                        const auto left = node<RealExpression>();
+                        return make<BinaryExpression>(token(), left, right);
+                    }
+                    case Node::Call: {
+                        const auto args = array<ScalarExpression>();
+                        const auto token = this->token();
+                        return make<CallExpression>(token, this->token(), args);
+                    }
+                    case Node::Grouping: {
+                        const auto real = node<RealExpression>();
+                        const auto token = this->token();
+                        return make<GroupingExpression>(token, this->token(), real);
+                    }
+                    case Node::ExpressionStatement: {
+                        return make<ExpressionStatement>(node<Expression>());
+                    }
+                    case Node::Compound: {
+                        const auto statements = array<Statement>();
+                        const auto startToken = token();
+                        return make<CompoundStatement>(startToken, token(), statements);
+                    }
+                    case Node::Block: {
+                        const auto expressions = array<WordExpression>();
+                        std::optional<Token> blockDelete;
+
+                        if(get<std::uint8_t>()) {
+                            blockDelete = token();
+                        }
+
+                        if(!blockDelete && expressions.empty()) {
+                            fail();
+                        }
+
+                        return make<BlockStatement>(blockDelete, expressions);
+                    }
+                    case Node::Sub: {
+                        const auto body = node<CompoundStatement>();
+                        const auto params = array<NamedVariableExpression>();
+                        const auto startToken = token();
+                        return make<SubStatement>(startToken, token(), params, body);
+                    }
+                    case Node::If: {
+                        const auto elseBody = optionalNode<CompoundStatement>();
+                        const auto body = node<CompoundStatement>();
+                        const auto condition = node<RealExpression>();
+                        return make<IfStatement>(token(), condition, body, elseBody);
+                    }
+                    case Node::While: {
+                        const auto body = node<CompoundStatement>();
+                        const auto condition = node<RealExpression>();
+                        return make<WhileStatement>(token(), condition, body);
+                    }
+                    case Node::Return: {
+                        const auto real = node<RealExpression>();
+                        return make<ReturnStatement>(token(), real);
+                    }
+                    case Node::Break: {
+                        return make<BreakStatement>(token());
+                    }
+                    case Node::Continue: {
+                        return make<ContinueStatement>(token());
+                    }
+                    case Node::Alias: {
+                        const auto address = node<RealExpression>();
+                        const auto variable = node<NamedVariableExpression>();
+                        return make<AliasStatement>(token(), variable, address);
+                    }
+                    case Node::Let: {
+                        const auto value = optionalNode<RealExpression>();
+                        const auto variable = node<NamedVariableExpression>();
+                        return make<LetStatement>(token(), variable, value);
+                    }
+                }
+
+                fail();
+            }
+        };
+
+        std::filesystem::path m_directory;
+        std::size_t m_maxEntries;
+
+        // drops the least recently used entries beyond m_maxEntries; load() refreshes the time of the entries it uses
+        void prune() const {
+            std::error_code error;
+            std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+
+            for(const auto &entry : std::filesystem::directory_iterator(m_directory, error)) {
+                if(entry.path().extension() == ".ast") {
+                    entries.emplace_back(entry.last_write_time(error), entry.path());
+                }
+            }
+
+            if(error || entries.size() <= m_maxEntries) {
+                return;
+            }
+
+            std::ranges::sort(entries, std::greater());
+
+            for(const auto &[time, path] : std::span(entries).subspan(m_maxEntries)) {
+                std::filesystem::remove(path, error);
+            }
+        }
+
+    public:
+        static constexpr std::size_t DEFAULT_MAX_ENTRIES = 64;
+
+        explicit ProgramCache(std::filesystem::path directory, const std::size_t maxEntries = DEFAULT_MAX_ENTRIES) : m_directory(std::move(directory)), m_maxEntries(maxEntries) { }
+
+        [[nodiscard]] const std::filesystem::path &directory() const { return m_directory; }
+
+        // unlike std::hash, gives the same value in every build; reads eight bytes per step so that hashing a large
+        // program costs little next to loading it
+        [[nodiscard]] static std::uint64_t hash(const std::string_view text) {
+            constexpr std::uint64_t MULTIPLIER = 0x9e3779b97f4a7c15;
+            std::uint64_t result = text.size() * MULTIPLIER;
+            std::size_t i = 0;
+
+            const auto mix = [&](const std::uint64_t word) {
+                result = (result ^ word) * MULTIPLIER;
+                result ^= result >> 32;
+            };
+
+            for(; i + sizeof(std::uint64_t) <= text.size(); i += sizeof(std::uint64_t)) {
+                std::uint64_t word;
+                std::memcpy(&word, text.data() + i, sizeof(word));
+                mix(word);
+            }
+
+            std::uint64_t tail = 0;
+
+            if(i < text.size()) {
+                std::memcpy(&tail, text.data() + i, text.size() - i);
+            }
+
+            mix(tail);
+            return result;
+        }
+
+        [[nodiscard]] std::filesystem::path entryPath(const std::uint64_t sourceHash) const {
+            return m_directory / std::format("{:016x}.ast", sourceHash);
+        }
+
+        // compiles the program from its entry, if there is a usable one; the program is left untouched otherwise
+        bool load(Program &program) const {
+            const auto &source = program.source();
+            const auto sourceHash = hash(source.text());
+            const auto path = entryPath(sourceHash);
+            const auto file = MappedFile::open(path);
+
+            if(!file || file->size() < sizeof(header_t)) {
+                return false;
+            }
+
+            header_t header;
+            std::memcpy(&header, file->text().data(), sizeof(header));
+
+            if(header.magic != MAGIC || header.version != FORMAT_VERSION || header.sourceSize != source.text().size() || header.sourceHash != sourceHash
+               || header.payloadHash != hash(file->text().substr(sizeof(header_t)))) {
+                return false;
+            }
+
+            try {
+                AstArena arena;
+                const auto statements = Reader(file->text(), source, arena).read(header);
+                program.assign(std::move(arena), statements);
+            } catch(const std::exception &) {
+                return false;
+            }
+
+            std::error_code error;
+            std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+            return true;
+        }
+
+        // writes the entry of a compiled program; the entry is replaced atomically, so a concurrent load() sees
+        // either the old or the new one
+        bool store(const Program &program) const {
+            if(!program.compiled()) {
+                return false;
+            }
+
+            const auto sourceHash = hash(program.source().text());
+            const auto data = Writer(program.source().text().size()).finish(program, sourceHash);
+            const auto path = entryPath(sourceHash);
+            auto temporary = path;
+            temporary += std::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+            std::error_code error;
+            std::filesystem::create_directories(m_directory, error);
+
+            if(error) {
+                return false;
+            }
+
+            {
+                std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+                stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+                if(!stream.flush()) {
+                    stream.close();
+                    std::filesystem::remove(temporary, error);
+                    return false;
+                }
+            }
+
+            std::filesystem::rename(temporary, path, error);
+
+            if(error) {
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+
+            prune();
+            return true;
+        }
+    };
+}
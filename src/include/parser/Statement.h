@@ -1,10 +1,9 @@
 #pragma once
 
-#include <memory>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <utility>
-#include <vector>
 
 #include "parser/Token.h"
 #include "parser/Expression.h"
@@ -12,9 +11,12 @@
 
 namespace ngc
 {
+    // Statements live in the Program's AstArena and are never deleted individually.
     class Statement {
+    protected:
+        ~Statement() = default;
+
     public:
-        virtual ~Statement() = default;
         [[nodiscard]] virtual const Token &startToken() const = 0;
         [[nodiscard]] virtual const Token &endToken() const = 0;
 
@@ -51,45 +53,41 @@ namespace ngc
     };
 
     class ExpressionStatement final : public Statement {
-        std::unique_ptr<Expression> m_expression;
+        const Expression *m_expression;
 
     public:
-        explicit ExpressionStatement(std::unique_ptr<Expression> expression): m_expression(std::move(expression)) { }
-        ~ExpressionStatement() override = default;
+        explicit ExpressionStatement(const Expression *expression): m_expression(expression) { }
         bool is(const ExpressionStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_expression->startToken(); }
         [[nodiscard]] const Token &endToken() const override { return m_expression->endToken(); }
         [[nodiscard]] std::string text() const override { return m_expression->text(); }
-        const Expression *expression() const { return m_expression.get(); }
+        const Expression *expression() const { return m_expression; }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 
     class CompoundStatement final : public Statement {
         Token m_startToken;
         Token m_endToken;
-        std::vector<std::unique_ptr<Statement>> m_statements;
+        std::span<const Statement * const> m_statements;
 
     public:
-        CompoundStatement(Token startToken, Token endToken, std::vector<std::unique_ptr<Statement>> statements): m_startToken(std::move(startToken)), m_endToken(std::move(endToken)), m_statements(std::move(statements)) { }
-        ~CompoundStatement() override = default;
+        CompoundStatement(Token startToken, Token endToken, const std::span<const Statement * const> statements): m_startToken(std::move(startToken)), m_endToken(std::move(endToken)), m_statements(statements) { }
         bool is(const CompoundStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_endToken; }
         [[nodiscard]] std::string text() const override { return std::format("{{ {} }}", join(m_statements, " ")); }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
-        [[nodiscard]] const std::vector<std::unique_ptr<Statement>> &statements() const { return m_statements; }
-        [[nodiscard]] std::vector<std::unique_ptr<Statement>> &statements() { return m_statements; }
+        [[nodiscard]] std::span<const Statement * const> statements() const { return m_statements; }
     };
 
     class BlockStatement final : public Statement {
         std::optional<Token> m_blockDelete;
-        std::vector<std::unique_ptr<WordExpression>> m_expressions;
+        std::span<const WordExpression * const> m_expressions;
 
     public:
-        BlockStatement(std::optional<Token> blockDelete, std::vector<std::unique_ptr<WordExpression>> expressions): m_blockDelete(std::move(blockDelete)), m_expressions(std::move(expressions)) { }
-        ~BlockStatement() override = default;
+        BlockStatement(std::optional<Token> blockDelete, const std::span<const WordExpression * const> expressions): m_blockDelete(std::move(blockDelete)), m_expressions(expressions) { }
         bool is(const BlockStatement *) const override { return true; }
-        [[nodiscard]] const std::vector<std::unique_ptr<WordExpression>> &expressions() const { return m_expressions; }
+        [[nodiscard]] std::span<const WordExpression * const> expressions() const { return m_expressions; }
 
         [[nodiscard]] const Token &startToken() const override {
             if(m_blockDelete) {
@@ -124,31 +122,30 @@ namespace ngc
     class SubStatement final : public Statement {
         Token m_startToken;
         Token m_identifier;
-        std::vector<std::unique_ptr<NamedVariableExpression>> m_params;
-        std::unique_ptr<CompoundStatement> m_statement;
+        std::span<const NamedVariableExpression * const> m_params;
+        const CompoundStatement *m_statement;
 
     public:
-        explicit SubStatement(Token startToken, Token identifier, std::vector<std::unique_ptr<NamedVariableExpression>> params, std::unique_ptr<CompoundStatement> statements): m_startToken(std::move(startToken)), m_identifier(std::move(identifier)), m_params(std::move(params)), m_statement(std::move(statements)) { }
-        ~SubStatement() override = default;
+        explicit SubStatement(Token startToken, Token identifier, const std::span<const NamedVariableExpression * const> params, const CompoundStatement *statements): m_startToken(std::move(startToken)), m_identifier(std::move(identifier)), m_params(params), m_statement(statements) { }
         bool is(const SubStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_statement->endToken(); }
         [[nodiscard]] std::string text() const override { return std::format("{}[{}] {}", name(), join(m_params, ", "), m_statement->text()); }
         [[nodiscard]] std::string_view name() const { return m_identifier.value(); }
-        [[nodiscard]] const std::vector<std::unique_ptr<NamedVariableExpression>> &params() const { return m_params; } // TODO: maybe this should return a std::vector<NamedVariableExpression *>
-        [[nodiscard]] const CompoundStatement *body() const { return m_statement.get(); }
+        [[nodiscard]] const Token &identifier() const { return m_identifier; }
+        [[nodiscard]] std::span<const NamedVariableExpression * const> params() const { return m_params; }
+        [[nodiscard]] const CompoundStatement *body() const { return m_statement; }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 
     class IfStatement final : public Statement {
         Token m_startToken;
-        std::unique_ptr<RealExpression> m_condition;
-        std::unique_ptr<CompoundStatement> m_statements;
-        std::unique_ptr<CompoundStatement> m_elseStatements;
+        const RealExpression *m_condition;
+        const CompoundStatement *m_statements;
+        const CompoundStatement *m_elseStatements;
 
     public:
-        explicit IfStatement(Token startToken, std::unique_ptr<RealExpression> condition, std::unique_ptr<CompoundStatement> statements, std::unique_ptr<CompoundStatement> elseStatements): m_startToken(std::move(startToken)), m_condition(std::move(condition)), m_statements(std::move(statements)), m_elseStatements(std::move(elseStatements)) { }
-        ~IfStatement() override = default;
+        explicit IfStatement(Token startToken, const RealExpression *condition, const CompoundStatement *statements, const CompoundStatement *elseStatements): m_startToken(std::move(startToken)), m_condition(condition), m_statements(statements), m_elseStatements(elseStatements) { }
         bool is(const IfStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_elseStatements ? m_elseStatements->endToken() : m_statements->endToken(); }
@@ -162,41 +159,39 @@ namespace ngc
         }
             
 
-        [[nodiscard]] const RealExpression *condition() const { return m_condition.get(); }
-        [[nodiscard]] const CompoundStatement *body() const { return m_statements.get(); }
-        [[nodiscard]] const CompoundStatement *elseBody() const { return m_elseStatements.get(); }
+        [[nodiscard]] const RealExpression *condition() const { return m_condition; }
+        [[nodiscard]] const CompoundStatement *body() const { return m_statements; }
+        [[nodiscard]] const CompoundStatement *elseBody() const { return m_elseStatements; }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 
     class WhileStatement final : public Statement {
         Token m_startToken;
-        std::unique_ptr<RealExpression> m_condition;
-        std::unique_ptr<CompoundStatement> m_statements;
+        const RealExpression *m_condition;
+        const CompoundStatement *m_statements;
 
     public:
-        explicit WhileStatement(Token startToken, std::unique_ptr<RealExpression> condition, std::unique_ptr<CompoundStatement> statements): m_startToken(std::move(startToken)), m_condition(std::move(condition)), m_statements(std::move(statements)) { }
-        ~WhileStatement() override = default;
+        explicit WhileStatement(Token startToken, const RealExpression *condition, const CompoundStatement *statements): m_startToken(std::move(startToken)), m_condition(condition), m_statements(statements) { }
         bool is(const WhileStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_statements->endToken(); }
         [[nodiscard]] std::string text() const override { return std::format("{} {} {}", m_startToken.text(), m_condition->text(), m_statements->text()); }
-        [[nodiscard]] const RealExpression *condition() const { return m_condition.get(); }
-        [[nodiscard]] const CompoundStatement *body() const { return m_statements.get(); }
+        [[nodiscard]] const RealExpression *condition() const { return m_condition; }
+        [[nodiscard]] const CompoundStatement *body() const { return m_statements; }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 
     class ReturnStatement final : public Statement {
         Token m_startToken;
-        std::unique_ptr<RealExpression> m_expression;
+        const RealExpression *m_expression;
 
     public:
-        explicit ReturnStatement(Token startToken, std::unique_ptr<RealExpression> expression): m_startToken(std::move(startToken)), m_expression(std::move(expression)) { }
-        ~ReturnStatement() override = default;
+        explicit ReturnStatement(Token startToken, const RealExpression *expression): m_startToken(std::move(startToken)), m_expression(expression) { }
         bool is(const ReturnStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_expression->endToken(); }
         [[nodiscard]] std::string text() const override { return std::format("{} {}", m_startToken.text(), m_expression->text()); }
-        [[nodiscard]] const RealExpression *real() const { return m_expression.get(); }
+        [[nodiscard]] const RealExpression *real() const { return m_expression; }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 
@@ -205,7 +200,6 @@ namespace ngc
 
     public:
         explicit BreakStatement(Token startToken): m_startToken(std::move(startToken)) { }
-        ~BreakStatement() override = default;
         bool is(const BreakStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_startToken; }
@@ -218,7 +212,6 @@ namespace ngc
 
     public:
         explicit ContinueStatement(Token startToken): m_startToken(std::move(startToken)) { }
-        ~ContinueStatement() override = default;
         bool is(const ContinueStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_startToken; }
@@ -228,29 +221,27 @@ namespace ngc
 
     class AliasStatement final : public Statement {
         Token m_startToken;
-        std::unique_ptr<NamedVariableExpression> m_namedVariable;
-        std::unique_ptr<RealExpression> m_expression;
+        const NamedVariableExpression *m_namedVariable;
+        const RealExpression *m_expression;
 
     public:
-        explicit AliasStatement(Token startToken, std::unique_ptr<NamedVariableExpression> namedVariable, std::unique_ptr<RealExpression> expression): m_startToken(std::move(startToken)), m_namedVariable(std::move(namedVariable)), m_expression(std::move(expression)) { }
-        ~AliasStatement() override = default;
+        explicit AliasStatement(Token startToken, const NamedVariableExpression *namedVariable, const RealExpression *expression): m_startToken(std::move(startToken)), m_namedVariable(namedVariable), m_expression(expression) { }
         bool is(const AliasStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_expression->endToken(); }
         [[nodiscard]] std::string text() const override { return std::format("{} {} = {}", m_startToken.text(), m_namedVariable->text(), m_expression->text()); }
-        [[nodiscard]] const NamedVariableExpression *variable() const { return m_namedVariable.get(); }
-        [[nodiscard]] const RealExpression *address() const { return m_expression.get(); }
+        [[nodiscard]] const NamedVariableExpression *variable() const { return m_namedVariable; }
+        [[nodiscard]] const RealExpression *address() const { return m_expression; }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 
     class LetStatement final : public Statement {
         Token m_startToken;
-        std::unique_ptr<NamedVariableExpression> m_namedVariable;
-        std::unique_ptr<RealExpression> m_expression;
+        const NamedVariableExpression *m_namedVariable;
+        const RealExpression *m_expression;
 
     public:
-        explicit LetStatement(Token startToken, std::unique_ptr<NamedVariableExpression> namedVariable, std::unique_ptr<RealExpression> expression): m_startToken(std::move(startToken)), m_namedVariable(std::move(namedVariable)), m_expression(std::move(expression)) { }
-        ~LetStatement() override = default;
+        explicit LetStatement(Token startToken, const NamedVariableExpression *namedVariable, const RealExpression *expression): m_startToken(std::move(startToken)), m_namedVariable(namedVariable), m_expression(expression) { }
         bool is(const LetStatement *) const override { return true; }
         [[nodiscard]] const Token &startToken() const override { return m_startToken; }
         [[nodiscard]] const Token &endToken() const override { return m_expression->endToken(); }
@@ -263,8 +254,8 @@ namespace ngc
             return std::format("{} {}", m_startToken.text(), m_namedVariable->text());
         }
 
-        [[nodiscard]] const NamedVariableExpression *variable() const { return m_namedVariable.get(); }
-        [[nodiscard]] const RealExpression *value() const { return m_expression.get(); }
+        [[nodiscard]] const NamedVariableExpression *variable() const { return m_namedVariable; }
+        [[nodiscard]] const RealExpression *value() const { return m_expression; }
         void accept(Visitor &v, VisitorContext *ctx) const override { v.visit(this, ctx); }
     };
 }
@@ -1,14 +1,20 @@
 #pragma once
 
-#include <memory>
-#include <cassert>
-#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <format>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
-#include "parser/TokenSource.h"
-#include "parser/StringTokenSource.h"
+#include "utils.h"
+#include "parser/LexerSource.h"
 
 namespace ngc {
+    // A token is a span into the LexerSource that produced it; its text is resolved lazily from the source
+    // buffer, so the source must outlive every token (and every AST node) that refers to it.
     class Token {
     public:
         enum class Kind {
@@ -36,27 +42,26 @@ namespace ngc {
         };
 
     private:
-        Kind m_kind;
-        std::unique_ptr<TokenSource> m_source;
+        Kind m_kind = Kind::NONE;
+        std::uint32_t m_length = 0;
+        const LexerSource *m_source = nullptr;
+        std::size_t m_offset = 0;
+        int m_line = 0;
+        int m_col = 0;
 
     public:
-        Token(): m_kind(Kind::NONE), m_source(std::make_unique<StringTokenSource>("none", "none")) { }
-        Token(const Kind kind, std::unique_ptr<TokenSource> source): m_kind(kind), m_source(std::move(source)) { }
-        Token(const Token &t) : m_kind(t.m_kind), m_source(t.m_source->clone()) { }
-        Token(Token &&) = default;
-
-        static Token fromDouble(const double d, std::string name = "double") { return { Kind::NUMBER, std::make_unique<StringTokenSource>(d, std::move(name)) }; }
-        static Token fromString(const Kind kind, std::string text, std::string name = "string") { return { kind, std::make_unique<StringTokenSource>(std::move(text), std::move(name)) }; }
-
-        Token &operator=(const Token &t) {
-            m_kind = t.m_kind;
-            m_source = t.m_source->clone();
-            return *this;
-        }
+        constexpr Token() = default;
+        constexpr explicit Token(const Kind kind) : m_kind(kind) { }
+        Token(const Kind kind, const LexerSource &source, const std::size_t start, const std::size_t end, const int line, const int col) : m_kind(kind), m_length(static_cast<std::uint32_t>(end - start)), m_source(&source), m_offset(start), m_line(line), m_col(col) { }
 
         [[nodiscard]] Kind kind() const { return m_kind; }
-        [[nodiscard]] const TokenSource *source() const { return m_source.get(); }
-        [[nodiscard]] std::string_view text() const { return m_source->text(); }
+        [[nodiscard]] const LexerSource *source() const { return m_source; }
+        [[nodiscard]] std::string_view text() const { return m_source ? m_source->text(m_offset, m_offset + m_length) : std::string_view(); }
+        [[nodiscard]] std::string_view sourceName() const { return m_source ? std::string_view(m_source->name()) : std::string_view("generated"); }
+        [[nodiscard]] std::size_t offset() const { return m_offset; }
+        [[nodiscard]] std::size_t length() const { return m_length; }
+        [[nodiscard]] int line() const { return m_line; }
+        [[nodiscard]] int col() const { return m_col; }
         [[nodiscard]] bool number() const { return m_kind == Kind::NUMBER; }
         [[nodiscard]] bool is(const Kind kind) const { return m_kind == kind; }
 
@@ -71,7 +76,11 @@ namespace ngc {
         }
 
         [[nodiscard]] std::string location() const {
-            return m_source->location();
+            if(!m_source) {
+                return std::string(sourceName());
+            }
+
+            return std::format("{}:{}:{}", sourceName(), m_line, m_col);
         }
 
         [[nodiscard]] std::string_view value() const {
@@ -93,7 +102,7 @@ namespace ngc {
             auto result = fromChars(text());
 
             if(!result) {
-                throw std::logic_error(std::format("StringTokenSource::{}(): std::from_chars() failed on '{}'", __func__, text()));
+                throw std::logic_error(std::format("Token::{}(): std::from_chars() failed on '{}'", __func__, text()));
             }
 
             return *result;
@@ -102,6 +111,8 @@ namespace ngc {
         [[nodiscard]] const char *name() const;
     };
 
+    static_assert(std::is_trivially_copyable_v<Token>);
+
     inline const char *name(const Token::Kind kind) {
         switch (kind) {
             case Token::Kind::NONE: return "NONE";
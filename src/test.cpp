@@ -18,6 +18,7 @@
 #include <string>
 #include <string_view>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "evaluator/Evaluator.h"
@@ -46,6 +47,7 @@
 #include "memory/Memory.h"
 #include "memory/ParameterStore.h"
 #include "parser/Program.h"
+#include "parser/ProgramCache.h"
 #include "path_tempo/Planner.h"
 #include "path_tempo/Types.h"
 #include "machine/MachineSessionManager.h"
@@ -223,6 +225,44 @@ namespace {
         Failure m_failure;
     };
 
+    // Reports the execution queue as full while closed, so published work
+    // stays with the caller.
+    class GatedPublicationBackend final : public ngc::MotionBackend {
+    public:
+        explicit GatedPublicationBackend(ngc::MotionBackend &backend)
+            : m_backend(backend) { }
+
+        ngc::PublishResult tryPublish(const ngc::ExecutionItem &item) noexcept override {
+            if (closed) {
+                return ngc::PublishResult::Full;
+            }
+
+            return m_backend.tryPublish(item);
+        }
+
+        ngc::DemandPublishResult publishDemand(
+            const ngc::ExecutorDemand &demand) noexcept override {
+            return m_backend.publishDemand(demand);
+        }
+
+        ngc::SubmitResult trySubmit(const ngc::ControlRequest &request) noexcept override {
+            return m_backend.trySubmit(request);
+        }
+
+        bool tryTakeEvent(ngc::ExecutionEvent &event) noexcept override {
+            return m_backend.tryTakeEvent(event);
+        }
+
+        bool tryTakeSnapshot(ngc::ExecutionSnapshot &snapshot) noexcept override {
+            return m_backend.tryTakeSnapshot(snapshot);
+        }
+
+        bool closed = false;
+
+    private:
+        ngc::MotionBackend &m_backend;
+    };
+
 #ifdef __linux__
     class ScheduledTriggerProductionExecutorIo final
         : public ngc::ProductionExecutorIo {
@@ -584,6 +624,82 @@ final_move_together = true
         requireNear(feed->to().x, 20.0, "G1 endpoint is incorrect");
     }
 
+    void testSubArgumentsEvaluateInCallerScope() {
+        const auto commands = run("let #a = 2\nsub pick[#a, #b] { return #b }\nsub none[#x] { }\nG0 X[pick[5, #a]] Y[none[7]]\n");
+        require(commands.size() == 1, "expected one rapid move");
+
+        const auto *rapid = std::get_if<ngc::MoveLine>(&commands[0]);
+        require(rapid != nullptr, "expected a line move");
+        requireNear(rapid->to().x, 2.0, "sub arguments must not see the callee's parameters");
+        requireNear(rapid->to().y, 0.0, "a sub without a return statement should return 0");
+    }
+
+    void testCompiledControlFlowAndErrorLocations() {
+        const auto commands = run(
+            "sub scan[#n] {\n"
+            "    let #i = 0\n"
+            "    while #i < 10 {\n"
+            "        #i = #i + 1\n"
+            "        if #i == 3 { continue }\n"
+            "        if #i == #n { return #i * 100 }\n"
+            "        if #i == 7 { break }\n"
+            "    }\n"
+            "    return #i\n"
+            "}\n"
+            "G0 X[scan[5]] Y[scan[9]]\n");
+        require(commands.size() == 1, "expected one rapid move");
+
+        const auto *rapid = std::get_if<ngc::MoveLine>(&commands[0]);
+        require(rapid != nullptr, "expected a line move");
+        requireNear(rapid->to().x, 500.0, "a return inside a loop must leave the sub");
+        requireNear(rapid->to().y, 7.0, "a break must leave only the loop");
+
+        std::string message;
+
+        try {
+            run("sub outer[#x] { return inner[#x] }\nsub inner[#y] { return #missing + #y }\nG0 X[outer[1]]\n");
+        } catch(const std::exception &error) {
+            message = error.what();
+        }
+
+        require(message == "test.ngc:3:1: test.ngc:1:17: test.ngc:2:17: undeclared variable 'missing'",
+                "errors must carry the location of every enclosing statement");
+    }
+
+    void testConstantExpressionsAndBranchesFoldAtCompileTime() {
+        ngc::Machine machine(UNIT);
+        ngc::Program program(
+            "let #s = 2\n"
+            "if [1 > 2] {\n    G0 X1\n} else {\n    G0 X[-[3 * 0.5] + #s]\n}\n"
+            "if 0 {\n    G0 X[#undeclared]\n}\n"
+            "while [2 - 2] {\n    G0 X9\n}\n"
+            "while 1 {\n    G0 Y[4 mod 3]\n    break\n}\n", "test.ngc");
+        require(program.compile().has_value(), "folding regression program should parse");
+        std::vector<ngc::MachineCommand> commands;
+
+        const std::function callback = [&](std::unique_ptr<const ngc::EvaluatorMessage> message, ngc::Evaluator &) {
+            if(const auto block = message->as<ngc::BlockMessage>()) {
+                auto emitted = machine.executeBlock(block->block());
+                commands.insert(commands.end(), std::make_move_iterator(emitted.begin()), std::make_move_iterator(emitted.end()));
+            }
+        };
+
+        ngc::Evaluator evaluator(machine.memory(), callback);
+        const ngc::Preamble preamble(machine.memory());
+        evaluator.executeFirstPass(preamble.statements());
+        evaluator.executeFirstPass(program.statements());
+        evaluator.executeSecondPass(program.statements());
+
+        require(commands.size() == 2, "only the live branches should emit moves");
+        const auto *first = std::get_if<ngc::MoveLine>(&commands[0]);
+        const auto *second = std::get_if<ngc::MoveLine>(&commands[1]);
+        require(first != nullptr && second != nullptr, "expected line moves");
+        requireNear(first->to().x, 0.5, "a folded subexpression must keep its value");
+        requireNear(second->to().y, 1.0, "a constant loop must still run until its break");
+        require(evaluator.diagnostics().prunedBranches == 4, "every constant condition should be decided while compiling");
+        require(evaluator.diagnostics().foldedExpressions == 2, "constant subexpressions of live code should be folded");
+    }
+
     void testMachineCommandMotionHelpers() {
         const ngc::position_t from{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
         const ngc::position_t to{7.0, 8.0, 9.0, 10.0, 11.0, 12.0};
@@ -681,6 +797,35 @@ final_move_together = true
         }
     }
 
+    void testMemoryGlobalsResolveThroughVarTable() {
+        ngc::Memory memory;
+        memory.init(ngc::gVars);
+
+        for(const auto &[var, name, addr, flags, value] : ngc::gVars) {
+            const auto address = memory.deref(var);
+            require(addr == 0 || address == addr, std::format("Var::{} should keep its fixed address", ngc::name(var)));
+            requireNear(memory.read(var), value, std::format("Var::{} should start at its default", ngc::name(var)));
+        }
+
+        require(memory.deref(ngc::Var::PROBE_Y) == memory.deref(ngc::Var::PROBE_X) + 1,
+                "vars without an address should follow the previous one");
+
+        memory.write<ngc::Var::PROBE_Z>(4.5);
+        requireNear(memory.read(ngc::Var::PROBE_Z), 4.5, "typed writes should land in the Var's cell");
+        memory.write(ngc::Var::G54_X, -2.0);
+        requireNear(memory.read<ngc::Var::G54_X>(), -2.0, "typed reads should see Var writes");
+
+        ngc::Memory partial;
+        partial.init(std::span(ngc::gVars).first(1));
+        bool rejected = false;
+        try {
+            static_cast<void>(partial.read<ngc::Var::TASK>());
+        } catch (const std::logic_error &) {
+            rejected = true;
+        }
+        require(rejected, "a Var outside the initialized layout should be rejected");
+    }
+
     void testPersistentParameterCodec() {
         ngc::Memory memory;
         memory.init(ngc::gVars);
@@ -2978,6 +3123,53 @@ final_move_together = true
         }
     }
 
+    void testTokensResolveTextFromMovedProgramSource() {
+        static_assert(std::is_trivially_copyable_v<ngc::Token>);
+
+        std::vector<ngc::Program> programs;
+        programs.emplace_back("G1 X1.5\nlet #_scale = 2\n", "token-span.ngc");
+        require(programs.back().compile().has_value(), "token span fixture should compile");
+
+        for(int index = 0; index < 8; ++index) {
+            programs.emplace_back("G0 Z0\n", std::format("filler-{}.ngc", index));
+        }
+
+        const auto statements = programs.front().statements();
+        require(statements.size() == 2, "token span fixture should contain two statements");
+        require(statements[0]->text() == "G1 X1.5", "a block should resolve its text after the Program moves");
+        require(statements[0]->startToken().location() == "token-span.ngc:1:1", "a token should report its source location");
+        require(statements[1]->startToken().location() == "token-span.ngc:2:1", "a token should track lines");
+        require(programs.front().arena().bytes() > 0, "the Program arena should own the parsed nodes");
+    }
+
+    void testPlainBlocksParseLikeExpressionBlocks() {
+        ngc::Program program("(header)\n\n/N10 g1 X-1.5 Y .25 (note) F100.\nG1 X[1 + 2] Y0.1\nG0 X0.30000000000000004\n", "plain-blocks.ngc");
+        const auto compiled = program.compile();
+        require(compiled.has_value() && compiled->size() == 3, "plain block fixture should compile to three blocks");
+
+        const auto plain = (*compiled)[0]->as<ngc::BlockStatement>();
+        require(plain && plain->blockDelete() && plain->expressions().size() == 5, "a plain block should keep its block delete and words");
+        require(plain->text() == "/N10 g1 X-1.5 Y.25 F100.", "a plain block should resolve its text from the source");
+        require(plain->startToken().location() == "plain-blocks.ngc:3:1", "a plain block should start at its block delete");
+        require(plain->expressions()[2]->startToken().location() == "plain-blocks.ngc:3:9", "plain block words should track columns");
+
+        const auto negative = plain->expressions()[2]->real()->as<ngc::UnaryExpression>();
+        require(negative && negative->op() == ngc::UnaryExpression::Op::NEGATIVE, "a signed plain word should keep its unary sign");
+        requireNear(negative->real()->as<ngc::LiteralExpression>()->value(), 1.5, "a plain word should carry its literal value");
+        requireNear(plain->expressions()[3]->real()->as<ngc::LiteralExpression>()->value(), 0.25, "a plain word may be separated from its letter");
+
+        const auto expression = (*compiled)[1]->as<ngc::BlockStatement>();
+        require(expression && expression->expressions()[1]->real()->is<ngc::GroupingExpression>(), "an expression block should fall back to the general grammar");
+        require(expression->startToken().location() == "plain-blocks.ngc:4:1", "the general grammar should resume where the plain blocks stopped");
+
+        const auto precise = (*compiled)[2]->as<ngc::BlockStatement>()->expressions()[1]->real()->as<ngc::LiteralExpression>();
+        require(precise && precise->value() == 0.30000000000000004, "long plain numbers should round like from_chars");
+
+        ngc::Program invalid("G1 X1.5.5\n", "plain-invalid.ngc");
+        const auto error = invalid.compile();
+        require(!error && error.error().text().starts_with("plain-invalid.ngc:1:8:"), "a malformed plain block should report the general grammar's error");
+    }
+
     void testFileHelpersHandleEmptyAndFailedIo() {
         const auto directory = std::filesystem::temp_directory_path();
         const auto emptyPath = directory / "ngc-empty-file-test.txt";
@@ -5069,6 +5261,190 @@ G1 F60 X2
         return *line;
     }
 
+    void testInterpreterSessionQueuesBlocksAheadOfConsumer() {
+        ngc::InterpreterSession session(UNIT, ngc::InterpretationMode::Preview);
+        compileSession(session,
+            "sub step[#x] {\n"
+            "    let #next = #x + 1\n"
+            "    return #next\n"
+            "}\n"
+            "let #i = 0\n"
+            "while #i < 4 {\n"
+            "    G0 X[step[#i]]\n"
+            "    G0 Y2\n"
+            "    #i = #i + 1\n"
+            "}\n"
+            "while 1 {\n"
+            "    G0 Y3\n"
+            "}\n");
+
+        for(int i = 0; i < 4; i++) {
+            requireNear(nextLine(session, "queued moves should arrive in program order").to().x, i + 1.0,
+                        "locals written after a queued block must not disturb its execution");
+            requireNear(nextLine(session, "queued moves should arrive in program order").to().y, 2.0,
+                        "literal blocks should follow the computed ones in order");
+        }
+
+        requireNear(nextLine(session, "the endless loop should produce moves").to().y, 3.0,
+                    "the endless loop should move to Y3");
+
+        // lets the evaluation thread fill the queue, so stopping has to wake it from a blocked push
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        session.stop();
+    }
+
+    void testInterpreterSessionReusesUnchangedPrograms() {
+        const auto synchronize = [](const auto &callback) { callback(); };
+        const std::string library = "sub offset[#v] { return #v + 10 }\n";
+        ngc::InterpreterSession session(UNIT, ngc::InterpretationMode::Preview);
+
+        session.setPrograms({ { library, "autoload/offset.ngc" }, { "G0 X[offset[1]]\n", "first.ngc" } });
+        session.compile(synchronize);
+        require(session.compiled(), "programs with an autoloaded sub should compile");
+        require(session.compileDiagnostics().parsedPrograms == 2 && session.compileDiagnostics().reusedPrograms == 0, "a fresh session should parse every program");
+        session.begin();
+        requireNear(nextLine(session, "first run should call the autoloaded sub").to().x, 11.0, "first run should evaluate the autoloaded sub");
+        require(std::holds_alternative<ngc::InterpreterCompleted>(session.next()), "first run should complete");
+
+        session.setPrograms({ { library, "autoload/offset.ngc" }, { "G0 X[offset[2]]\n", "second.ngc" } });
+        session.compile(synchronize);
+        require(session.compiled(), "programs reusing a parsed sub should compile");
+        require(session.compileDiagnostics().parsedPrograms == 1 && session.compileDiagnostics().reusedPrograms == 1, "an unchanged autoload program should not be parsed again");
+        session.begin();
+        requireNear(nextLine(session, "second run should call the reused sub").to().x, 12.0, "the reused sub should evaluate like a freshly parsed one");
+        require(std::holds_alternative<ngc::InterpreterCompleted>(session.next()), "second run should complete");
+
+        session.setPrograms({ { "G0 X[\n", "broken-a.ngc" }, { library, "autoload/offset.ngc" }, { "G1 X[1\n", "broken-b.ngc" }, { "G0 X1\n", "valid.ngc" } });
+        session.compile(synchronize);
+        require(!session.compiled(), "a set with syntax errors should not compile");
+        require(session.compileDiagnostics().parsedPrograms == 3 && session.compileDiagnostics().reusedPrograms == 1, "only changed programs should be parsed");
+        require(session.parserErrors().size() == 2, "every broken program should report its error");
+        require(session.parserErrors()[0].text().find("broken-a.ngc") != std::string::npos, "parser errors should keep program order");
+        require(session.parserErrors()[1].text().find("broken-b.ngc") != std::string::npos, "parser errors should keep program order");
+
+        session.setPrograms({ { library, "autoload/renamed.ngc" } });
+        session.compile(synchronize);
+        require(session.compileDiagnostics().parsedPrograms == 1, "a program is only reused under the same name");
+    }
+
+    void testProgramCacheRestoresParsedPrograms() {
+        const auto directory = std::filesystem::temp_directory_path() / "ngc-program-cache";
+        std::filesystem::remove_all(directory);
+        const std::string source =
+            "(header comment)\n"
+            "sub clamp[#v, #limit] {\n"
+            "    if #v > #limit { return #limit } else { return #v }\n"
+            "}\n"
+            "alias #scale = 1000\n"
+            "let #i = 0\n"
+            "let #unset\n"
+            "#scale = 2\n"
+            "while #i < 3 {\n"
+            "    #i = #i + 1\n"
+            "    if #i == 2 { continue }\n"
+            "    if #i > 5 { break }\n"
+            "    /G1 F10 X[clamp[#i * #scale, 4]] Y-#i Z[-[#1000 MOD 3]]\n"
+            "}\n"
+            "G0 X#scale Y[#1000 + #i]\n";
+        const auto synchronize = [](const auto &callback) { callback(); };
+        const auto run = [&](const std::shared_ptr<const ngc::ProgramCache> &cache) {
+            ngc::InterpreterSession session(UNIT, ngc::InterpretationMode::Preview);
+            session.setProgramCache(cache);
+            session.setPrograms({ { source, "cached.ngc" }, { "G0 X[\n", "broken.ngc" } });
+            session.compile(synchronize);
+            require(session.parserErrors().size() == 1, "a broken program should still be reported with a cache");
+            return session.compileDiagnostics();
+        };
+
+        auto parsed = ngc::Program(source, "cached.ngc");
+        require(parsed.compile().has_value(), "cached test program should parse");
+
+        const auto cache = std::make_shared<const ngc::ProgramCache>(directory);
+        const auto first = run(cache);
+        require(first.parsedPrograms == 2 && first.cachedPrograms == 0, "an empty cache should leave every program to the parser");
+        require(std::filesystem::exists(cache->entryPath(ngc::ProgramCache::hash(source))), "a parsed program should be written to the cache");
+
+        const auto second = run(std::make_shared<const ngc::ProgramCache>(directory));
+        require(second.parsedPrograms == 1 && second.cachedPrograms == 1, "a new session should load the unchanged program from disk");
+
+        auto restored = ngc::Program(source, "cached.ngc");
+        require(cache->load(restored) && restored.compiled(), "the cache entry should load into a program with the same text");
+        require(restored.statements().size() == parsed.statements().size(), "a restored program should keep its statements");
+
+        for(std::size_t i = 0; i < parsed.statements().size(); i++) {
+            require(restored.statements()[i]->text() == parsed.statements()[i]->text(), "a restored statement should match the parsed one");
+            require(restored.statements()[i]->startToken().location() == parsed.statements()[i]->startToken().location(), "a restored statement should keep its location");
+        }
+
+        auto changed = ngc::Program(source + "G0 X1\n", "cached.ngc");
+        require(!cache->load(changed) && !changed.compiled(), "an edited program should not match the old entry");
+
+        const auto entry = cache->entryPath(ngc::ProgramCache::hash(source));
+        std::filesystem::resize_file(entry, std::filesystem::file_size(entry) / 2);
+
+        auto damaged = ngc::Program(source, "cached.ngc");
+        require(!cache->load(damaged) && !damaged.compiled(), "a damaged entry should be ignored");
+
+        const auto moves = [&](ngc::Program program) {
+            ngc::InterpreterSession session(UNIT, ngc::InterpretationMode::Preview);
+            std::vector<ngc::Program> programs;
+            programs.push_back(std::move(program));
+            session.setPrograms(std::move(programs), ngc::ProgramParsing::Complete);
+            session.compile(synchronize);
+            require(session.compiled(), "cached test program should be accepted by the session");
+            session.begin();
+
+            for(auto event = session.next(); !std::holds_alternative<ngc::InterpreterCompleted>(event); event = session.next()) {
+                require(std::holds_alternative<ngc::MachineCommand>(event), "cached test program should only emit commands");
+            }
+
+            require(!session.blockMessages().empty(), "cached test program should execute blocks");
+            return session.blockMessages();
+        };
+
+        auto reparsed = ngc::Program(source, "cached.ngc");
+        require(reparsed.compile().has_value(), "cached test program should parse again");
+        require(moves(std::move(restored)) == moves(std::move(reparsed)), "a restored program should execute like a parsed one");
+        std::filesystem::remove_all(directory);
+    }
+
+    void testInterpreterSessionStreamsMappedProgram() {
+        const auto path = std::filesystem::temp_directory_path() / "ngc-streamed-program.ngc";
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << "sub twice[#v] { return #v * 2 }\nG0 X1\nG1 F1 X[twice[1.5]]\nG0 X[\n";
+        }
+
+        {
+            auto program = ngc::Program::open(path);
+            require(program.has_value(), "mapped program should open");
+            require(program->source().text().starts_with("sub twice"), "mapped program should expose the file contents");
+
+            auto first = program->next();
+            require(first && *first && (*first)->as<ngc::SubStatement>(), "incremental parse should yield the sub first");
+            require(program->statements().empty() && !program->compiled(), "incremental parse must not publish a partial program");
+
+            const auto synchronize = [](const auto &callback) { callback(); };
+            ngc::InterpreterSession session(UNIT, ngc::InterpretationMode::MachineRun);
+            std::vector<ngc::Program> programs;
+            programs.emplace_back(std::move(*program));
+            session.setPrograms(std::move(programs), ngc::ProgramParsing::Incremental);
+            session.compile(synchronize);
+            require(session.compiled(), "incrementally parsed program should be accepted before its syntax error is reached");
+
+            session.begin();
+            requireNear(nextLine(session, "streamed program should execute its first block").to().x, 1.0, "streamed first block should move to X1");
+            requireNear(nextLine(session, "streamed program should call a sub declared earlier in the file").to().x, 3.0, "streamed sub call should evaluate its result");
+            const auto error = session.next();
+            require(std::holds_alternative<ngc::InterpreterError>(error), "streamed program should report its syntax error once reached");
+            require(std::get<ngc::InterpreterError>(error).message.find("ngc-streamed-program.ngc:4") != std::string::npos, "streamed syntax error should carry its location");
+        }
+
+        std::filesystem::remove(path);
+        const auto missing = ngc::Program::open(path);
+        require(!missing.has_value(), "opening a missing program should fail");
+    }
+
     void requireCompleted(ngc::InterpreterSession &session, const std::string_view message) {
         require(std::holds_alternative<ngc::InterpreterCompleted>(session.next()), message);
     }
@@ -6135,6 +6511,148 @@ G1 F60 X2
                 "controlled stop should permanently reject resume for the abandoned epoch");
     }
 
+    void testPipelinedDriverPlansAheadOfPublication() {
+        ngc::TrajectoryLimits limits;
+        limits.pathAcceleration = 4.0;
+        limits.axisAcceleration =
+            ngc::position_t { 4.0, 4.0, 4.0, 4.0, 4.0, 4.0 };
+        ngc::MockMotionBackend backend(
+            ngc::FeedHoldConfiguration { 2.0, 10.0 }, limits);
+        ngc::PreparedGeometryForwardChannel forward;
+        ngc::GeometryFeedbackChannel feedback;
+        std::atomic<bool> cancelled { false };
+        ngc::ExecutorDemandController demand(backend);
+        ngc::PreparedTrajectoryExecutionDriver driver(
+            backend, demand, forward, feedback, cancelled, limits);
+        driver.setPipelinedPlanning(true);
+        constexpr ngc::EpochId epoch = 29;
+
+        require(driver.begin(epoch),
+                "pipelined fixture should initialize the trajectory driver");
+        backend.advanceTick(0.0, true);
+        driver.serviceBackend([](const ngc::ExecutionEvent &) { });
+
+        ngc::PreparedCommandRecord record;
+        record.command = ngc::MoveLine { {}, { 2, 0, 0, 0, 0, 0 }, 60.0 };
+        require(forward.tryPush(
+                    std::make_unique<ngc::PreparedStreamMessage>(
+                        ngc::PreparedStandaloneCommand { epoch, 1, record, nullptr }))
+                    && forward.tryPush(
+                        std::make_unique<ngc::PreparedStreamMessage>(
+                            ngc::PreparedProgramEnd { epoch, 2 })),
+                "pipelined fixture should publish its prepared stream");
+
+        auto queuedMotion = 0.0;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (driver.state() == ngc::PreparedDriverState::Running
+               && std::chrono::steady_clock::now() < deadline) {
+            (void)driver.pumpOne(
+                [](const auto &, const auto &, const auto &,
+                   const auto &, const auto) { });
+            queuedMotion = std::max(queuedMotion, driver.queuedMotionSeconds());
+            backend.advanceTick(0.01, true);
+            driver.serviceBackend([](const ngc::ExecutionEvent &) { });
+            std::this_thread::yield();
+        }
+        driver.finish();
+
+        require(driver.state() == ngc::PreparedDriverState::Completed,
+                driver.error() ? *driver.error()
+                               : "pipelined driver should complete its program");
+        require(queuedMotion > 0.0,
+                "pipelined driver should report the motion it planned ahead");
+        requireNear(driver.queuedMotionSeconds(), 0.0,
+                    "retired motion should leave no queued lead");
+        require(driver.planningObservation().diagnostics.commandsPlanned == 1,
+                "pipelined planning diagnostics should reach the driver");
+    }
+
+    void testPipelinedDriverPublishesWhilePlanningIsHeld() {
+        ngc::TrajectoryLimits limits;
+        limits.pathAcceleration = 4.0;
+        limits.axisAcceleration =
+            ngc::position_t { 4.0, 4.0, 4.0, 4.0, 4.0, 4.0 };
+        ngc::MockMotionBackend mock(
+            ngc::FeedHoldConfiguration { 2.0, 10.0 }, limits);
+        GatedPublicationBackend backend(mock);
+        // Six seconds of G64 motion against the two second lookahead rolls
+        // into at least two horizons.
+        ngc::InterpreterSession session(UNIT, ngc::InterpretationMode::Preview);
+        compileSession(session, "G64 P0.01\nG1 F60 X6\nG61\nG1 X6 Y1\n");
+        ngc::PreparedGeometryForwardChannel forward;
+        ngc::GeometryFeedbackChannel feedback;
+        std::atomic<bool> cancelled { false };
+        ngc::GeometryStreamProducer producer(session, forward, feedback, cancelled, {});
+        ngc::ExecutorDemandController demand(backend);
+        ngc::PreparedTrajectoryExecutionDriver driver(
+            backend, demand, forward, feedback, cancelled, limits);
+        driver.setPipelinedPlanning(true);
+        constexpr ngc::EpochId epoch = 30;
+
+        // The planning thread stops once the second horizon is compiled; the
+        // first is then already with the driver, which cannot publish it yet.
+        std::atomic<int> horizons { 0 };
+        std::atomic<bool> held { false };
+        std::atomic<bool> released { false };
+        driver.setContinuousDiagnosticCallback([&](const auto &, const auto) {
+            if (++horizons != 2) return;
+            held = true;
+            for (auto attempt = 0; attempt < 20000 && !released; ++attempt)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+        require(driver.begin(epoch),
+                "held-planning fixture should initialize the trajectory driver");
+        mock.advanceTick(0.0, true);
+        driver.serviceBackend([](const ngc::ExecutionEvent &) { });
+        backend.closed = true;
+        auto produced = false;
+        std::thread geometryThread([&] { produced = producer.run(epoch); });
+        const auto holdDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+        while (!(held && driver.hasPendingPublication()) && !driver.error()
+               && std::chrono::steady_clock::now() < holdDeadline) {
+            (void)driver.pumpOne(
+                [](const auto &, const auto &, const auto &,
+                   const auto &, const auto) { });
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        const auto planningHeld = held.load();
+        const auto pendingWhenHeld = driver.hasPendingPublication();
+
+        auto publishedWhileHeld = 0;
+        auto retiredWhileHeld = 0;
+        const auto observe = [&](const auto &, const auto &, const auto &,
+                                 const auto &, const auto) {
+            if (!released) ++publishedWhileHeld;
+        };
+        const auto service = [&](const ngc::ExecutionEvent &event) {
+            if (!released && std::holds_alternative<ngc::ChunkRetired>(event)) ++retiredWhileHeld;
+        };
+        backend.closed = false;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+        while (driver.state() == ngc::PreparedDriverState::Running
+               && std::chrono::steady_clock::now() < deadline) {
+            if (publishedWhileHeld > 0 && retiredWhileHeld > 0) released = true;
+            (void)driver.pumpOne(observe);
+            mock.advanceTick(0.01, true);
+            driver.serviceBackend(service);
+            std::this_thread::yield();
+        }
+        released = true;
+        geometryThread.join();
+        driver.finish();
+
+        require(planningHeld && pendingWhenHeld,
+                driver.error() ? *driver.error()
+                               : "the second horizon should compile while the first waits to publish");
+        require(horizons >= 2 && publishedWhileHeld > 0 && retiredWhileHeld > 0,
+                std::format("queued packets should publish and retire while the next horizon "
+                    "is held: horizons={} published={} retired={}",
+                    horizons.load(), publishedWhileHeld, retiredWhileHeld));
+        require(produced && driver.state() == ngc::PreparedDriverState::Completed,
+                driver.error() ? *driver.error()
+                               : "held-planning program should complete once planning resumes");
+    }
+
     void testDriverFailureStopsAndAbortsBeforeBecomingTerminal() {
         ngc::TrajectoryLimits limits;
         limits.pathAcceleration = 4.0;
@@ -6930,6 +7448,116 @@ G1 F60 X2
                     "constant-speed line duration should be distance divided by feed");
     }
 
+    void testExactStopTimeLawCacheReusesRepeatedTransitions() {
+        const ngc::TrajectoryLimits limits{
+            .pathAcceleration=4.0,
+            .rapidSpeed=120.0,
+            .arcChordTolerance=0.0001,
+            .pathJerk=8.0,
+            .axisPosition={},
+        };
+        const std::array<ngc::position_t,5> corners{{
+            {0,0,0,0,0,0},{1,0,0,0,0,0},{1,1,0,0,0,0},{0,1,0,0,0,0},{0,0,0,0,0,0},
+        }};
+        ngc::TrajectoryCompiler cached(limits);
+        ngc::TrajectoryCompiler uncached(limits);
+        uncached.setScalarTransitionCache(nullptr);
+        cached.reset(11);
+        uncached.reset(11);
+        for(std::size_t side=0;side+1<corners.size();++side) {
+            const ngc::MoveLine line{corners[side],corners[side+1],60.0};
+            const auto fromCache=cached.compile(line);
+            const auto solved=uncached.compile(line);
+            require(fromCache&&solved,fromCache?(solved?"":solved.error()):fromCache.error());
+            require(fromCache->normalMotion.size==solved->normalMotion.size,
+                    "a memoized time law should emit the solver's span count");
+            for(std::size_t span=0;span<solved->normalMotion.size;++span) {
+                const auto &left=fromCache->normalMotion[span];
+                const auto &right=solved->normalMotion[span];
+                require(std::bit_cast<std::array<double,6>>(left.origin)
+                            ==std::bit_cast<std::array<double,6>>(right.origin)
+                            &&std::bit_cast<std::array<double,30>>(left.coefficients)
+                            ==std::bit_cast<std::array<double,30>>(right.coefficients)
+                            &&left.duration==right.duration,
+                        "a memoized time law should emit bit-identical spans");
+            }
+            const auto calls=ngc::totalTimeLawCalls(cached.lastTimeLawDiagnostics());
+            require(calls.calls==1&&calls.successes==1
+                        &&calls.solverCalls==(side==0?1u:0u)
+                        &&calls.cacheMisses==(side==0?1u:0u)
+                        &&calls.cacheHits==(side==0?0u:1u)
+                        &&calls.cacheSuccessfulHits==calls.cacheHits,
+                    std::format("side {} of a square pocket should solve its scalar "
+                        "transition once and then reuse it: solver={} hits={} misses={}",
+                        side,calls.solverCalls,calls.cacheHits,calls.cacheMisses));
+            const auto uncachedCalls=ngc::totalTimeLawCalls(uncached.lastTimeLawDiagnostics());
+            require(uncachedCalls.solverCalls==1&&uncachedCalls.cacheHits==0
+                        &&uncachedCalls.cacheMisses==0,
+                    "a compiler without a transition cache should always call the solver");
+        }
+
+        auto copy=cached;
+        copy.reset(12);
+        require(copy.scalarTransitionCache()==cached.scalarTransitionCache()
+                    &&copy.compile(ngc::MoveLine{{}, {0,-1,0,0,0,0},60.0}).has_value()
+                    &&ngc::totalTimeLawCalls(copy.lastTimeLawDiagnostics()).cacheHits==1
+                    &&cached.scalarTransitionCache()->size()==1,
+                "compiler copies should share one exact-key transition cache");
+    }
+
+    void testCancelledRollingProbeReleasesItsWorker() {
+        const ngc::TrajectoryLimits limits{
+            .pathAcceleration=4.0,
+            .rapidSpeed=120.0,
+            .arcChordTolerance=0.0001,
+            .pathJerk=8.0,
+            .axisPosition={},
+        };
+        std::array<ngc::PreparedCommandRecord,2> records;
+        records[0].id=1;
+        records[0].command=ngc::MoveLine{{0,0,0,0,0,0},{1,0,0,0,0,0},60.0};
+        records[1].id=2;
+        records[1].command=ngc::MoveLine{{1,0,0,0,0,0},{1,1,0,0,0,0},60.0};
+        const auto prepared=ngc::prepareContinuousGeometry(records,0.01);
+        require(prepared.has_value(),prepared?"":prepared.error());
+        const auto geometry=std::make_shared<const ngc::RollingBoundaryProbe::Geometry>(
+            ngc::RollingBoundaryProbe::Geometry{*prepared,*prepared});
+        const auto probeFor=[&](std::function<void()> progress) {
+            auto probe=std::make_shared<ngc::RollingBoundaryProbe>();
+            probe->geometry=geometry;
+            probe->prefixPlanner=ngc::TrajectoryCompiler(limits);
+            probe->prefixPlanner.setProgressCallback(std::move(progress));
+            probe->prefixPlanner.reset(1);
+            probe->blendScale=0.01;
+            return probe;
+        };
+
+        // the suffix compile of the first probe is held inside its first progress report
+        std::atomic<bool> entered=false;
+        std::atomic<bool> released=false;
+        const auto held=probeFor([&] {
+            entered=true;
+            while(!released) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+        const auto next=probeFor({});
+        ngc::RollingBoundaryProbePool probes(1);
+        probes.submit(held);
+        probes.submit(next);
+        for(auto attempt=0;attempt<5000&&!entered;++attempt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        require(entered,"the held probe should start its suffix compile");
+
+        held->cancelled=true;
+        released=true;
+        require(probes.waitFor(*held,std::chrono::seconds(5))
+                    &&probes.waitFor(*next,std::chrono::seconds(60)),
+                "a cancelled in-flight probe should free the only worker for the next probe");
+        require(!held->suffixProved&&held->suffixError.contains("cancelled")
+                    &&!held->prefix&&held->prefix.error().empty()&&!held->exception,
+                std::format("a probe cancelled while compiling should stop before its prefix: {}",
+                    held->suffixError));
+    }
+
     void testTrajectoryCompilerRejectsAxisPositionLimitViolations() {
         ngc::TrajectoryLimits limits;
         limits.axisPosition.minimum.x = -1.0;
@@ -6971,6 +7599,80 @@ G1 F60 X2
                 "the frontend compiler accepted an out-of-range probe target");
     }
 
+    void testBatchedAxisExtremaMatchPerAxisVerifier() {
+        constexpr std::array components {
+            &ngc::position_t::x, &ngc::position_t::y, &ngc::position_t::z,
+            &ngc::position_t::a, &ngc::position_t::b, &ngc::position_t::c,
+        };
+        std::uint64_t state = 0x9e3779b97f4a7c15ULL;
+        const auto next = [&] {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<double>(state >> 11) * 0x1.0p-53 * 2.0 - 1.0;
+        };
+        const auto requireSame = [](const double batched, const double scalar,
+                                    const std::string_view context) {
+            require(std::abs(batched - scalar) <= 1e-11 * (1.0 + std::abs(scalar)),
+                    std::format("{} differs: batched={} per-axis={}", context, batched, scalar));
+        };
+
+        for (std::size_t sample = 0; sample < 2'000; ++sample) {
+            ngc::AxisPolynomialSpan span;
+            span.degree = sample % 3 == 0 ? ngc::ExecutionPolynomialDegree::Cubic
+                                          : ngc::ExecutionPolynomialDegree::Quintic;
+            span.duration = 0.001 + 0.5 * std::abs(next());
+            span.inverseDuration = 1.0 / span.duration;
+            span.inverseDurationSquared = span.inverseDuration * span.inverseDuration;
+            span.inverseDurationCubed = span.inverseDurationSquared * span.inverseDuration;
+            const auto order = span.degree == ngc::ExecutionPolynomialDegree::Cubic ? 3u : 5u;
+            for (const auto component : components) {
+                span.origin.*component = next();
+                for (std::size_t index = 0; index < order; ++index) {
+                    span.coefficients[index].*component = 4.0 * next();
+                }
+            }
+            // an idle B axis, and a C velocity with a double root at u = 1/2
+            span.origin.b = 0.0;
+            for (auto &coefficient : span.coefficients) {
+                coefficient.b = 0.0;
+                coefficient.c = 0.0;
+            }
+            span.coefficients[0].c = 0.75;
+            span.coefficients[1].c = -1.5;
+            span.coefficients[2].c = 1.0;
+
+            const auto extrema = ngc::trajectory_detail::axisSpanExtrema(span);
+            const auto ranges = ngc::trajectory_detail::axisPositionRanges(span);
+            for (const auto component : components) {
+                requireSame(extrema.maximumVelocity.*component,
+                            ngc::trajectory_detail::maximumAxisVelocity(span, component),
+                            "batched axis velocity");
+                requireSame(extrema.maximumAcceleration.*component,
+                            ngc::trajectory_detail::maximumAxisAcceleration(span, component),
+                            "batched axis acceleration");
+                requireSame(extrema.maximumJerk.*component,
+                            ngc::trajectory_detail::maximumAxisJerk(span, component),
+                            "batched axis jerk");
+                const auto range = ngc::trajectory_detail::axisPositionRange(span, component);
+                requireSame(ranges.minimum.*component, range.minimum, "batched position minimum");
+                requireSame(ranges.maximum.*component, range.maximum, "batched position maximum");
+            }
+            requireNear(extrema.maximumVelocity.b, 0.0,
+                        "an idle axis should report no velocity");
+        }
+
+        ngc::AxisPolynomialSpan interior;
+        interior.degree = ngc::ExecutionPolynomialDegree::Quintic;
+        interior.coefficients[0].y = 4.0;
+        interior.coefficients[1].y = -4.0;
+        const auto ranges = ngc::trajectory_detail::axisPositionRanges(interior);
+        requireNear(ranges.minimum.y, 0.0,
+                    "batched position ranges lost the polynomial endpoints");
+        requireNear(ranges.maximum.y, 1.0,
+                    "batched position ranges missed an interior extremum");
+    }
+
     void testExactStopPlannerEnforcesIndependentAxisLimits() {
         constexpr auto infinity = std::numeric_limits<double>::infinity();
         ngc::TrajectoryCompiler planner({
@@ -7115,6 +7817,385 @@ G1 F60 X2
                 "taking mock jerk diagnostics should consume the incremental samples");
     }
 
+    void testCurveEvaluationWorkspaceEvictsLeastRecentlyUsedCurves() {
+        std::vector<std::shared_ptr<const ngc::PreparedCurve>> curves;
+        for(unsigned index=1;index<=8;++index) {
+            const auto radius=0.5*index;
+            curves.push_back(ngc::prepareDisplayCurve(ngc::MoveArc{
+                {radius,0,0,0,0,0},{0,radius,0,0,0,0},{0,0,0},{0,0,1},60.0}));
+            require(curves.back()!=nullptr,"test arcs should prepare");
+        }
+        ngc::CurveEvaluationWorkspace bounded(3);
+        for(unsigned pass=0;pass<2;++pass)
+            for(const auto &curve:curves) {
+                const auto distance=curve->length*(0.25+0.5*pass);
+                ngc::CurveEvaluationWorkspace fresh;
+                const auto expected=ngc::positionAtDistance(*curve,distance,fresh);
+                require((ngc::positionAtDistance(*curve,distance,bounded)-expected).length()<1e-12,
+                    "a bounded workspace should evaluate like a fresh one");
+                require(bounded.arcs.size()<=3,"the workspace should keep at most its capacity");
+            }
+        const auto recent=ngc::positionAtDistance(*curves[5],curves[5]->length*0.5,bounded);
+        ngc::positionAtDistance(*curves[0],0.0,bounded);
+        require(bounded.arcs.find(*curves[5])!=nullptr&&bounded.arcs.find(*curves[6])==nullptr,
+            "evicting a curve should keep the most recently used ones");
+        require((ngc::positionAtDistance(*curves[5],curves[5]->length*0.5,bounded)-recent).length()<1e-12,
+            "a retained entry should keep evaluating its own curve");
+    }
+
+    void testSplineInverseSurrogateSeedsCertifiedInverse() {
+        constexpr double RADIUS=0.05;
+        const ngc::position_t first{RADIUS,0,0,0,0,0};
+        const ngc::position_t junction{0,RADIUS,0,0,0,0};
+        const ngc::position_t last{-RADIUS,0,0,0,0,0};
+        std::array<ngc::PreparedCommandRecord,2> records;
+        records[0].id=1;
+        records[0].command=ngc::MoveArc{first,junction,{0,0,0},{0,0,1},60.0};
+        records[1].id=2;
+        records[1].command=ngc::MoveArc{junction,last,{0,0,0},{0,0,1},60.0};
+        const auto prepared=ngc::prepareContinuousGeometry(records,0.1,first);
+        require(prepared.has_value(),prepared?"":prepared.error());
+        const auto blend=std::ranges::find_if(prepared->pieces,[](const auto &piece) {
+            return std::holds_alternative<ngc::PreparedSplineCurve>(piece.curve->value);
+        });
+        require(blend!=prepared->pieces.end(),"the junction should provide a spline curve");
+        const auto &seeded=*blend->curve;
+        const auto &spline=std::get<ngc::PreparedSplineCurve>(seeded.value);
+        require(spline.speeds.size()==spline.parameters.size(),
+            "prepared splines should store a speed at every table parameter");
+        auto unseeded=seeded;
+        std::get<ngc::PreparedSplineCurve>(unseeded.value).speeds.clear();
+
+        ngc::CurveEvaluationWorkspace withSurrogate;
+        ngc::CurveEvaluationWorkspace withoutSurrogate;
+        for(unsigned index=1;index<256;++index) {
+            const auto distance=seeded.length*(index+0.3)/256.5;
+            require((ngc::positionAtDistance(seeded,distance,withSurrogate)
+                    -ngc::positionAtDistance(unseeded,distance,withoutSurrogate)).length()<1e-11,
+                "the surrogate seed should not change the certified inverse");
+        }
+        const auto &seededQueries=withSurrogate.splineInverse;
+        const auto &plainQueries=withoutSurrogate.splineInverse;
+        require(seededQueries.queries==255&&seededQueries.surrogateSeeds==255
+                    &&plainQueries.surrogateSeeds==0,
+                "every interior inverse should be seeded from the surrogate when speeds exist");
+        require(seededQueries.integralEvaluations<plainQueries.integralEvaluations
+                    &&seededQueries.integralEvaluations<=2*seededQueries.queries,
+                "the surrogate seed should leave at most one Newton correction per inverse");
+    }
+
+    void testEvaluateAtDistancesMatchesScalarEvaluation() {
+        constexpr double RADIUS=0.05;
+        const ngc::position_t first{RADIUS,0,0,0,0,0};
+        const ngc::position_t junction{0,RADIUS,0,0,0,0};
+        const ngc::position_t last{-RADIUS,0,0,0,0,0};
+        std::array<ngc::PreparedCommandRecord,2> records;
+        records[0].id=1;
+        records[0].command=ngc::MoveArc{first,junction,{0,0,0},{0,0,1},60.0};
+        records[1].id=2;
+        records[1].command=ngc::MoveArc{junction,last,{0,0,0},{0,0,1},60.0};
+        const auto prepared=ngc::prepareContinuousGeometry(records,0.1,first);
+        require(prepared.has_value(),prepared?"":prepared.error());
+        std::vector<std::shared_ptr<const ngc::PreparedCurve>> curves{
+            ngc::prepareDisplayCurve(ngc::MoveLine{first,last,60.0})};
+        for(const auto &piece:prepared->pieces) curves.push_back(piece.curve);
+        require(std::ranges::any_of(curves,[](const auto &curve) {
+                    return std::holds_alternative<ngc::PreparedSplineCurve>(curve->value);
+                }),"the junction should provide a spline curve");
+
+        for(const auto &curve:curves) {
+            std::vector<double> distances{-1.0,0.0};
+            for(unsigned index=1;index<16;++index)
+                distances.push_back(curve->length*index/16.0);
+            distances.push_back(distances.back());
+            distances.push_back(curve->length*0.25);
+            distances.push_back(curve->length);
+            distances.push_back(curve->length+1.0);
+            const auto count=distances.size();
+            std::vector<ngc::position_t> positions(count),tangents(count),curvatures(count),
+                derivatives(count);
+            ngc::CurveEvaluationWorkspace batch;
+            ngc::evaluateAtDistances(*curve,distances,
+                {.positions=positions,.tangents=tangents,.curvatures=curvatures,
+                 .curvatureDerivatives=derivatives},batch);
+            const auto same=[](const ngc::position_t &left,const ngc::position_t &right) {
+                return left.x==right.x&&left.y==right.y&&left.z==right.z
+                    &&left.a==right.a&&left.b==right.b&&left.c==right.c;
+            };
+            for(std::size_t index=0;index<count;++index) {
+                ngc::CurveEvaluationWorkspace scalar;
+                require(same(positions[index],ngc::positionAtDistance(*curve,distances[index],scalar))
+                            &&same(tangents[index],ngc::tangentAtDistance(*curve,distances[index],scalar))
+                            &&same(curvatures[index],ngc::curvatureAtDistance(*curve,distances[index],scalar))
+                            &&same(derivatives[index],
+                                   ngc::curvatureDerivativeAtDistance(*curve,distances[index],scalar)),
+                        "batched curve evaluation should match the scalar evaluators exactly");
+            }
+
+            std::vector<ngc::position_t> spanDerivatives(count);
+            ngc::evaluateAtDistances(*curve,distances,{.curvatureDerivatives=spanDerivatives},batch,0);
+            for(std::size_t index=0;index<count;++index) {
+                ngc::CurveEvaluationWorkspace scalar;
+                require(same(spanDerivatives[index],
+                             ngc::curvatureDerivativeAtDistance(*curve,distances[index],scalar,0)),
+                        "a fixed spline parameter span should match the scalar evaluator");
+            }
+        }
+
+        std::array<double,2> distances{0.0,1.0};
+        std::array<ngc::position_t,1> tooShort;
+        ngc::CurveEvaluationWorkspace workspace;
+        bool rejected=false;
+        try {
+            ngc::evaluateAtDistances(*curves.front(),distances,{.tangents=tooShort},workspace);
+        } catch(const std::invalid_argument &) {
+            rejected=true;
+        }
+        require(rejected,"an output shorter than the distances should be rejected");
+    }
+
+    void testPreparedGeometryCacheTranslatesRepeatedWindows() {
+        const auto window=[](const ngc::position_t &offset,const ngc::PreparedCommandId firstId) {
+            const std::array points{
+                ngc::position_t{1,0,0,0,0,0},ngc::position_t{0,1,0,0,0,0},
+                ngc::position_t{0,2,0,0,0,0},ngc::position_t{0.01,2.02,0,0,0,0},
+                ngc::position_t{0.03,2.03,0,0,0,0},ngc::position_t{0.03,3.03,0,0,0,0},
+            };
+            std::vector<ngc::PreparedCommandRecord> records;
+            for(std::size_t index=0;index+1<points.size();++index) {
+                ngc::PreparedCommandRecord record;
+                record.id=firstId+index;
+                const auto from=points[index]+offset;
+                const auto to=points[index+1]+offset;
+                if(index==0) record.command=ngc::MoveArc{from,to,
+                    {offset.x,offset.y,offset.z},{0,0,1},60.0};
+                else record.command=ngc::MoveLine{from,to,60.0};
+                records.push_back(std::move(record));
+            }
+            return records;
+        };
+        const ngc::position_t offset{1.5,-2.0,0.25,0,0,0};
+        const auto original=window({},1);
+        const auto moved=window(offset,101);
+        ngc::PreparedGeometryCache cache;
+        const ngc::position_t start{1,0,0,0,0,0};
+        const auto first=cache.prepareContinuous(original,0.01,start);
+        require(first.has_value(),first?"":first.error());
+        const auto reused=cache.prepareContinuous(moved,0.01,start+offset);
+        const auto direct=ngc::prepareContinuousGeometry(moved,0.01,start+offset);
+        require(reused.has_value()&&direct.has_value(),reused?"":reused.error());
+        const auto diagnostics=cache.diagnostics();
+        require(diagnostics.misses==1&&diagnostics.hits==1&&diagnostics.translatedHits==1
+                    &&cache.size()==1,
+                "a translated repeat window should be served from the cache");
+        require(reused->pieces.size()==direct->pieces.size()&&reused->commands.size()==moved.size()
+                    &&reused->commands.front().id==101,
+                "a cached window should carry the repeated window's commands");
+        require(std::ranges::any_of(reused->pieces,[](const auto &piece) {
+                    return piece.kind==ngc::PreparedPieceKind::ClusterSpline; }),
+                "the cached window should contain a reconstructed cluster spline");
+        ngc::CurveEvaluationWorkspace workspace;
+        for(std::size_t index=0;index<direct->pieces.size();++index) {
+            const auto &actual=reused->pieces[index];
+            const auto &expected=direct->pieces[index];
+            require(actual.kind==expected.kind&&actual.primaryCommand==expected.primaryCommand
+                        &&actual.sourceCommands==expected.sourceCommands
+                        &&actual.activationStations.size()==expected.activationStations.size()
+                        &&actual.geometricSamples.size()==expected.geometricSamples.size(),
+                    "a cached piece should match fresh preparation at the new offset");
+            for(const auto distance:{actual.curveFrom,0.5*(actual.curveFrom+actual.curveTo),
+                                     actual.curveTo})
+                require((ngc::positionAtDistance(*actual.curve,distance,workspace)
+                        -ngc::positionAtDistance(*expected.curve,distance,workspace)).length()<1e-9,
+                    "a cached piece should be translated to the new work offset");
+            require(actual.replacedSourceIntervals.size()==expected.replacedSourceIntervals.size(),
+                "a cached piece should keep its replaced source intervals");
+            for(std::size_t interval=0;interval<actual.replacedSourceIntervals.size();++interval) {
+                const auto &cached=actual.replacedSourceIntervals[interval];
+                const auto &fresh=expected.replacedSourceIntervals[interval];
+                require(cached.command==fresh.command&&(ngc::positionAtDistance(*cached.curve,
+                        cached.curveFrom,workspace)-ngc::positionAtDistance(*fresh.curve,
+                        fresh.curveFrom,workspace)).length()<1e-9,
+                    "replaced source intervals should be renamed and translated");
+            }
+        }
+
+        // 12.345 and friends are not dyadic: the shifted window is only equal to
+        // the original within the rounding of the offset addition
+        const ngc::position_t decimal{12.345,-6.789,0.1,0,0,0};
+        const auto shifted=window(decimal,201);
+        require((std::get<ngc::MoveLine>(shifted[3].command).to()-(start+decimal)).x
+                    !=(std::get<ngc::MoveLine>(original[3].command).to()-start).x,
+                "the decimal offset should perturb the relative source coordinates");
+        const auto decimalReuse=cache.prepareContinuous(shifted,0.01,start+decimal);
+        const auto decimalDirect=ngc::prepareContinuousGeometry(shifted,0.01,start+decimal);
+        require(decimalReuse.has_value()&&decimalDirect.has_value(),
+            decimalReuse?"":decimalReuse.error());
+        const auto decimalDiagnostics=cache.diagnostics();
+        require(decimalDiagnostics.misses==1&&decimalDiagnostics.translatedHits==2&&cache.size()==1,
+            "a window at a decimal work offset should be a translated hit");
+        require(decimalReuse->pieces.size()==decimalDirect->pieces.size()
+                    &&decimalReuse->commands.front().id==201,
+            "a decimal offset hit should carry the shifted window's commands");
+        for(std::size_t index=0;index<decimalDirect->pieces.size();++index) {
+            const auto &actual=decimalReuse->pieces[index];
+            const auto &expected=decimalDirect->pieces[index];
+            for(const auto distance:{actual.curveFrom,actual.curveTo})
+                require((ngc::positionAtDistance(*actual.curve,distance,workspace)
+                        -ngc::positionAtDistance(*expected.curve,distance,workspace)).length()<1e-12,
+                    "a decimal offset hit should match fresh preparation at that offset");
+        }
+
+        // a quarter of the 1e-8 key quantum shares the original's key but is
+        // another window; serving it would miss the moved corner
+        auto nudged=window({},301);
+        const ngc::position_t nudge{2.5e-9,0,0,0,0,0};
+        const auto &corner=std::get<ngc::MoveLine>(nudged[3].command);
+        const auto &after=std::get<ngc::MoveLine>(nudged[4].command);
+        nudged[3].command=ngc::MoveLine{corner.from(),corner.to()+nudge,corner.speed()};
+        nudged[4].command=ngc::MoveLine{after.from()+nudge,after.to(),after.speed()};
+        const auto nudgedPrepared=cache.prepareContinuous(nudged,0.01,start);
+        const auto nudgedDirect=ngc::prepareContinuousGeometry(nudged,0.01,start);
+        require(nudgedPrepared.has_value()&&nudgedDirect.has_value(),
+            nudgedPrepared?"":nudgedPrepared.error());
+        const auto nudgedDiagnostics=cache.diagnostics();
+        require(nudgedDiagnostics.mismatchedKeys==1&&nudgedDiagnostics.misses==2
+                    &&nudgedDiagnostics.hits==decimalDiagnostics.hits&&cache.size()==1,
+            "a window within half a key quantum of a cached one should be prepared again");
+        require(nudgedPrepared->pieces.size()==nudgedDirect->pieces.size(),
+            "a re-prepared window should match fresh preparation");
+        for(std::size_t index=0;index<nudgedDirect->pieces.size();++index) {
+            const auto &actual=nudgedPrepared->pieces[index];
+            const auto &expected=nudgedDirect->pieces[index];
+            for(const auto distance:{actual.curveFrom,actual.curveTo})
+                require((ngc::positionAtDistance(*actual.curve,distance,workspace)
+                        -ngc::positionAtDistance(*expected.curve,distance,workspace)).length()<1e-12,
+                    "a re-prepared window should keep its own corner");
+        }
+    }
+
+    void testPreparedGeometricSamplesStoreComponentColumns() {
+        ngc::PreparedGeometricSamples samples;
+        for(auto index=0;index<5;++index) {
+            const auto value=static_cast<double>(index);
+            samples.push_back({value,{value,1,2,3,4,5},{0,value*2,0,0,0,0},{0,0,0,0,0,-value}});
+        }
+        require(samples.size()==5&&samples[3].distance==3.0&&samples[3].tangent.x==3.0
+                    &&samples[3].tangent.c==5.0&&samples[3].curvature.y==6.0
+                    &&samples[3].curvatureDerivative.c==-3.0,
+                "columnar samples should reassemble pushed samples");
+        const auto tangentX=samples.tangents(0);
+        const auto derivativeC=samples.curvatureDerivatives(5);
+        require(tangentX.size()==5&&tangentX[4]==4.0&&derivativeC[2]==-2.0
+                    &&samples.curvatures(1)[1]==2.0,
+                "each sample component should be one contiguous column");
+
+        const auto middle=samples.subview(1,3);
+        require(middle.size()==3&&middle.front().distance==1.0&&middle.back().distance==3.0
+                    &&middle.tangents(0)[2]==3.0,
+                "a sample subview should address the same columns");
+        auto count=0;
+        for(const auto &sample:middle) require(sample.distance==++count, "sample views should iterate in order");
+
+        auto suffix=samples;
+        suffix.eraseFront(2);
+        for(auto &distance:suffix.distances()) distance-=2.0;
+        samples.resize(2);
+        require(samples.size()==2&&samples.back().tangent.x==1.0
+                    &&suffix.size()==3&&suffix.front().distance==0.0&&suffix.front().tangent.x==2.0
+                    &&suffix.back().curvatureDerivative.c==-4.0,
+                "splitting a sample store should keep each side's columns aligned");
+    }
+
+    std::vector<std::string> producedGeometryStream(const std::size_t workers,
+            const std::size_t maximumShortClusterEntities =
+                ngc::GeometryStreamPolicy{}.maximumShortClusterEntities,
+            ngc::GeometryStreamDiagnostics *diagnostics = nullptr) {
+        std::string source = "G64 P0.01\nG1 F600 X0 Y0\n";
+        for(auto index = 1; index <= 40; ++index)
+            source += std::format("G1 X{} Y{}\n", index * 0.02, (index % 2) * 0.01);
+        source += "G1 X5 Y0\nG1 X5 Y5\n";
+        for(auto index = 1; index <= 40; ++index)
+            source += std::format("G1 X{} Y{}\n", 5.0 - index * 0.02, 5.0 + (index % 2) * 0.01);
+        source += "G0 Z1\nG1 X0 Y0 Z0\nG61\nG1 X1\nG1 Y1\n";
+
+        ngc::InterpreterSession session(UNIT, ngc::InterpretationMode::Preview);
+        compileSession(session, source);
+        ngc::PreparedGeometryForwardChannel forward;
+        ngc::GeometryFeedbackChannel feedback;
+        std::atomic<bool> cancelled = false;
+        ngc::GeometryStreamPolicy policy;
+        policy.publishNominalDuration = 0.01;
+        policy.preparationWorkers = workers;
+        policy.maximumShortClusterEntities = maximumShortClusterEntities;
+        ngc::GeometryStreamProducer producer(session, forward, feedback, cancelled, policy);
+        auto completed = false;
+        std::thread geometryThread([&] { completed = producer.run(1); });
+
+        std::vector<std::string> stream;
+        for(auto finished = false; !finished;) {
+            ngc::PreparedForwardMessage message;
+            if(!forward.waitPop(message, [&] { return cancelled.load(); })) break;
+            std::string entry;
+            std::visit([&](const auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                entry = std::format("{} {}", value.sequence, message->index());
+                if constexpr(std::same_as<T, ngc::PreparedGeometrySlice>) {
+                    entry += std::format(" chain {}", value.chain);
+                    for(const auto &command : value.commands) entry += std::format(" c{}", command.id);
+                    for(const auto &piece : value.pieces)
+                        entry += std::format(" p{}:{}:{}:{}", piece.id, static_cast<int>(piece.kind),
+                            piece.primaryCommand, piece.length());
+                } else if constexpr(std::same_as<T, ngc::PreparedStandaloneCommand>) {
+                    entry += std::format(" c{}", value.command.id);
+                } else if constexpr(std::same_as<T, ngc::PreparedFailure>) {
+                    entry += " " + value.error;
+                }
+                if constexpr(std::same_as<T, ngc::PreparedSynchronizationFence>)
+                    require(feedback.tryPush(std::make_unique<const ngc::GeometryFeedback>(
+                        ngc::ReleaseSynchronization{value.epoch, value.fence})),
+                        "producer stream test should release its synchronization fence");
+                finished = std::same_as<T, ngc::PreparedProgramEnd> || std::same_as<T, ngc::PreparedFailure>;
+            }, *message);
+            stream.push_back(std::move(entry));
+        }
+        geometryThread.join();
+        require(completed, "producer stream test program should complete");
+        if(diagnostics) *diagnostics = producer.diagnostics();
+        return stream;
+    }
+
+    void testGeometryStreamProducerPublishesParallelWindowsInOrder() {
+        const auto serial = producedGeometryStream(0);
+        const auto parallel = producedGeometryStream(3);
+        require(serial.size() > 4, "producer stream test should publish several slices");
+        require(serial == parallel, "parallel window preparation should publish the serial stream");
+        for(std::size_t index = 0; index < parallel.size(); ++index)
+            require(parallel[index].starts_with(std::format("{} ", index + 1)),
+                "parallel window preparation should publish contiguous sequences");
+    }
+
+    void testGeometryStreamProducerSplitsLongAllShortRegions() {
+        ngc::GeometryStreamDiagnostics unbounded;
+        ngc::GeometryStreamDiagnostics bounded;
+        producedGeometryStream(0, 0, &unbounded);
+        const auto stream = producedGeometryStream(2, 8, &bounded);
+        require(ngc::GeometryStreamPolicy{}.maximumShortClusterEntities == 0,
+            "protected all-short splits stop motion and should be opt-in");
+        require(unbounded.protectedClusterSplits == 0 && unbounded.retainedSourceHighWater > 40,
+            "an unbounded all-short region should be retained until its long anchor");
+        require(bounded.protectedClusterSplits == 10,
+            "each run of eight short sources should end at a protected split");
+        require(bounded.retainedSourceHighWater <= 9,
+            "protected splits should bound the retained source window");
+        // The last split falls on the G0 that ends the region anyway.
+        require(bounded.continuousEndsPublished == unbounded.continuousEndsPublished + 9,
+            "every other protected split should end its continuous chain early");
+        require(std::ranges::none_of(stream, [](const auto &entry) {
+                    return entry.find("missing") != std::string::npos; }),
+            "split chains should publish every referenced command");
+    }
+
     void testPreparedArcJunctionMatchesSourceCurvature() {
         constexpr double RADIUS=0.05;
         const ngc::position_t first{RADIUS,0,0,0,0,0};
@@ -7328,6 +8409,119 @@ G1 F60 X2
                 "junction timing samples must retain exact source endpoint curvature");
     }
 
+    void testBandLdltMatchesDenseSolve() {
+        constexpr std::array components{
+            &ngc::position_t::x,&ngc::position_t::y,&ngc::position_t::z,
+            &ngc::position_t::a,&ngc::position_t::b,&ngc::position_t::c,
+        };
+        std::uint64_t state=0x2545f4914f6cdd1dULL;
+        const auto next=[&] {
+            state^=state<<13;
+            state^=state>>7;
+            state^=state<<17;
+            return static_cast<double>(state>>11)*0x1.0p-53*2.0-1.0;
+        };
+        for(std::size_t count=1;count<=40;++count) {
+            // L D Lt with a unit lower band L and a positive D is symmetric positive definite
+            std::vector<std::array<double,4>> lower(count);
+            std::vector<double> diagonal(count);
+            for(std::size_t i=0;i<count;++i) {
+                lower[i]={1.0,next(),next(),next()};
+                diagonal[i]=0.05+std::abs(next());
+            }
+            std::vector<std::vector<double>> dense(count,std::vector<double>(count));
+            for(std::size_t i=0;i<count;++i)
+                for(std::size_t j=0;j<count;++j)
+                    for(std::size_t k=0;k<=std::min(i,j);++k)
+                        if(i-k<=3&&j-k<=3) dense[i][j]+=lower[i][i-k]*diagonal[k]*lower[j][j-k];
+            std::vector<ngc::spline_detail::SymmetricBandRow> band(count);
+            for(std::size_t i=0;i<count;++i)
+                for(std::size_t distance=0;distance<=std::min<std::size_t>(3,i);++distance)
+                    band[i][distance]=dense[i][i-distance];
+            std::vector<ngc::position_t> values(count);
+            for(auto &value:values)
+                for(const auto component:components) value.*component=next();
+            auto solution=values;
+            require(ngc::spline_detail::factorBandLdlt(band),
+                std::format("a {}-row positive-definite band should factor",count));
+            ngc::spline_detail::solveBandLdlt(band,solution);
+
+            for(const auto component:components) {
+                auto matrix=dense;
+                std::vector<double> reference(count);
+                for(std::size_t i=0;i<count;++i) reference[i]=values[i].*component;
+                for(std::size_t column=0;column<count;++column) {
+                    auto pivot=column;
+                    for(auto row=column+1;row<count;++row)
+                        if(std::abs(matrix[row][column])>std::abs(matrix[pivot][column])) pivot=row;
+                    std::swap(matrix[column],matrix[pivot]);
+                    std::swap(reference[column],reference[pivot]);
+                    for(auto row=column+1;row<count;++row) {
+                        const auto factor=matrix[row][column]/matrix[column][column];
+                        for(auto entry=column;entry<count;++entry) matrix[row][entry]-=factor*matrix[column][entry];
+                        reference[row]-=factor*reference[column];
+                    }
+                }
+                for(auto row=count;row-->0;) {
+                    for(auto entry=row+1;entry<count;++entry) reference[row]-=matrix[row][entry]*reference[entry];
+                    reference[row]/=matrix[row][row];
+                }
+                for(std::size_t i=0;i<count;++i)
+                    require(std::abs(solution[i].*component-reference[i])<=1e-9*(1.0+std::abs(reference[i])),
+                        std::format("band LDLt row {} of {} differs from the dense solve: {} != {}",
+                            i,count,solution[i].*component,reference[i]));
+            }
+        }
+
+        std::vector<ngc::spline_detail::SymmetricBandRow> indefinite{{1.0,0,0,0},{-1.0,2.0,0,0}};
+        require(!ngc::spline_detail::factorBandLdlt(indefinite),
+            "an indefinite band should not factor");
+    }
+
+    void testEndpointDerivativeCoefficientsMatchDenseBasisTable() {
+        // the full difference table over every control, as the solver first built it
+        const auto dense=[](std::vector<double> knots,std::size_t degree,const std::size_t count,
+                            const std::size_t order,const bool end) {
+            std::vector<std::vector<double>> values(count,std::vector<double>(count));
+            for(std::size_t index=0;index<count;++index) values[index][index]=1.0;
+            for(std::size_t derivative=0;derivative<order;++derivative) {
+                std::vector<std::vector<double>> next(values.size()-1,std::vector<double>(count));
+                for(std::size_t index=0;index<next.size();++index) {
+                    const auto factor=static_cast<double>(degree)/(knots[index+degree+1]-knots[index+1]);
+                    for(std::size_t source=0;source<count;++source)
+                        next[index][source]=factor*(values[index+1][source]-values[index][source]);
+                }
+                values=std::move(next);
+                knots={knots.begin()+1,knots.end()-1};
+                --degree;
+            }
+            return end?values.back():values.front();
+        };
+        for(const std::size_t degree:{3uz,5uz}) {
+            for(auto count=degree+1;count<=degree+12;++count) {
+                std::vector<double> knots(count+degree+1);
+                for(std::size_t index=degree+1;index<count;++index)
+                    knots[index]=knots[index-1]+0.25+0.5*static_cast<double>((index*7)%5);
+                for(auto index=count;index<knots.size();++index)
+                    knots[index]=knots[count-1]+1.0;
+                for(std::size_t order=0;order<=3;++order) {
+                    for(const auto end:{false,true}) {
+                        const auto reduced=ngc::spline_detail::endpointDerivativeCoefficients(
+                            knots,degree,count,order,end);
+                        const auto expected=dense(knots,degree,count,order,end);
+                        require(reduced.size()==count,"endpoint coefficients should cover every control");
+                        for(std::size_t index=0;index<count;++index)
+                            require(std::abs(reduced[index]-expected[index])
+                                        <=1e-12*(1.0+std::abs(expected[index])),
+                                std::format("degree {} count {} order {} {} coefficient {} differs: {} != {}",
+                                    degree,count,order,end?"end":"start",index,
+                                    reduced[index],expected[index]));
+                    }
+                }
+            }
+        }
+    }
+
     void testNoneSplineSmoothingPreservesCubicControls() {
         const std::vector<ngc::position_t> controls{
             {0.0,0.0,0.0,0.0,0.0,0.0},
@@ -7350,6 +8544,35 @@ G1 F60 X2
                 "none spline smoothing must preserve every cubic control exactly");
     }
 
+    void testShortEntityClusterDetectorFinalizesClustersIncrementally() {
+        const std::vector<double> lengths{0.01,1.0,0.01,0.02,1.0,1.0,0.03,1.0,0.01,0.01};
+        const auto batch=ngc::spline_detail::detectShortEntitySplineClusters(lengths,0.01);
+        ngc::spline_detail::ShortEntityClusterDetector detector(0.01);
+        std::vector<ngc::spline_detail::ShortEntitySplineCluster> incremental;
+        for(std::size_t index=0;index<lengths.size();++index) {
+            const auto boundary=detector.push(lengths[index]);
+            require(boundary.longEntity==(lengths[index]>0.06)&&!boundary.protectedSplit,
+                "an unbounded detector should only classify each arriving entity");
+            if(boundary.cluster) {
+                require(boundary.cluster->right==index,
+                    "a cluster should be finalized by the long entity closing it");
+                incremental.push_back(*boundary.cluster);
+            }
+        }
+        require(incremental.size()==2&&batch.size()==2
+                    &&incremental[0].left==1&&incremental[0].right==4
+                    &&incremental[1].left==5&&incremental[1].right==7
+                    &&batch[0].left==1&&batch[0].right==4&&batch[1].left==5&&batch[1].right==7,
+                "incremental detection should find the batch clusters");
+
+        ngc::spline_detail::ShortEntityClusterDetector bounded(0.01,3);
+        std::vector<std::size_t> splits;
+        for(std::size_t index=0;index<8;++index)
+            if(bounded.push(index==4?1.0:0.01).protectedSplit) splits.push_back(index);
+        require(splits==std::vector<std::size_t>{2,7},
+            "a bounded detector should split each all-short run at its maximum length");
+    }
+
     void testSingleShortEntityClusterRetainsMidpointControl() {
         const auto lineRecord=[](const ngc::PreparedCommandId id,
                                  const ngc::position_t &from,
@@ -7730,7 +8953,7 @@ G1 F60 X2
         const auto &roundedInterval=roundedCluster->splineKnotIntervals[1];
         const auto roundedSample=roundedInterval.firstGeometricSample
             +roundedInterval.geometricSampleCount-1;
-        roundedCluster->geometricSamples[roundedSample].distance+=5e-11;
+        roundedCluster->geometricSamples.distances()[roundedSample]+=5e-11;
         ngc::TrajectoryCompiler roundedEndpointCompiler(trajectoryLimits);
         roundedEndpointCompiler.setContinuousPlanningEffort(planningEffort);
         roundedEndpointCompiler.reset(94,points.front());
@@ -7801,6 +9024,11 @@ G1 F60 X2
                             .constraintBoundNodes > 0,
                 "PathTempo should run its sampled passes before production "
                 "materialization proves a candidate's quintics");
+        require((*planned)->materialization.preparedSampleBoundaryStates > 0
+                    && (*planned)->materialization.geometricEvaluationsAvoided
+                        >= (*planned)->materialization.preparedSampleBoundaryStates,
+                "continuous materialization should take timing-piece end states from "
+                "prepared samples");
 
         const auto planFingerprint=[](const ngc::ContinuousTrajectoryPlan &plan) {
             std::vector<std::uint64_t> result;
@@ -7899,6 +9127,18 @@ G1 F60 X2
                         ==(*planned)->geometryVerificationHighWater,
                 "PathTempo production planning must preserve exact timing, emitted spans, "
                 "and verification outcomes across repeated compilations");
+        repeatedCompiler.reset(94,points.front());
+        const auto warmPlan=repeatedCompiler.compileContinuous(*prepared,0.05);
+        require(warmPlan&&*warmPlan,warmPlan?"":warmPlan.error());
+        require(planFingerprint(**warmPlan)==planFingerprint(**planned)
+                    &&(*warmPlan)->materialization.reusedPieces>=(*warmPlan)->pieceTiming.size()
+                    &&(*warmPlan)->materialization.quintic.candidateEvaluations==0
+                    &&(*warmPlan)->materialization.quintic.geometryProofs==0
+                    &&(*planned)->materialization.quintic.candidateEvaluations>0,
+                std::format("a repeated compile should reuse every verified piece "
+                    "materialization without changing emitted spans: reused={} pieces={}",
+                    (*warmPlan)->materialization.reusedPieces,
+                    (*warmPlan)->pieceTiming.size()));
 
         require((*planned)->pieceTiming.size()==expectedTimingIntervals.size(),
                 "continuous timing should create one timing interval per cluster knot interval");
@@ -7961,6 +9201,60 @@ G1 F60 X2
                     clusterPlanner.windowSize(),
                     clusterPlanner.preparedNominalDuration(),clusterNominalDuration));
 
+        struct RolledClusterOutcome {
+            std::vector<std::uint64_t> fingerprint;
+            ngc::TrajectoryPlanningDiagnostics diagnostics;
+            double retainedDuration = 0.0;
+            std::string lastFailure;
+        };
+        const auto rollCluster=[&](const std::size_t workers) {
+            ngc::TrajectoryPlanner planner(rollingLimits);
+            planner.setContinuousPlanningEffort(planningEffort);
+            planner.setRollingProbeWorkers(workers);
+            RolledClusterOutcome outcome;
+            planner.setContinuousDiagnosticCallback([&](
+                    const ngc::ContinuousTrajectoryPlan &plan,
+                    std::span<const ngc::TrajectoryPlannerInput>) {
+                outcome.fingerprint=planFingerprint(plan);
+            });
+            planner.reset(98,clusterStart);
+            require(planner.enqueuePrepared(clusterSlice)
+                        &&planner.endPreparedChain(clusterSlice.chain),
+                    planner.lastPreparedEnqueueError());
+            const auto rolled=planner.planWindow();
+            require(rolled&&*rolled,rolled?"cluster spline did not produce a rolling prefix"
+                :rolled.error());
+            outcome.diagnostics=planner.diagnostics();
+            outcome.retainedDuration=planner.preparedNominalDuration();
+            outcome.lastFailure=planner.lastRollingFailure();
+            return outcome;
+        };
+        const auto serialCluster=rollCluster(0);
+        const auto speculativeCluster=rollCluster(3);
+        require(!serialCluster.fingerprint.empty()
+                    &&speculativeCluster.fingerprint==serialCluster.fingerprint
+                    &&speculativeCluster.retainedDuration==serialCluster.retainedDuration
+                    &&speculativeCluster.lastFailure==serialCluster.lastFailure
+                    &&speculativeCluster.diagnostics.rollingBoundaryCandidates
+                        ==serialCluster.diagnostics.rollingBoundaryCandidates
+                    &&speculativeCluster.diagnostics.rollingSuffixProbeFailures
+                        ==serialCluster.diagnostics.rollingSuffixProbeFailures
+                    &&speculativeCluster.diagnostics.rollingPrefixProbeFailures
+                        ==serialCluster.diagnostics.rollingPrefixProbeFailures
+                    &&speculativeCluster.diagnostics.maximumRollingSuffixProbePieces
+                        ==serialCluster.diagnostics.maximumRollingSuffixProbePieces
+                    &&speculativeCluster.diagnostics.geometricEvaluationsAvoided
+                        ==serialCluster.diagnostics.geometricEvaluationsAvoided
+                    &&serialCluster.diagnostics.rollingSpeculativeProbes==0
+                    &&speculativeCluster.diagnostics.rollingCancelledProbes
+                        <=speculativeCluster.diagnostics.rollingSpeculativeProbes,
+                std::format("speculative rolling probes should select the serial boundary and "
+                    "fold identical diagnostics: candidates={}/{} speculative={} cancelled={}",
+                    speculativeCluster.diagnostics.rollingBoundaryCandidates,
+                    serialCluster.diagnostics.rollingBoundaryCandidates,
+                    speculativeCluster.diagnostics.rollingSpeculativeProbes,
+                    speculativeCluster.diagnostics.rollingCancelledProbes));
+
         auto cappedClusterPiece = *found;
         constexpr auto LOW_CLUSTER_VELOCITY_CAP = 0.001;
         for (auto &interval : cappedClusterPiece.splineKnotIntervals) {
@@ -8402,7 +9696,8 @@ G1 F60 X2
             const auto middleDistance=reference.length()*0.375;
             const auto firstParameter=reference.parameterAtDistance(middleDistance);
             const auto cachedParameter=reference.parameterAtDistance(middleDistance);
-            require(firstParameter==cachedParameter&&inverse.exactCacheHits==1,
+            require(firstParameter==cachedParameter
+                        &&(inverse.exactCacheHits==1||inverse.closedFormQueries==2),
                     "arc inverse cache should return the bit-exact certified parameter");
             require(inverse.inverseIntegralEvaluations==inverse.newtonIterations
                         &&inverse.iterationLimitHits==0
@@ -8411,6 +9706,44 @@ G1 F60 X2
         }
     }
 
+    void testArcReferenceInvertsConstantSpeedArcsInClosedForm() {
+        const std::array arcs {
+            ngc::MoveArc { { 1, 0, 0, 0, 0, 0 }, { 0, 1, 0, 0, 0, 0 }, {}, { 0, 0, 1 }, 60.0 },
+            ngc::MoveArc { { 1, 0, 0, 0, 0, 0 }, { -1, 0, 3, 0, 0, 0 }, {}, { 0, 0, 1 }, 60.0 },
+            ngc::MoveArc { { 1, 0, 0, 0, 0, 0 }, { 1, 0, -2, 0, 0, 0 }, {}, { 0, 0, -1 }, 60.0 },
+        };
+        for(const auto &arc : arcs) {
+            ngc::simulation_detail::ArcInverseDiagnostics inverse;
+            const ngc::simulation_detail::ArcReference reference(arc,&inverse);
+            const auto geometry=ngc::simulation_detail::arcGeometry(arc);
+            require(reference.valid()&&geometry, "constant-speed arc should be valid");
+            const auto radius=geometry->startArm.length();
+            const auto rise=arc.to().z-arc.from().z;
+            requireNear(reference.length(), std::hypot(radius*geometry->sweep, rise),
+                        "constant-speed arc length should be closed form");
+            for(const auto fraction : { 0.125, 0.5, 0.8 }) {
+                const auto position=reference.positionAtDistance(reference.length()*fraction);
+                const auto angle=std::atan2(position.y, position.x);
+                const auto expected=std::remainder(geometry->sweep*fraction
+                    *(geometry->axisUnit.z>0.0?1.0:-1.0), 2.0*std::numbers::pi);
+                requireNear(std::remainder(angle-expected, 2.0*std::numbers::pi), 0.0,
+                            "constant-speed arc inverse should advance the angle linearly");
+                requireNear(position.z, arc.from().z+rise*fraction,
+                            "constant-speed helix inverse should advance the pitch linearly");
+            }
+            require(inverse.constructionIntegralEvaluations==0&&inverse.inverseIntegralEvaluations==0
+                        &&inverse.closedFormQueries==3,
+                    "constant-speed arc inverse should not integrate");
+        }
+
+        ngc::simulation_detail::ArcInverseDiagnostics spiral;
+        const ngc::simulation_detail::ArcReference reference(
+            ngc::MoveArc { { 1, 0, 0, 0, 0, 0 }, { 0, 1.5, 0, 0, 0, 0 }, {}, { 0, 0, 1 }, 60.0 },&spiral);
+        (void)reference.positionAtDistance(reference.length()*0.5);
+        require(spiral.closedFormQueries==0&&spiral.inverseIntegralEvaluations>0,
+                "spiral arc inverse should keep exact integration");
+    }
+
     void testMockDiagnosticPositionsFollowServoPeriod() {
         const auto positionsAtPeriod = [](const double period) {
             ngc::MockMotionBackend backend;
@@ -9127,6 +10460,7 @@ int main() {
         testMachineAxisPositionComponentAccess();
         testMemoryStackBounds();
         testNumericParameterAddressesMustBeIntegers();
+        testMemoryGlobalsResolveThroughVarTable();
         testPersistentParameterCodec();
         testPersistentParameterFilesAreAtomicAndIsolated();
         testSessionCommandQueueIsBoundedAndOrdered();
@@ -9171,8 +10505,13 @@ int main() {
         testSimulationG10L11PersistsOnlySimulationToolTable();
         testNumericParsingRejectsTrailingGarbage();
         testLexerRejectsIncompleteOperators();
+        testTokensResolveTextFromMovedProgramSource();
+        testPlainBlocksParseLikeExpressionBlocks();
         testFileHelpersHandleEmptyAndFailedIo();
         testRapidAndFeedMove();
+        testSubArgumentsEvaluateInCallerScope();
+        testCompiledControlFlowAndErrorLocations();
+        testConstantExpressionsAndBranchesFoldAtCompileTime();
         testMachineCommandMotionHelpers();
         testG64IsAnInertPathModeFlag();
         testG64BlendScaleGeometryProgramIsValid();
@@ -9202,6 +10541,8 @@ int main() {
         testMockBackendFeedHoldBrakesAlongActiveTrajectory();
         testMockBackendControlledStopBrakesAndCannotResume();
         testDriverFailureStopsAndAbortsBeforeBecomingTerminal();
+        testPipelinedDriverPlansAheadOfPublication();
+        testPipelinedDriverPublishesWhilePlanningIsHeld();
         testMockBackendFeedHoldPausesAndResumesProbeApproach();
         testMockBackendProbeContactDuringFeedHoldStopIsDetected();
         testMachineSessionManagerFeedHoldReachesPausedAtRest();
@@ -9210,6 +10551,7 @@ int main() {
         testMachineSessionManagerReconcilesEarlyProbeBeforeG64Motion();
         testMachineSessionManagerProbeContactSupersedesFeedHold();
         test1001PreviewCompletesBoundedly();
+        testShortEntityClusterDetectorFinalizesClustersIncrementally();
         testSingleShortEntityClusterRetainsMidpointControl();
         test1002PreparedSliceBoundaries();
         testMdiToolChangeUsesAutoloadPrograms();
@@ -9239,6 +10581,10 @@ int main() {
         testArcGeometryValidation();
         testArcRadiusMismatchIsRecoverableInterpreterError();
         testInterpreterSessionOwnsCompilationAndExecution();
+        testInterpreterSessionQueuesBlocksAheadOfConsumer();
+        testInterpreterSessionReusesUnchangedPrograms();
+        testProgramCacheRestoresParsedPrograms();
+        testInterpreterSessionStreamsMappedProgram();
         testInterpreterTaskVariable();
         testIncrementalSessionControlFlow();
         testProbeCommandAndBarrier();
@@ -9256,12 +10602,24 @@ int main() {
         testProductionExecutorBackendConformance();
 #endif
         testExactStopPlannerCompilesLinesAndArcs();
+        testExactStopTimeLawCacheReusesRepeatedTransitions();
+        testCancelledRollingProbeReleasesItsWorker();
         testTrajectoryCompilerRejectsAxisPositionLimitViolations();
         testInfiniteJerkTrajectoryTimeMatchesAnalyticLine();
+        testBatchedAxisExtremaMatchPerAxisVerifier();
         testExactStopPlannerEnforcesIndependentAxisLimits();
+        testCurveEvaluationWorkspaceEvictsLeastRecentlyUsedCurves();
+        testEvaluateAtDistancesMatchesScalarEvaluation();
+        testSplineInverseSurrogateSeedsCertifiedInverse();
+        testPreparedGeometricSamplesStoreComponentColumns();
+        testPreparedGeometryCacheTranslatesRepeatedWindows();
+        testGeometryStreamProducerPublishesParallelWindowsInOrder();
+        testGeometryStreamProducerSplitsLongAllShortRegions();
         testPreparedArcJunctionMatchesSourceCurvature();
         testPreparedLineJunctionRetainsExactEndpointCurvature();
         testNoneSplineSmoothingPreservesCubicControls();
+        testBandLdltMatchesDenseSolve();
+        testEndpointDerivativeCoefficientsMatchDenseBasisTable();
         testClusterSplinePreparesKnotIntervalSamplesAndFeeds();
         testExecutionPolynomialEvaluation();
         testCollinearJunctionBlendUsesLinearTiming();
@@ -9270,6 +10628,7 @@ int main() {
         testPlannedArcsPreserveCanonicalEndpointContinuity();
         testRoundedRadiusArcPreservesDynamicLimits();
         testEndpointExactArcReferenceGeometryVariants();
+        testArcReferenceInvertsConstantSpeedArcsInClosedForm();
         testMockDiagnosticPositionsFollowServoPeriod();
         testMachineConfigurationLoadsTrajectoryLimits();
         testConfiguredSimulationStartsAtZeroAndHomes();